@@ -1,6 +1,7 @@
 #include "basic_memory.hpp"
 #include "emulator_exception.hpp"
 #include <cassert>
+#include <algorithm>
 
 BasicMemory::BasicMemory(uint32_t baseAddr, uint32_t size) : MemoryMapHandler(baseAddr, size), memoryArray(std::make_unique<uint8_t[]>(size)) {
 }
@@ -23,3 +24,17 @@ uint32_t BasicMemory::getSize() const {
     return size;
 }
 
+
+void BasicMemory::copyFrom(const BasicMemory& other) {
+    if(other.baseAddr != baseAddr || other.size != size) {
+        throw EmulatorException("Cannot copy between differently sized memories");
+    }
+    std::copy(other.memoryArray.get(), other.memoryArray.get() + size, memoryArray.get());
+}
+
+uint8_t* BasicMemory::getHostPointer(uint32_t addr, uint32_t length) {
+    if(addr < baseAddr || addr - baseAddr > size || length > size - (addr - baseAddr)) {
+        return nullptr;
+    }
+    return memoryArray.get() + (addr - baseAddr);
+}
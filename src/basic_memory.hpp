@@ -14,6 +14,11 @@ class BasicMemory: public MemoryMapHandler {
 
         uint32_t getBaseAddr() const;
         uint32_t getSize() const;
+
+        void copyFrom(const BasicMemory& other);
+
+        // Host pointer to a guest range for bulk copies, nullptr if the range is not fully inside this memory
+        uint8_t* getHostPointer(uint32_t addr, uint32_t length);
      private:
         std::unique_ptr<uint8_t[]> memoryArray;
 };
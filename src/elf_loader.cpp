@@ -0,0 +1,208 @@
+#include "elf_loader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    constexpr uint8_t ELF_MAGIC[4] = {0x7F, 'E', 'L', 'F'};
+    constexpr uint8_t ELFCLASS32 = 1;
+    constexpr uint8_t ELFDATA2LSB = 1;
+    constexpr uint16_t ET_EXEC = 2;
+    constexpr uint16_t EM_RISCV = 243;
+
+    constexpr uint32_t PT_LOAD = 1;
+    constexpr uint32_t SHT_SYMTAB = 2;
+
+    constexpr uint8_t STT_OBJECT = 1;
+    constexpr uint8_t STT_FUNC = 2;
+    constexpr uint16_t SHN_UNDEF = 0;
+
+    struct Elf32Header {
+        uint8_t  ident[16];
+        uint16_t type;
+        uint16_t machine;
+        uint32_t version;
+        uint32_t entry;
+        uint32_t phoff;
+        uint32_t shoff;
+        uint32_t flags;
+        uint16_t ehsize;
+        uint16_t phentsize;
+        uint16_t phnum;
+        uint16_t shentsize;
+        uint16_t shnum;
+        uint16_t shstrndx;
+    };
+
+    struct Elf32ProgramHeader {
+        uint32_t type;
+        uint32_t offset;
+        uint32_t vaddr;
+        uint32_t paddr;
+        uint32_t filesz;
+        uint32_t memsz;
+        uint32_t flags;
+        uint32_t align;
+    };
+
+    struct Elf32SectionHeader {
+        uint32_t name;
+        uint32_t type;
+        uint32_t flags;
+        uint32_t addr;
+        uint32_t offset;
+        uint32_t size;
+        uint32_t link;
+        uint32_t info;
+        uint32_t addralign;
+        uint32_t entsize;
+    };
+
+    struct Elf32Symbol {
+        uint32_t name;
+        uint32_t value;
+        uint32_t size;
+        uint8_t  info;
+        uint8_t  other;
+        uint16_t shndx;
+    };
+
+    // The structures above match the on-disk layout, which is little endian like the host
+    template<typename T>
+    bool readAt(std::ifstream& file, uint32_t offset, T& out) {
+        file.seekg(offset);
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&out), sizeof(T)));
+    }
+
+    bool readBytes(std::ifstream& file, uint32_t offset, uint32_t length, std::vector<uint8_t>& out) {
+        out.resize(length);
+        file.seekg(offset);
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(out.data()), length));
+    }
+}
+
+bool ElfLoader::load(const std::string& fileName, BasicMemory& memory) {
+    std::ifstream file(fileName, std::ios::in | std::ios::binary);
+    if(!file) {
+        return false;
+    }
+
+    Elf32Header header;
+    if(!readAt(file, 0, header) || std::memcmp(header.ident, ELF_MAGIC, sizeof(ELF_MAGIC)) != 0) {
+        return false;
+    }
+
+    if(header.ident[4] != ELFCLASS32 || header.ident[5] != ELFDATA2LSB || header.type != ET_EXEC ||
+       header.machine != EM_RISCV || header.phentsize != sizeof(Elf32ProgramHeader)) {
+        return false;
+    }
+
+    entry = header.entry;
+    bool entryMapped = false;
+    programHeaderAddr = 0;
+    programHeaderCount = header.phnum;
+    endAddr = 0;
+
+    for(uint16_t i = 0; i < header.phnum; ++i) {
+        Elf32ProgramHeader segment;
+        if(!readAt(file, header.phoff + i * sizeof(Elf32ProgramHeader), segment)) {
+            return false;
+        }
+        if(segment.type != PT_LOAD || segment.memsz == 0) {
+            continue;
+        }
+        if(segment.filesz > segment.memsz) {
+            return false;
+        }
+
+        // Segments are placed at their physical address, the guest enables paging itself
+        uint8_t *dest = memory.getHostPointer(segment.paddr, segment.memsz);
+        if(dest == nullptr) {
+            return false;
+        }
+
+        file.seekg(segment.offset);
+        if(!file.read(reinterpret_cast<char*>(dest), segment.filesz)) {
+            return false;
+        }
+        std::memset(dest + segment.filesz, 0, segment.memsz - segment.filesz);
+
+        if(header.phoff - segment.offset < segment.filesz) {
+            programHeaderAddr = header.phoff - segment.offset + segment.paddr;
+        }
+        endAddr = std::max(endAddr, segment.paddr + segment.memsz);
+
+        if(!entryMapped && header.entry - segment.vaddr < segment.memsz) {
+            entry = header.entry - segment.vaddr + segment.paddr;
+            entryMapped = true;
+        }
+    }
+
+    symbols.clear();
+    if(header.shnum != 0 && header.shentsize == sizeof(Elf32SectionHeader)) {
+        std::vector<uint8_t> sectionHeaders;
+        if(readBytes(file, header.shoff, header.shnum * sizeof(Elf32SectionHeader), sectionHeaders)) {
+            loadSymbols(sectionHeaders, file, header.shnum);
+        }
+    }
+
+    return true;
+}
+
+void ElfLoader::loadSymbols(const std::vector<uint8_t>& sectionHeaders, std::ifstream& file, uint16_t numSections) {
+    auto getSection = [&sectionHeaders](uint32_t index) {
+        Elf32SectionHeader section;
+        std::memcpy(&section, sectionHeaders.data() + index * sizeof(Elf32SectionHeader), sizeof(section));
+        return section;
+    };
+
+    for(uint16_t i = 0; i < numSections; ++i) {
+        Elf32SectionHeader symtab = getSection(i);
+        if(symtab.type != SHT_SYMTAB || symtab.link >= numSections) {
+            continue;
+        }
+
+        Elf32SectionHeader strtab = getSection(symtab.link);
+        std::vector<uint8_t> symbolData, strings;
+        if(!readBytes(file, symtab.offset, symtab.size, symbolData) || !readBytes(file, strtab.offset, strtab.size, strings)) {
+            continue;
+        }
+
+        for(size_t offset = 0; offset + sizeof(Elf32Symbol) <= symbolData.size(); offset += sizeof(Elf32Symbol)) {
+            Elf32Symbol symbol;
+            std::memcpy(&symbol, symbolData.data() + offset, sizeof(symbol));
+
+            uint8_t type = symbol.info & 0xF;
+            if((type != STT_FUNC && type != STT_OBJECT && type != 0) || symbol.shndx == SHN_UNDEF || symbol.name >= strings.size()) {
+                continue;
+            }
+
+            const char *name = reinterpret_cast<const char*>(strings.data()) + symbol.name;
+            size_t nameLength = strnlen(name, strings.size() - symbol.name);
+            if(nameLength == 0) {
+                continue;
+            }
+
+            symbols.push_back(ElfSymbol { std::string(name, nameLength), symbol.value, symbol.size, type == STT_FUNC });
+        }
+    }
+
+    std::sort(symbols.begin(), symbols.end(), [](const ElfSymbol& a, const ElfSymbol& b) {
+        return a.addr < b.addr;
+    });
+}
+
+const ElfSymbol* ElfLoader::findSymbol(uint32_t addr) const {
+    auto it = std::upper_bound(symbols.begin(), symbols.end(), addr, [](uint32_t value, const ElfSymbol& symbol) {
+        return value < symbol.addr;
+    });
+    if(it == symbols.begin()) {
+        return nullptr;
+    }
+
+    const ElfSymbol &symbol = *(it - 1);
+    if(symbol.size != 0 && addr - symbol.addr >= symbol.size) {
+        return nullptr;
+    }
+    return &symbol;
+}
@@ -0,0 +1,45 @@
+#ifndef __ELF_LOADER_HPP__
+#define __ELF_LOADER_HPP__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "basic_memory.hpp"
+
+struct ElfSymbol {
+    std::string name;
+    uint32_t addr;
+    uint32_t size;
+    bool isFunction;
+};
+
+// Loads a 32-bit little endian RISC-V ELF executable into guest memory
+class ElfLoader {
+    public:
+        // Copies every PT_LOAD segment to its physical address and zero fills the rest of its memory size
+        bool load(const std::string& fileName, BasicMemory& memory);
+
+        // Physical address of e_entry, translated through the segment containing it
+        uint32_t getEntry() const { return entry; }
+
+        // Where the program headers ended up in memory and the end of the highest segment, for user mode auxv and brk
+        uint32_t getProgramHeaderAddr() const { return programHeaderAddr; }
+        uint16_t getProgramHeaderCount() const { return programHeaderCount; }
+        uint32_t getEndAddr() const { return endAddr; }
+
+        // Symbols sorted by address
+        const std::vector<ElfSymbol>& getSymbols() const { return symbols; }
+
+        // The symbol containing addr, or the closest one below it if it has no size
+        const ElfSymbol* findSymbol(uint32_t addr) const;
+    private:
+        uint32_t entry = 0;
+        uint32_t programHeaderAddr = 0;
+        uint16_t programHeaderCount = 0;
+        uint32_t endAddr = 0;
+        std::vector<ElfSymbol> symbols;
+
+        void loadSymbols(const std::vector<uint8_t>& sectionHeaders, std::ifstream& file, uint16_t numSections);
+};
+
+#endif /* __ELF_LOADER_HPP__ */
@@ -5,9 +5,3 @@ EmulatorException::EmulatorException(const std::string& message): message(messag
 const std::string& EmulatorException::what() {
         return message;
 }
-
-RV32::DecoderException::DecoderException(const std::string& message, RV32::Instruction instr): EmulatorException(message), instr(instr) {}
-
-const RV32::Instruction& RV32::DecoderException::getInstruction() {
-        return instr;
-}
@@ -4,7 +4,6 @@
 #include <string>
 #include <sstream>
 #include <exception>
-#include "instruction.hpp"
 
 class EmulatorException: public std::exception {
     public:
@@ -14,14 +13,4 @@ class EmulatorException: public std::exception {
         std::string message;
 };
 
-namespace RV32 {
-    class DecoderException: public EmulatorException {
-        public:
-            DecoderException(const std::string& message, Instruction instr);
-            const Instruction& getInstruction();
-        private:
-            const Instruction instr;
-    };
-};
-
 #endif /* __EMULATOR_EXCEPTION_HPP__ */
@@ -0,0 +1,99 @@
+#include "input_log.hpp"
+#include "emulator_exception.hpp"
+#include <cstring>
+
+bool InputLog::openForRecording(const std::string& fileName, uint32_t instructionsPerTick) {
+    output.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!output) {
+        return false;
+    }
+
+    output.write(MAGIC, sizeof(MAGIC));
+    for(uint32_t i = 0; i < 4; ++i) {
+        output.put(static_cast<char>(instructionsPerTick >> (8 * i)));
+    }
+
+    recording = static_cast<bool>(output);
+    return recording;
+}
+
+bool InputLog::openForReplay(const std::string& fileName, uint32_t instructionsPerTick) {
+    input.open(fileName, std::ios::in | std::ios::binary);
+    if(!input) {
+        return false;
+    }
+
+    char magic[sizeof(MAGIC)];
+    uint8_t rate[4];
+    input.read(magic, sizeof(magic));
+    input.read(reinterpret_cast<char*>(rate), sizeof(rate));
+    if(!input || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+
+    // A different time rate changes when the guest polls for input, so the log would not line up
+    uint32_t recordedRate = rate[0] | (rate[1] << 8) | (rate[2] << 16) | (static_cast<uint32_t>(rate[3]) << 24);
+    if(recordedRate != instructionsPerTick) {
+        return false;
+    }
+
+    replaying = true;
+    readNext();
+    return true;
+}
+
+void InputLog::record(uint64_t instret, char c) {
+    uint64_t delta = instret - lastInstret;
+    lastInstret = instret;
+
+    do {
+        uint8_t byte = delta & 0x7F;
+        delta >>= 7;
+        output.put(static_cast<char>(delta != 0 ? (byte | 0x80) : byte));
+    } while(delta != 0);
+    output.put(c);
+
+    // Input is rare, flushing keeps the log usable if the emulator dies
+    output.flush();
+}
+
+char InputLog::replay(uint64_t instret) {
+    // The guest did not poll at the recorded instruction count, the run no longer matches the recording
+    if(hasNext && instret > nextInstret) {
+        throw EmulatorException("Replay diverged: input was recorded at instret " + std::to_string(nextInstret)
+            + " but the guest first read it at instret " + std::to_string(instret));
+    }
+    if(!hasNext || instret != nextInstret) {
+        return -1;
+    }
+
+    char c = nextChar;
+    readNext();
+    return c;
+}
+
+void InputLog::readNext() {
+    uint64_t delta = 0;
+    uint32_t shift = 0;
+    int byte;
+
+    do {
+        byte = input.get();
+        if(byte == EOF || shift >= 64) {
+            hasNext = false;
+            return;
+        }
+        delta |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        shift += 7;
+    } while((byte & 0x80) != 0);
+
+    int c = input.get();
+    if(c == EOF) {
+        hasNext = false;
+        return;
+    }
+
+    nextInstret += delta;
+    nextChar = static_cast<char>(c);
+    hasNext = true;
+}
@@ -0,0 +1,44 @@
+#ifndef __INPUT_LOG_HPP__
+#define __INPUT_LOG_HPP__
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// Records console input together with the instruction count at which the guest read it,
+// so that a run with deterministic time can be replayed exactly.
+//
+// File format: an 8 byte magic, the 32-bit little endian instructions per timer tick, then one
+// entry per input byte: the instret delta to the previous entry as a LEB128 varint, and the byte.
+class InputLog {
+    public:
+        bool openForRecording(const std::string& fileName, uint32_t instructionsPerTick);
+        bool openForReplay(const std::string& fileName, uint32_t instructionsPerTick);
+
+        bool isRecording() const { return recording; }
+        bool isReplaying() const { return replaying; }
+
+        void record(uint64_t instret, char c);
+
+        // Returns the byte recorded at this instruction count, or -1 if there is none.
+        // Throws if the recorded count has already passed without the guest reading it.
+        char replay(uint64_t instret);
+    private:
+        static constexpr char MAGIC[8] = {'R', 'V', '3', '2', 'I', 'N', 'P', 'T'};
+
+        std::ofstream output;
+        std::ifstream input;
+        bool recording = false;
+        bool replaying = false;
+
+        uint64_t lastInstret = 0;
+
+        // Next entry to replay, valid while hasNext is set
+        bool hasNext = false;
+        uint64_t nextInstret = 0;
+        char nextChar = 0;
+
+        void readNext();
+};
+
+#endif /* __INPUT_LOG_HPP__ */
@@ -0,0 +1,372 @@
+#include "linux_user.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <random>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+    // RV32 Linux system call numbers, from the generic system call table
+    enum Syscall: uint32_t {
+        SYS_GETCWD = 17,
+        SYS_IOCTL = 29,
+        SYS_OPENAT = 56,
+        SYS_CLOSE = 57,
+        SYS_LLSEEK = 62,
+        SYS_READ = 63,
+        SYS_WRITE = 64,
+        SYS_READV = 65,
+        SYS_WRITEV = 66,
+        SYS_READLINKAT = 78,
+        SYS_EXIT = 93,
+        SYS_EXIT_GROUP = 94,
+        SYS_SET_TID_ADDRESS = 96,
+        SYS_SET_ROBUST_LIST = 99,
+        SYS_SIGALTSTACK = 132,
+        SYS_RT_SIGACTION = 134,
+        SYS_RT_SIGPROCMASK = 135,
+        SYS_UNAME = 160,
+        SYS_GETPID = 172,
+        SYS_GETPPID = 173,
+        SYS_GETUID = 174,
+        SYS_GETEUID = 175,
+        SYS_GETGID = 176,
+        SYS_GETEGID = 177,
+        SYS_GETTID = 178,
+        SYS_BRK = 214,
+        SYS_MUNMAP = 215,
+        SYS_MMAP2 = 222,
+        SYS_MPROTECT = 226,
+        SYS_MADVISE = 233,
+        SYS_GETRANDOM = 278,
+        SYS_STATX = 291,
+        SYS_CLOCK_GETTIME64 = 403,
+        SYS_FUTEX_TIME64 = 422,
+    };
+
+    constexpr uint32_t AT_NULL = 0;
+    constexpr uint32_t AT_PHDR = 3;
+    constexpr uint32_t AT_PHENT = 4;
+    constexpr uint32_t AT_PHNUM = 5;
+    constexpr uint32_t AT_PAGESZ = 6;
+    constexpr uint32_t AT_ENTRY = 9;
+    constexpr uint32_t AT_UID = 11;
+    constexpr uint32_t AT_EUID = 12;
+    constexpr uint32_t AT_GID = 13;
+    constexpr uint32_t AT_EGID = 14;
+    constexpr uint32_t AT_SECURE = 23;
+    constexpr uint32_t AT_RANDOM = 25;
+
+    constexpr uint32_t ELF32_PHDR_SIZE = 32;
+    constexpr uint32_t MAP_FIXED = 0x10;
+    constexpr uint32_t MAP_ANONYMOUS = 0x20;
+    constexpr uint32_t UTSNAME_FIELD_LENGTH = 65;
+
+    uint32_t errorResult(int error) {
+        return static_cast<uint32_t>(-error);
+    }
+
+    // Host calls report failure through errno, the guest expects -errno in a0
+    uint32_t hostResult(int64_t result) {
+        return result < 0 ? errorResult(errno) : static_cast<uint32_t>(result);
+    }
+}
+
+LinuxUserEmulator::LinuxUserEmulator(BasicMemory &memory): memory(memory) {
+}
+
+uint8_t* LinuxUserEmulator::guestPointer(uint32_t addr, uint32_t length) {
+    return memory.getHostPointer(addr, length);
+}
+
+bool LinuxUserEmulator::readGuestString(uint32_t addr, std::string &out) {
+    out.clear();
+    for(uint8_t *c = guestPointer(addr, 1); c != nullptr && *c != 0; c = guestPointer(++addr, 1)) {
+        out.push_back(static_cast<char>(*c));
+    }
+    return guestPointer(addr, 1) != nullptr;
+}
+
+void LinuxUserEmulator::writeWord(uint32_t addr, uint32_t val) {
+    uint8_t *dest = guestPointer(addr, 4);
+    for(uint32_t i = 0; i < 4; ++i) {
+        dest[i] = static_cast<uint8_t>(val >> (8 * i));
+    }
+}
+
+uint32_t LinuxUserEmulator::pushBytes(uint32_t &sp, const void *data, uint32_t length) {
+    sp -= length;
+    std::memcpy(guestPointer(sp, length), data, length);
+    return sp;
+}
+
+bool LinuxUserEmulator::load(const std::string &fileName, const std::vector<std::string> &args, const std::vector<std::string> &env) {
+    if(!elfLoader.load(fileName, memory)) {
+        return false;
+    }
+
+    uint32_t memoryEnd = memory.getBaseAddr() + memory.getSize();
+    brkStart = brkCurrent = (elfLoader.getEndAddr() + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+    mmapTop = memoryEnd - STACK_SIZE;
+    if(brkStart >= mmapTop) {
+        return false;
+    }
+
+    // Strings and the AT_RANDOM bytes go at the top of the stack
+    uint32_t sp = memoryEnd;
+    std::vector<uint32_t> argPointers, envPointers;
+    for(const std::string &arg : args) {
+        argPointers.push_back(pushBytes(sp, arg.c_str(), arg.size() + 1));
+    }
+    for(const std::string &var : env) {
+        envPointers.push_back(pushBytes(sp, var.c_str(), var.size() + 1));
+    }
+
+    uint8_t randomBytes[16];
+    std::random_device random;
+    for(uint8_t &byte : randomBytes) {
+        byte = static_cast<uint8_t>(random());
+    }
+    uint32_t randomAddr = pushBytes(sp, randomBytes, sizeof(randomBytes));
+
+    std::vector<uint32_t> table;
+    table.push_back(args.size());
+    table.insert(table.end(), argPointers.begin(), argPointers.end());
+    table.push_back(0);
+    table.insert(table.end(), envPointers.begin(), envPointers.end());
+    table.push_back(0);
+
+    uint32_t auxv[][2] = {
+        {AT_PHDR, elfLoader.getProgramHeaderAddr()},
+        {AT_PHENT, ELF32_PHDR_SIZE},
+        {AT_PHNUM, elfLoader.getProgramHeaderCount()},
+        {AT_PAGESZ, PAGE_SIZE},
+        {AT_ENTRY, elfLoader.getEntry()},
+        {AT_UID, static_cast<uint32_t>(getuid())},
+        {AT_EUID, static_cast<uint32_t>(geteuid())},
+        {AT_GID, static_cast<uint32_t>(getgid())},
+        {AT_EGID, static_cast<uint32_t>(getegid())},
+        {AT_SECURE, 0},
+        {AT_RANDOM, randomAddr},
+        {AT_NULL, 0},
+    };
+    for(auto &entry : auxv) {
+        table.push_back(entry[0]);
+        table.push_back(entry[1]);
+    }
+
+    // The ABI requires sp to be 16 byte aligned at argc
+    sp = (sp - table.size() * 4) & ~0xFu;
+    for(size_t i = 0; i < table.size(); ++i) {
+        writeWord(sp + i * 4, table[i]);
+    }
+    stackPointer = sp;
+
+    return true;
+}
+
+bool LinuxUserEmulator::handleTrap(RV32::Hart &hart, uint32_t cause, uint32_t tval) {
+    RV32::Registers &gpr = hart.getRegisters();
+
+    if(cause != U_ECALL_CAUSE) {
+        std::cerr << "Unhandled trap " << cause << " (tval 0x" << std::hex << tval << ") at pc 0x" << hart.getPC() << std::dec << std::endl;
+        exited = true;
+        exitCode = 128 + 11; // report it like a SIGSEGV
+        return true;
+    }
+
+    const uint32_t args[6] = {gpr.a0, gpr.a1, gpr.a2, gpr.a3, gpr.a4, gpr.a5};
+    gpr.a0 = handleSyscall(gpr.a7, args);
+    return true;
+}
+
+uint32_t LinuxUserEmulator::handleSyscall(uint32_t number, const uint32_t (&args)[6]) {
+    switch(number) {
+        case SYS_READ:
+        case SYS_WRITE: {
+            uint8_t *buffer = guestPointer(args[1], args[2]);
+            if(buffer == nullptr) {
+                return errorResult(EFAULT);
+            }
+            return hostResult(number == SYS_READ ? ::read(args[0], buffer, args[2]) : ::write(args[0], buffer, args[2]));
+        }
+        case SYS_READV:
+        case SYS_WRITEV: {
+            // The guest iovec has 32-bit base and length fields
+            std::vector<iovec> iov(args[2]);
+            for(uint32_t i = 0; i < args[2]; ++i) {
+                uint8_t *entry = guestPointer(args[1] + i * 8, 8);
+                if(entry == nullptr) {
+                    return errorResult(EFAULT);
+                }
+                uint32_t base, length;
+                std::memcpy(&base, entry, 4);
+                std::memcpy(&length, entry + 4, 4);
+                iov[i].iov_base = guestPointer(base, length);
+                iov[i].iov_len = length;
+                if(iov[i].iov_base == nullptr && length != 0) {
+                    return errorResult(EFAULT);
+                }
+            }
+            return hostResult(number == SYS_READV ? ::readv(args[0], iov.data(), iov.size()) : ::writev(args[0], iov.data(), iov.size()));
+        }
+        case SYS_OPENAT: {
+            std::string path;
+            if(!readGuestString(args[1], path)) {
+                return errorResult(EFAULT);
+            }
+            return hostResult(::openat(static_cast<int32_t>(args[0]), path.c_str(), args[2], args[3]));
+        }
+        case SYS_CLOSE:
+            // Keep the emulator's own standard streams open
+            if(args[0] <= 2) {
+                return 0;
+            }
+            return hostResult(::close(args[0]));
+        case SYS_LLSEEK: {
+            uint8_t *result = guestPointer(args[3], 8);
+            if(result == nullptr) {
+                return errorResult(EFAULT);
+            }
+            off_t offset = ::lseek(args[0], (static_cast<int64_t>(args[1]) << 32) | args[2], args[4]);
+            if(offset < 0) {
+                return errorResult(errno);
+            }
+            int64_t value = offset;
+            std::memcpy(result, &value, sizeof(value));
+            return 0;
+        }
+        case SYS_READLINKAT: {
+            std::string path;
+            uint8_t *buffer = guestPointer(args[2], args[3]);
+            if(!readGuestString(args[1], path) || buffer == nullptr) {
+                return errorResult(EFAULT);
+            }
+            return hostResult(::readlinkat(static_cast<int32_t>(args[0]), path.c_str(), reinterpret_cast<char*>(buffer), args[3]));
+        }
+        case SYS_GETCWD: {
+            uint8_t *buffer = guestPointer(args[0], args[1]);
+            if(buffer == nullptr) {
+                return errorResult(EFAULT);
+            }
+            if(::getcwd(reinterpret_cast<char*>(buffer), args[1]) == nullptr) {
+                return errorResult(errno);
+            }
+            return std::strlen(reinterpret_cast<char*>(buffer)) + 1;
+        }
+        case SYS_STATX: {
+            // struct statx has the same fixed layout on every architecture, so the host fills the guest buffer directly
+            std::string path;
+            uint8_t *buffer = guestPointer(args[4], sizeof(struct statx));
+            if(!readGuestString(args[1], path) || buffer == nullptr) {
+                return errorResult(EFAULT);
+            }
+            return hostResult(::statx(static_cast<int32_t>(args[0]), path.c_str(), args[2], args[3], reinterpret_cast<struct statx*>(buffer)));
+        }
+        case SYS_IOCTL:
+            return errorResult(ENOTTY);
+        case SYS_EXIT:
+        case SYS_EXIT_GROUP:
+            exited = true;
+            exitCode = static_cast<int32_t>(args[0]);
+            return 0;
+        case SYS_SET_TID_ADDRESS:
+        case SYS_GETPID:
+        case SYS_GETTID:
+            return 1;
+        case SYS_GETPPID:
+            return 0;
+        case SYS_GETUID:
+            return getuid();
+        case SYS_GETEUID:
+            return geteuid();
+        case SYS_GETGID:
+            return getgid();
+        case SYS_GETEGID:
+            return getegid();
+        case SYS_SET_ROBUST_LIST:
+        case SYS_SIGALTSTACK:
+        case SYS_RT_SIGACTION:
+        case SYS_RT_SIGPROCMASK:
+        case SYS_MUNMAP:
+        case SYS_MPROTECT:
+        case SYS_MADVISE:
+        case SYS_FUTEX_TIME64:
+            return 0;
+        case SYS_UNAME: {
+            const char *fields[] = {"Linux", "rv32", "6.1.0", "#1", "riscv32", ""};
+            uint8_t *buffer = guestPointer(args[0], UTSNAME_FIELD_LENGTH * 6);
+            if(buffer == nullptr) {
+                return errorResult(EFAULT);
+            }
+            std::memset(buffer, 0, UTSNAME_FIELD_LENGTH * 6);
+            for(uint32_t i = 0; i < 6; ++i) {
+                std::strcpy(reinterpret_cast<char*>(buffer + i * UTSNAME_FIELD_LENGTH), fields[i]);
+            }
+            return 0;
+        }
+        case SYS_BRK:
+            if(args[0] >= brkStart && args[0] < mmapTop) {
+                if(args[0] > brkCurrent) {
+                    std::memset(guestPointer(brkCurrent, args[0] - brkCurrent), 0, args[0] - brkCurrent);
+                }
+                brkCurrent = args[0];
+            }
+            return brkCurrent;
+        case SYS_MMAP2: {
+            uint32_t length = (args[1] + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+            uint32_t addr = args[0];
+            if((args[3] & MAP_FIXED) == 0) {
+                if(length == 0 || mmapTop - brkCurrent < length) {
+                    return errorResult(ENOMEM);
+                }
+                mmapTop -= length;
+                addr = mmapTop;
+            }
+
+            uint8_t *dest = guestPointer(addr, length);
+            if(dest == nullptr) {
+                return errorResult(ENOMEM);
+            }
+            std::memset(dest, 0, length);
+
+            // File mappings are private copies, the offset is in pages
+            if((args[3] & MAP_ANONYMOUS) == 0 && ::pread(static_cast<int32_t>(args[4]), dest, args[1], static_cast<off_t>(args[5]) * PAGE_SIZE) < 0) {
+                return errorResult(errno);
+            }
+            return addr;
+        }
+        case SYS_GETRANDOM: {
+            uint8_t *buffer = guestPointer(args[0], args[1]);
+            if(buffer == nullptr) {
+                return errorResult(EFAULT);
+            }
+            std::random_device random;
+            for(uint32_t i = 0; i < args[1]; ++i) {
+                buffer[i] = static_cast<uint8_t>(random());
+            }
+            return args[1];
+        }
+        case SYS_CLOCK_GETTIME64: {
+            uint8_t *buffer = guestPointer(args[1], 16);
+            timespec now;
+            if(buffer == nullptr) {
+                return errorResult(EFAULT);
+            }
+            if(::clock_gettime(static_cast<clockid_t>(args[0]), &now) < 0) {
+                return errorResult(errno);
+            }
+            // The guest uses a 64-bit time_t and a 64-bit nanosecond field
+            int64_t fields[2] = {static_cast<int64_t>(now.tv_sec), static_cast<int64_t>(now.tv_nsec)};
+            std::memcpy(buffer, fields, sizeof(fields));
+            return 0;
+        }
+        default:
+            return errorResult(ENOSYS);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef __LINUX_USER_HPP__
+#define __LINUX_USER_HPP__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "basic_memory.hpp"
+#include "elf_loader.hpp"
+#include "hart.hpp"
+
+// Runs a static RV32 Linux executable in user mode without a kernel. The guest sees a flat
+// address space with paging off, and its system calls are translated to host system calls.
+class LinuxUserEmulator {
+    public:
+        explicit LinuxUserEmulator(BasicMemory &memory);
+
+        // Loads the executable and builds the initial stack with argv, envp and the auxiliary vector
+        bool load(const std::string &fileName, const std::vector<std::string> &args, const std::vector<std::string> &env);
+
+        uint32_t getEntry() const { return elfLoader.getEntry(); }
+        uint32_t getStackPointer() const { return stackPointer; }
+        const ElfLoader& getElfLoader() const { return elfLoader; }
+
+        // Installed as HartConfig::userTrapCallback
+        bool handleTrap(RV32::Hart &hart, uint32_t cause, uint32_t tval);
+
+        bool hasExited() const { return exited; }
+        int getExitCode() const { return exitCode; }
+    private:
+        static constexpr uint32_t PAGE_SIZE = 4096;
+        static constexpr uint32_t STACK_SIZE = 8 * 1024 * 1024;
+        static constexpr uint32_t U_ECALL_CAUSE = 8;
+
+        BasicMemory &memory;
+        ElfLoader elfLoader;
+        uint32_t stackPointer = 0;
+
+        uint32_t brkStart = 0;
+        uint32_t brkCurrent = 0;
+        uint32_t mmapTop = 0; // anonymous mappings are handed out downwards from below the stack
+
+        bool exited = false;
+        int exitCode = 0;
+
+        uint32_t handleSyscall(uint32_t number, const uint32_t (&args)[6]);
+        uint8_t* guestPointer(uint32_t addr, uint32_t length);
+        bool readGuestString(uint32_t addr, std::string &out);
+        uint32_t pushBytes(uint32_t &sp, const void *data, uint32_t length);
+        void writeWord(uint32_t addr, uint32_t val);
+};
+
+#endif /* __LINUX_USER_HPP__ */
@@ -2,10 +2,21 @@
 #include <iostream>
 #include <cstdint>
 #include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <vector>
 #include <ncurses.h>
+#include <unistd.h>
 #include "basic_memory.hpp"
 #include "mem_map_manager.hpp"
 #include "hart.hpp"
+#include "lockstep.hpp"
+#include "gdb_stub.hpp"
+#include "input_log.hpp"
+#include "elf_loader.hpp"
+#include "linux_user.hpp"
+#include "simpoint.hpp"
 #include "emulator_exception.hpp"
 
 static bool isRunning = true;
@@ -36,24 +47,125 @@ bool loadMemory(std::string fileName, uint32_t startAddr, BasicMemory &memory) {
     }
 
     uint32_t nBytes = file.tellg();
-    uint32_t lastAddr = startAddr + nBytes;
-
-    if(startAddr < memory.getBaseAddr() || nBytes >= memory.getSize()) {
+    uint8_t *dest = memory.getHostPointer(startAddr, nBytes);
+    if(dest == nullptr) {
         return false;
     }
 
     file.seekg(0, std::ios::beg);
-    for(uint32_t addr = startAddr; addr < lastAddr; ++addr) {
-        uint32_t byte = file.get();
-        if(file.eof()) {
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(dest), nBytes));
+}
+
+void printFusionStats(const RV32::Hart &hart) {
+    const RV32::FusionStats &stats = hart.getFusionStats();
+    uint64_t totalFused = 0;
+
+    std::cout << "Fused instruction pairs:" << std::endl;
+    for(size_t i = 1; i < static_cast<size_t>(RV32::FusionKind::COUNT); ++i) {
+        std::cout << "  " << RV32::getFusionName(static_cast<RV32::FusionKind>(i)) << ": " << stats.counts[i] << std::endl;
+        totalFused += stats.counts[i];
+    }
+    std::cout << "  total: " << totalFused << " of " << hart.getInstret() << " instructions retired" << std::endl;
+}
+
+// Parses colon separated numbers such as 32k:8:64, sizes may have a k or m suffix
+bool parseGeometry(const std::string &text, uint32_t *values, size_t count) {
+    std::istringstream input(text);
+    std::string field;
+    size_t parsed = 0;
+
+    while(std::getline(input, field, ':')) {
+        if(parsed == count || field.empty()) {
             return false;
         }
-        memory.writeByte(addr, byte);
+
+        size_t end;
+        uint32_t val;
+        try {
+            val = std::stoul(field, &end, 0);
+        } catch(std::exception &e) {
+            return false;
+        }
+        if(end < field.size()) {
+            char suffix = field[end++];
+            if(suffix == 'k' || suffix == 'K') {
+                val *= 1024;
+            } else if(suffix == 'm' || suffix == 'M') {
+                val *= 1024 * 1024;
+            } else {
+                return false;
+            }
+        }
+        if(end != field.size()) {
+            return false;
+        }
+        values[parsed++] = val;
     }
+    return parsed == count;
+}
+
+void printMemoryHierarchyReport(RV32::MemoryHierarchySimulator &simulator, const ElfLoader &elfLoader, std::ostream &out) {
+    simulator.finish();
+    simulator.printReport(out, [&elfLoader](uint32_t pc) {
+        const ElfSymbol *symbol = elfLoader.findSymbol(pc);
+        if(symbol == nullptr) {
+            return std::string();
+        }
+        std::ostringstream name;
+        name << symbol->name << "+0x" << std::hex << (pc - symbol->addr);
+        return name.str();
+    });
+}
 
+// Parses a comma separated list such as mul=3,div=20 into the timing configuration
+bool parseLatencies(const std::string &text, RV32::TimingConfig &config) {
+    std::istringstream input(text);
+    std::string field;
+
+    while(std::getline(input, field, ',')) {
+        size_t separator = field.find('=');
+        if(separator == std::string::npos) {
+            return false;
+        }
+
+        std::string name = field.substr(0, separator);
+        uint32_t val;
+        if(!parseGeometry(field.substr(separator + 1), &val, 1)) {
+            return false;
+        }
+
+        if(name == "mul") {
+            config.mulLatency = val;
+        } else if(name == "div") {
+            config.divLatency = val;
+        } else if(name == "load") {
+            config.loadLatency = val;
+        } else if(name == "amo") {
+            config.amoLatency = val;
+        } else if(name == "mispredict") {
+            config.mispredictPenalty = val;
+        } else if(name == "trap") {
+            config.trapPenalty = val;
+        } else if(name == "predictor") {
+            config.predictorEntries = val;
+        } else {
+            return false;
+        }
+    }
     return true;
 }
 
+void printTimingStats(const RV32::Hart &hart, const RV32::TimingModel &timingModel, std::ostream &out) {
+    const RV32::TimingStats &stats = timingModel.getStats();
+    double cpi = hart.getInstret() == 0 ? 0.0 : static_cast<double>(hart.getCycle()) / hart.getInstret();
+
+    out << "Timing model:" << std::endl;
+    out << "  " << hart.getCycle() << " cycles, " << hart.getInstret() << " instructions, CPI "
+        << std::fixed << std::setprecision(3) << cpi << std::defaultfloat << std::setprecision(6) << std::endl;
+    out << "  " << stats.mispredicts << " of " << stats.branches << " branches and indirect jumps mispredicted" << std::endl;
+    out << "  " << stats.loadUseStalls << " load-use stalls" << std::endl;
+}
+
 void initCurses() {
     initscr();
     raw();
@@ -62,47 +174,498 @@ void initCurses() {
     nodelay(stdscr, TRUE);
 }
 
+int runUserProgram(const std::vector<std::string> &args, uint32_t timebaseFreq, bool enableFusion, uint32_t vlen,
+                   RV32::MemoryHierarchySimulator *memorySimulator, RV32::TimingModel *timingModel, RV32::SyscallTracer *syscallTracer) {
+    // Flat guest address space starting at 0, the stack sits at the top
+    BasicMemory memory(0, 0x8000000);
+    MemoryMapManager mmap;
+    mmap.registerHandler(memory);
+
+    std::vector<std::string> env;
+    for(char **var = environ; *var != nullptr; ++var) {
+        env.push_back(*var);
+    }
+
+    LinuxUserEmulator userEmulator(memory);
+    if(!userEmulator.load(args[0], args, env)) {
+        std::cout << "Trouble loading ELF file " << args[0] << "!" << std::endl;
+        return -1;
+    }
+
+    RV32::HartConfig config = {
+        .timebaseFreq = timebaseFreq,
+        .shutdownCallback = []() {},
+        .putCharCallback = [](char) {},
+        .getCharCallback = []() { return static_cast<char>(-1); },
+        .emulateMisaligned = true, // Linux emulates misaligned accesses for user programs
+        .enableFusion = enableFusion,
+        .vlen = vlen,
+        .userTrapCallback = [&userEmulator](RV32::Hart &hart, uint32_t cause, uint32_t tval) {
+            return userEmulator.handleTrap(hart, cause, tval);
+        },
+    };
+
+    RV32::Hart hart(userEmulator.getEntry(), mmap, config);
+    hart.getRegisters().sp = userEmulator.getStackPointer();
+    hart.setMemorySimulator(memorySimulator);
+    hart.setTimingModel(timingModel);
+    hart.setSyscallTracer(syscallTracer);
+
+    // Drop to user mode with paging off, the FPU and vector unit start out enabled as Linux does for new processes
+    // and rdcycle, rdtime and rdinstret work as they do under the kernel
+    RV32::HartState state = hart.getState();
+    state.supervisorMode = false;
+    state.csr.sstatus.fs = 1; // initial
+    state.csr.sstatus.vs = 1;
+    state.csr.scounteren.cy = 1;
+    state.csr.scounteren.tm = 1;
+    state.csr.scounteren.ir = 1;
+    hart.setState(state);
+
+    try {
+        while(!userEmulator.hasExited()) {
+            hart.stepInstruction();
+        }
+    } catch(EmulatorException &ee) {
+        std::cout << ee.what() << std::endl;
+        return -1;
+    }
+
+    // The program's own output goes to stdout
+    if(memorySimulator != nullptr) {
+        printMemoryHierarchyReport(*memorySimulator, userEmulator.getElfLoader(), std::cerr);
+    }
+    if(timingModel != nullptr) {
+        printTimingStats(hart, *timingModel, std::cerr);
+    }
+
+    return userEmulator.getExitCode();
+}
+
+// Resolves a --milestone-pc argument, an address or a symbol of the --elf file
+bool addPCMilestone(const std::string &text, const ElfLoader &elfLoader, RV32::BootTimeline &bootTimeline) {
+    try {
+        size_t end;
+        uint32_t pc = std::stoul(text, &end, 0);
+        if(end == text.size()) {
+            bootTimeline.addPCTrigger(pc, text);
+            return true;
+        }
+    } catch(std::exception &e) {
+    }
+
+    for(const ElfSymbol &symbol : elfLoader.getSymbols()) {
+        if(symbol.name == text) {
+            bootTimeline.addPCTrigger(symbol.addr, text);
+            return true;
+        }
+    }
+    return false;
+}
+
 int main(int argc, const char *argv[]) {
+    // Boot milestones are timed from here, so loading the images is part of the timeline
+    RV32::BootTimeline bootTimeline;
+
     const uint32_t timebaseFreq = 10000000;
+    const uint32_t instructionsPerTick = 10;
     std::string fileName;
     MemoryMapManager mmap;
+    bool lockstep = false;
+    bool emulateMisaligned = false;
+    bool enableFusion = false;
+    bool skipIdleLoops = false;
+    bool deterministic = false;
+    uint32_t vlen = 128;
+    std::string recordFileName;
+    std::string replayFileName;
+    std::string traceFileName;
+    std::string syscallTraceFileName;
+    std::string gdbAddress;
+    std::string timelineFileName;
+    std::vector<std::string> pcMilestones;
+    std::vector<std::string> consoleMilestones;
+    std::string bootDoneText;
+    std::string elfFileName;
+    std::string initramfsFileName;
+    std::string dtbFileName;
+    std::vector<std::string> userArgs;
+    bool simulateMemory = false;
+    RV32::MemoryHierarchyConfig memoryConfig;
+    bool enableTiming = false;
+    bool cycleTime = false;
+    RV32::TimingConfig timingConfig;
+    bool sampled = false;
+    SimPointConfig simpointConfig;
+    auto lockstepGranularity = RV32::LockstepChecker::Granularity::INSTRUCTION;
+
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if(arg == "--lockstep") {
+            lockstep = true;
+        } else if(arg == "--lockstep-block") {
+            lockstep = true;
+            lockstepGranularity = RV32::LockstepChecker::Granularity::BLOCK;
+        } else if(arg == "--emulate-misaligned") {
+            emulateMisaligned = true;
+        } else if(arg == "--fusion") {
+            enableFusion = true;
+        } else if(arg == "--skip-idle") {
+            skipIdleLoops = true;
+        } else if(arg == "--deterministic") {
+            deterministic = true;
+        } else if(arg == "--user" && i + 1 < argc) {
+            // Everything after the executable is passed to it
+            userArgs.assign(argv + i + 1, argv + argc);
+            break;
+        } else if(arg == "--elf" && i + 1 < argc) {
+            elfFileName = argv[++i];
+        } else if(arg == "--initramfs" && i + 1 < argc) {
+            initramfsFileName = argv[++i];
+        } else if(arg == "--dtb" && i + 1 < argc) {
+            dtbFileName = argv[++i];
+        } else if(arg == "--trace" && i + 1 < argc) {
+            traceFileName = argv[++i];
+        } else if(arg == "--syscall-trace" && i + 1 < argc) {
+            syscallTraceFileName = argv[++i];
+        } else if(arg == "--gdb" && i + 1 < argc) {
+            gdbAddress = argv[++i];
+        } else if(arg == "--boot-timeline" && i + 1 < argc) {
+            timelineFileName = argv[++i];
+        } else if(arg == "--milestone-pc" && i + 1 < argc) {
+            pcMilestones.push_back(argv[++i]);
+        } else if(arg == "--milestone-console" && i + 1 < argc) {
+            consoleMilestones.push_back(argv[++i]);
+        } else if(arg == "--boot-done" && i + 1 < argc) {
+            bootDoneText = argv[++i];
+        } else if((arg == "--record" || arg == "--replay") && i + 1 < argc) {
+            deterministic = true;
+            (arg == "--record" ? recordFileName : replayFileName) = argv[++i];
+        } else if(arg == "--timing") {
+            enableTiming = true;
+        } else if(arg == "--cycle-time") {
+            enableTiming = true;
+            cycleTime = true;
+        } else if(arg == "--latency" && i + 1 < argc) {
+            if(!parseLatencies(argv[++i], timingConfig)) {
+                std::cout << "Expected name=cycles,... for " << arg << std::endl;
+                return -1;
+            }
+            enableTiming = true;
+        } else if(arg == "--simpoint" && i + 1 < argc) {
+            uint32_t values[2] = {0, simpointConfig.maxClusters};
+            if(!parseGeometry(argv[++i], values, 1) && !parseGeometry(argv[i], values, 2)) {
+                std::cout << "Expected interval[:clusters] for " << arg << std::endl;
+                return -1;
+            }
+            simpointConfig.intervalLength = values[0];
+            simpointConfig.maxClusters = values[1];
+            sampled = true;
+            deterministic = true;
+        } else if(arg == "--simpoint-limit" && i + 1 < argc) {
+            try {
+                simpointConfig.maxInstructions = std::stoull(argv[++i], nullptr, 0);
+            } catch(std::exception &e) {
+                std::cout << "Expected an instruction count for " << arg << std::endl;
+                return -1;
+            }
+        } else if(arg == "--vlen" && i + 1 < argc) {
+            try {
+                vlen = std::stoul(argv[++i], nullptr, 0);
+            } catch(std::exception &e) {
+                vlen = 0;
+            }
+            if((vlen & (vlen - 1)) != 0 || vlen < RV32::VectorRegisters::MIN_VLEN || vlen > RV32::VectorRegisters::MAX_VLEN) {
+                std::cout << "Expected a power of two from 128 to 1024 for " << arg << std::endl;
+                return -1;
+            }
+        } else if(arg == "--cache-sim") {
+            simulateMemory = true;
+        } else if((arg == "--l1i" || arg == "--l1d" || arg == "--l2") && i + 1 < argc) {
+            RV32::CacheConfig &cache = arg == "--l1i" ? memoryConfig.l1i : arg == "--l1d" ? memoryConfig.l1d : memoryConfig.l2;
+            uint32_t values[3];
+            if(!parseGeometry(argv[++i], values, 3)) {
+                std::cout << "Expected size:ways:line for " << arg << std::endl;
+                return -1;
+            }
+            cache = RV32::CacheConfig {values[0], values[1], values[2]};
+            simulateMemory = true;
+        } else if((arg == "--itlb" || arg == "--dtlb") && i + 1 < argc) {
+            RV32::TLBConfig &tlb = arg == "--itlb" ? memoryConfig.itlb : memoryConfig.dtlb;
+            uint32_t values[2];
+            if(!parseGeometry(argv[++i], values, 2)) {
+                std::cout << "Expected entries:ways for " << arg << std::endl;
+                return -1;
+            }
+            tlb = RV32::TLBConfig {values[0], values[1]};
+            simulateMemory = true;
+        } else {
+            std::cout << "Unknown option " << arg << std::endl;
+            return -1;
+        }
+    }
+
+    if(!gdbAddress.empty() && (lockstep || sampled || !userArgs.empty())) {
+        std::cout << "--gdb can not be combined with --lockstep, --simpoint or --user" << std::endl;
+        return -1;
+    }
+
+    bool recordTimeline = !timelineFileName.empty() || !pcMilestones.empty() || !consoleMilestones.empty() || !bootDoneText.empty();
+    if(recordTimeline && (lockstep || sampled || !userArgs.empty())) {
+        std::cout << "--boot-timeline and milestones can not be combined with --lockstep, --simpoint or --user" << std::endl;
+        return -1;
+    }
+
+    std::unique_ptr<RV32::MemoryHierarchySimulator> memorySimulator;
+    std::unique_ptr<RV32::TimingModel> timingModel;
+    try {
+        if(simulateMemory) {
+            memorySimulator = std::make_unique<RV32::MemoryHierarchySimulator>(memoryConfig);
+        }
+        if(enableTiming) {
+            timingModel = std::make_unique<RV32::TimingModel>(timingConfig);
+        }
+    } catch(EmulatorException &ee) {
+        std::cout << ee.what() << std::endl;
+        return -1;
+    }
+
+    RV32::SyscallTracer syscallTracer;
+    if(!syscallTraceFileName.empty() && !syscallTracer.open(syscallTraceFileName)) {
+        std::cout << "Trouble creating syscall trace " << syscallTraceFileName << "!" << std::endl;
+        return -1;
+    }
+    RV32::SyscallTracer *tracer = syscallTraceFileName.empty() ? nullptr : &syscallTracer;
+
+    if(!userArgs.empty()) {
+        return runUserProgram(userArgs, timebaseFreq, enableFusion, vlen, memorySimulator.get(), timingModel.get(), tracer);
+    }
 
     // 0x8000000 = 134 MB of memory
     BasicMemory memory(0x80000000, 0x8000000);
     mmap.registerHandler(memory);
 
-    fileName = "linux/Image";
-    if(!loadMemory(fileName, 0x80400000, memory)) {
-        std::cout << "Trouble reading file " << fileName << "!" << std::endl;
+    uint32_t entryPC = 0x80400000;
+    ElfLoader elfLoader;
+    if(!elfFileName.empty()) {
+        if(!elfLoader.load(elfFileName, memory)) {
+            std::cout << "Trouble loading ELF file " << elfFileName << "!" << std::endl;
+            return -1;
+        }
+        entryPC = elfLoader.getEntry();
+    } else {
+        fileName = "linux/Image";
+        if(!loadMemory(fileName, entryPC, memory)) {
+            std::cout << "Trouble reading file " << fileName << "!" << std::endl;
+            return -1;
+        }
+
+        // An ELF file only gets the initramfs and device tree it asks for
+        if(initramfsFileName.empty()) {
+            initramfsFileName = "linux/initramfs.cpio.gz";
+        }
+        if(dtbFileName.empty()) {
+            dtbFileName = "linux/emu.dtb";
+        }
+    }
+
+    if(!initramfsFileName.empty() && !loadMemory(initramfsFileName, 0x84400000, memory)) {
+        std::cout << "Trouble reading file " << initramfsFileName << "!" << std::endl;
         return -1;
     }
 
-    fileName = "linux/initramfs.cpio.gz";
-    if(!loadMemory(fileName, 0x84400000, memory)) {
-        std::cout << "Trouble reading file " << fileName << "!" << std::endl;
+    // The DTB address is passed in a1, without a device tree a1 starts out as zero
+    uint32_t dtbAddr = 0;
+    if(!dtbFileName.empty()) {
+        dtbAddr = 0x87000000;
+        if(!loadMemory(dtbFileName, dtbAddr, memory)) {
+            std::cout << "Trouble reading file " << dtbFileName << "!" << std::endl;
+            return -1;
+        }
+    }
+
+    for(const std::string &milestone : pcMilestones) {
+        if(!addPCMilestone(milestone, elfLoader, bootTimeline)) {
+            std::cout << "Expected an address or a symbol of the ELF file for --milestone-pc, got " << milestone << std::endl;
+            return -1;
+        }
+    }
+    for(const std::string &milestone : consoleMilestones) {
+        bootTimeline.addConsoleTrigger(milestone, false);
+    }
+    if(!bootDoneText.empty()) {
+        bootTimeline.addConsoleTrigger(bootDoneText, true);
+    }
+    if(!timelineFileName.empty() && !bootTimeline.open(timelineFileName)) {
+        std::cout << "Trouble creating boot timeline " << timelineFileName << "!" << std::endl;
+        return -1;
+    }
+
+    InputLog inputLog;
+    if(!recordFileName.empty() && !inputLog.openForRecording(recordFileName, instructionsPerTick)) {
+        std::cout << "Trouble creating input log " << recordFileName << "!" << std::endl;
+        return -1;
+    }
+    if(!replayFileName.empty() && !inputLog.openForReplay(replayFileName, instructionsPerTick)) {
+        std::cout << "Trouble reading input log " << replayFileName << "!" << std::endl;
         return -1;
     }
 
-    fileName = "linux/emu.dtb";
-    if(!loadMemory(fileName, 0x87000000, memory)) {
-        std::cout << "Trouble reading file " << fileName << "!" << std::endl;
+    RV32::TraceWriter traceWriter;
+    if(!traceFileName.empty() && !traceWriter.open(traceFileName)) {
+        std::cout << "Trouble creating trace " << traceFileName << "!" << std::endl;
         return -1;
     }
+    RV32::TraceRingBuffer *traceBuffer = traceFileName.empty() ? nullptr : &traceWriter.getBuffer();
+
+    // Console input and output are stamped with the instret of the hart using the console
+    RV32::Hart *inputHart = nullptr;
+    auto getChar = [&inputLog, &inputHart]() {
+        if(inputLog.isReplaying()) {
+            return inputLog.replay(inputHart->getInstret());
+        }
+        char c = emulatorGetchar();
+        if(inputLog.isRecording() && c != -1) {
+            inputLog.record(inputHart->getInstret(), c);
+        }
+        return c;
+    };
+
+    RV32::TimeSource timeSource = RV32::TimeSource::HOST_CLOCK;
+    if(cycleTime) {
+        timeSource = RV32::TimeSource::CYCLE;
+    } else if(deterministic) {
+        timeSource = RV32::TimeSource::INSTRET;
+    }
 
     RV32::HartConfig config = {
         .timebaseFreq = timebaseFreq,
         .shutdownCallback = emulatorShutdown,
         .putCharCallback = emulatorPutchar,
-        .getCharCallback = emulatorGetchar,
+        .getCharCallback = getChar,
+        .timeSource = timeSource,
+        .instructionsPerTick = instructionsPerTick,
+        .emulateMisaligned = emulateMisaligned,
+        .enableFusion = enableFusion,
+        .skipIdleLoops = skipIdleLoops,
+        .vlen = vlen,
     };
 
-    RV32::Hart hart(0x80400000, mmap, config);
+    // The boot ends with the emulator once the --boot-done text is printed
+    if(recordTimeline) {
+        config.putCharCallback = [&bootTimeline, &inputHart](char c) {
+            emulatorPutchar(c);
+            if(bootTimeline.noteConsoleOutput(c, inputHart->getInstret())) {
+                emulatorShutdown();
+            }
+        };
+    }
+
+    if(sampled) {
+        simpointConfig.timingConfig = timingConfig;
+        simpointConfig.simulateMemory = simulateMemory;
+        simpointConfig.memoryConfig = memoryConfig;
+
+        // Console input is disabled so both runs of the workload are identical
+        config.getCharCallback = []() { return static_cast<char>(-1); };
+
+        try {
+            RV32::Hart initialHart(entryPC, mmap, config);
+            // put DTB address in a1 for kernel
+            initialHart.getRegisters().a1 = dtbAddr;
+
+            SimPointRunner runner(simpointConfig, config);
+            runner.run(initialHart.getState(), memory, mmap);
+            std::cout << std::endl;
+            runner.printReport(std::cout);
+        } catch(EmulatorException &ee) {
+            std::cout << ee.what() << std::endl;
+            return -1;
+        }
+        return 0;
+    }
+
+    if(lockstep) {
+        MemoryMapManager referenceMmap;
+        BasicMemory referenceMemory(memory.getBaseAddr(), memory.getSize());
+        referenceMmap.registerHandler(referenceMemory);
+        referenceMemory.copyFrom(memory);
+
+        RV32::LockstepChecker checker(entryPC, mmap, referenceMmap, config, lockstepGranularity);
+
+        inputHart = &checker.getEngine();
+        checker.getEngine().setTraceBuffer(traceBuffer);
+        checker.getEngine().setSyscallTracer(tracer);
+        checker.getEngine().setMemorySimulator(memorySimulator.get());
+        if(enableTiming) {
+            checker.enableTimingModel(timingConfig);
+        }
+
+        // put DTB address in a1 for kernel
+        checker.getEngine().getRegisters().a1 = dtbAddr;
+        checker.syncReference();
+
+        initCurses();
+
+        while(isRunning) {
+            try {
+                if(!checker.step()) {
+                    isRunning = false;
+                }
+            } catch(EmulatorException &ee) {
+                std::cout << ee.what() << std::endl;
+                isRunning = false;
+            }
+        }
+
+        endwin();
+        if(!traceWriter.close()) {
+            std::cout << "Trouble writing trace " << traceFileName << "!" << std::endl;
+        }
+        if(memorySimulator) {
+            printMemoryHierarchyReport(*memorySimulator, elfLoader, std::cout);
+        }
+        std::cout << checker.getDivergenceReport();
+        return checker.getDivergenceReport().empty() ? 0 : 1;
+    }
+
+    RV32::Hart hart(entryPC, mmap, config);
+    inputHart = &hart;
+    hart.setTraceBuffer(traceBuffer);
+    hart.setSyscallTracer(tracer);
+    hart.setMemorySimulator(memorySimulator.get());
+    hart.setTimingModel(timingModel.get());
+    if(recordTimeline) {
+        hart.setBootTimeline(&bootTimeline);
+        bootTimeline.record("first instruction", hart.getInstret());
+    }
 
     // put DTB address in a1 for kernel
-    hart.getRegisters().a1 = 0x87000000;
+    hart.getRegisters().a1 = dtbAddr;
+
+    RV32::GDBStub gdbStub(hart);
+    if(!gdbAddress.empty()) {
+        std::cout << "Waiting for GDB on " << gdbAddress << std::endl;
+        if(!gdbStub.open(gdbAddress)) {
+            std::cout << "Trouble listening for GDB on " << gdbAddress << "!" << std::endl;
+            return -1;
+        }
+    }
 
     initCurses();
 
+    // Once GDB detaches the hart continues without it
+    if(!gdbAddress.empty()) {
+        try {
+            if(gdbStub.serve(isRunning) == RV32::GDBStub::Result::KILLED) {
+                isRunning = false;
+            }
+        } catch(EmulatorException &ee) {
+            std::cout << ee.what() << std::endl;
+            isRunning = false;
+        }
+    }
+
     while(isRunning) {
         try {
             hart.stepInstruction();
@@ -113,5 +676,21 @@ int main(int argc, const char *argv[]) {
     }
 
     endwin();
+
+    if(!traceWriter.close()) {
+        std::cout << "Trouble writing trace " << traceFileName << "!" << std::endl;
+    }
+    if(enableFusion) {
+        printFusionStats(hart);
+    }
+    if(memorySimulator) {
+        printMemoryHierarchyReport(*memorySimulator, elfLoader, std::cout);
+    }
+    if(timingModel) {
+        printTimingStats(hart, *timingModel, std::cout);
+    }
+    if(recordTimeline) {
+        bootTimeline.printReport(std::cout);
+    }
 }
 
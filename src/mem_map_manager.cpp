@@ -21,22 +21,34 @@ uint8_t MemoryMapManager::readByte(uint32_t addr) {
 }
 
 void MemoryMapManager::writeWord(uint32_t addr, uint32_t val) {
-    uint16_t half0 = val & 0xFFFF;
-    uint16_t half1 = (val >> 16) & 0xFFFF;
+    if(writeObserver) {
+        writeObserver(addr, 4, val);
+    }
 
-    writeHalfword(addr, half0);
-    writeHalfword(addr + 2, half1);
+    storeByte(addr, val & 0xFF);
+    storeByte(addr + 1, (val >> 8) & 0xFF);
+    storeByte(addr + 2, (val >> 16) & 0xFF);
+    storeByte(addr + 3, (val >> 24) & 0xFF);
 }
 
 void MemoryMapManager::writeHalfword(uint32_t addr, uint16_t val) {
-    uint8_t byte0 = val & 0xFF;
-    uint8_t byte1 = (val >> 8) & 0xFF;
+    if(writeObserver) {
+        writeObserver(addr, 2, val);
+    }
 
-    writeByte(addr, byte0);
-    writeByte(addr + 1, byte1);
+    storeByte(addr, val & 0xFF);
+    storeByte(addr + 1, (val >> 8) & 0xFF);
 }
 
 void MemoryMapManager::writeByte(uint32_t addr, uint8_t val) {
+    if(writeObserver) {
+        writeObserver(addr, 1, val);
+    }
+
+    storeByte(addr, val);
+}
+
+void MemoryMapManager::storeByte(uint32_t addr, uint8_t val) {
     getHandler(addr).writeByte(addr, val);
 }
 
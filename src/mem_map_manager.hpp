@@ -3,10 +3,13 @@
 
 #include <stdint.h>
 #include <vector>
+#include <functional>
 #include "mem_map_handler.hpp"
 
 class MemoryMapManager {
     public:
+        using WriteObserver = std::function<void(uint32_t addr, uint32_t size, uint32_t val)>;
+
         uint32_t readWord(uint32_t addr);
         uint16_t readHalfword(uint32_t addr);
         uint8_t  readByte(uint32_t addr);
@@ -17,8 +20,14 @@ class MemoryMapManager {
 
         void registerHandler(MemoryMapHandler& handler);
         MemoryMapHandler& getHandler(uint32_t addr);
+
+        // Called before every write with its size in bytes, used by the lockstep checker
+        void setWriteObserver(WriteObserver observer) { writeObserver = observer; }
     private:
         std::vector<MemoryMapHandler*> handlers;
+        WriteObserver writeObserver;
+
+        void storeByte(uint32_t addr, uint8_t val);
 };
 
 #endif /* __MEM_MAP_MANAGER_HPP__ */
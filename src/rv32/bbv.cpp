@@ -0,0 +1,48 @@
+#include "bbv.hpp"
+#include "emulator_exception.hpp"
+
+using RV32::BasicBlockProfiler;
+
+namespace {
+    // Deterministic pseudo random projection coefficient in [-1, 1] for a block and dimension
+    double projectionCoefficient(uint32_t blockStart, size_t dimension) {
+        uint64_t x = (static_cast<uint64_t>(blockStart) << 8) | dimension;
+        x ^= x >> 33;
+        x *= 0xFF51AFD7ED558CCDull;
+        x ^= x >> 33;
+        x *= 0xC4CEB9FE1A85EC53ull;
+        x ^= x >> 33;
+        return static_cast<double>(x >> 11) / static_cast<double>(1ull << 52) - 1.0;
+    }
+}
+
+BasicBlockProfiler::BasicBlockProfiler(uint64_t intervalLength): intervalLength(intervalLength) {
+    if(intervalLength == 0) {
+        throw EmulatorException("Interval length must be nonzero");
+    }
+}
+
+void BasicBlockProfiler::endBlock() {
+    blockCounts[blockStart] += blockLength;
+    blockLength = 0;
+}
+
+void BasicBlockProfiler::endInterval() {
+    // A block running across the boundary is split between the two intervals
+    if(blockLength != 0) {
+        endBlock();
+    }
+
+    // Vectors are normalized so every interval has the same total weight
+    Vector projected {};
+    for(const auto &[start, count] : blockCounts) {
+        double weight = static_cast<double>(count) / intervalLength;
+        for(size_t i = 0; i < DIMENSIONS; ++i) {
+            projected[i] += weight * projectionCoefficient(start, i);
+        }
+    }
+
+    intervals.push_back(projected);
+    blockCounts.clear();
+    intervalPosition = 0;
+}
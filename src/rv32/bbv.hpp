@@ -0,0 +1,52 @@
+#ifndef __BBV_HPP__
+#define __BBV_HPP__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace RV32 {
+    // Collects a basic block vector (instructions executed per block) for every interval of a fixed
+    // number of instructions. Only a random projection of each vector is kept, as SimPoint does.
+    class BasicBlockProfiler {
+        public:
+            static constexpr size_t DIMENSIONS = 15;
+            using Vector = std::array<double, DIMENSIONS>;
+
+            explicit BasicBlockProfiler(uint64_t intervalLength);
+
+            // Called for every retired instruction, a discontinuous nextPC ends the block
+            void retire(uint32_t pc, uint32_t nextPC, uint32_t length) {
+                if(blockLength++ == 0) {
+                    blockStart = pc;
+                }
+                if(nextPC != pc + length) {
+                    endBlock();
+                }
+                if(++intervalPosition == intervalLength) {
+                    endInterval();
+                }
+            }
+
+            uint64_t getIntervalLength() const { return intervalLength; }
+
+            // Vectors of the completed intervals, a trailing partial interval is not included
+            const std::vector<Vector>& getIntervals() const { return intervals; }
+        private:
+            const uint64_t intervalLength;
+            uint64_t intervalPosition = 0;
+
+            uint32_t blockStart = 0;
+            uint32_t blockLength = 0;
+            std::unordered_map<uint32_t, uint64_t> blockCounts;
+
+            std::vector<Vector> intervals;
+
+            void endBlock();
+            void endInterval();
+    };
+};
+
+#endif /* __BBV_HPP__ */
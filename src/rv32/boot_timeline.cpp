@@ -0,0 +1,176 @@
+#include "boot_timeline.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+using RV32::BootTimeline;
+
+namespace {
+    std::string escapeJSON(const std::string &text) {
+        std::ostringstream out;
+        for(char c : text) {
+            if(c == '"' || c == '\\') {
+                out << '\\' << c;
+            } else if(static_cast<unsigned char>(c) < 0x20) {
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<uint32_t>(c) << std::dec;
+            } else {
+                out << c;
+            }
+        }
+        return out.str();
+    }
+
+    double toMilliseconds(uint64_t nanoseconds) {
+        return nanoseconds / 1e6;
+    }
+}
+
+BootTimeline::BootTimeline(): startTime(std::chrono::steady_clock::now()) {
+}
+
+BootTimeline::~BootTimeline() {
+    if(trace.is_open()) {
+        trace << "]" << std::endl;
+    }
+}
+
+bool BootTimeline::open(const std::string &fileName) {
+    trace.open(fileName, std::ios::out | std::ios::trunc);
+    if(!trace) {
+        return false;
+    }
+
+    // Chrome accepts the JSON array format without the closing bracket
+    trace << "[{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"boot\"}}" << std::flush;
+    return true;
+}
+
+void BootTimeline::addPCTrigger(uint32_t pc, const std::string &name) {
+    pcTriggers.push_back(PCTrigger { pc, name });
+}
+
+void BootTimeline::addConsoleTrigger(const std::string &text, bool endsBoot) {
+    consoleTriggers.push_back(ConsoleTrigger { text, endsBoot });
+}
+
+void BootTimeline::record(const std::string &name, uint64_t instret) {
+    auto elapsed = std::chrono::steady_clock::now() - startTime;
+    milestones.push_back(Milestone { name, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()), instret });
+
+    if(milestones.size() >= 2) {
+        writePhase(milestones[milestones.size() - 2], milestones.back());
+    }
+}
+
+void BootTimeline::noteExecutionMode(bool paging, bool supervisor, uint64_t instret) {
+    if(paging && !pagingEnabled) {
+        pagingEnabled = true;
+        record("paging enabled", instret);
+    }
+    if(!supervisor && !userModeEntered) {
+        userModeEntered = true;
+        record("first user instruction", instret);
+    }
+}
+
+bool BootTimeline::checkPC(uint32_t pc, uint64_t instret) {
+    auto trigger = std::find_if(pcTriggers.begin(), pcTriggers.end(), [pc](const PCTrigger &trigger) {
+        return trigger.pc == pc;
+    });
+    if(trigger == pcTriggers.end()) {
+        return false;
+    }
+
+    // Triggers fire once, the hart stops checking after the last one
+    record(trigger->name, instret);
+    pcTriggers.erase(trigger);
+    return true;
+}
+
+bool BootTimeline::noteConsoleOutput(char c, uint64_t instret) {
+    if(c == '\n') {
+        if(!line.empty()) {
+            record("console: " + line.substr(0, MAX_LINE_LENGTH), instret);
+        }
+        line.clear();
+        return false;
+    }
+    if(c == '\r') {
+        return false;
+    }
+    line += c;
+
+    // A prompt never ends its line, so triggers are matched as the text arrives
+    bool bootDone = false;
+    for(auto trigger = consoleTriggers.begin(); trigger != consoleTriggers.end();) {
+        const std::string &text = trigger->text;
+        if(line.size() >= text.size() && line.compare(line.size() - text.size(), text.size(), text) == 0) {
+            record("console \"" + text + "\"", instret);
+            bootDone |= trigger->endsBoot;
+            trigger = consoleTriggers.erase(trigger);
+        } else {
+            ++trigger;
+        }
+    }
+    return bootDone;
+}
+
+void BootTimeline::writePhase(const Milestone &start, const Milestone &end) {
+    if(!trace.is_open()) {
+        return;
+    }
+
+    // Phases are named after the milestone that starts them, timestamps are in microseconds
+    trace << ",\n{\"name\":\"" << escapeJSON(start.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+          << std::fixed << std::setprecision(3)
+          << ",\"ts\":" << start.hostNanoseconds / 1e3 << ",\"dur\":" << (end.hostNanoseconds - start.hostNanoseconds) / 1e3
+          << ",\"args\":{\"until\":\"" << escapeJSON(end.name) << "\",\"instret\":" << start.instret
+          << ",\"instructions\":" << end.instret - start.instret << "}}";
+    trace << ",\n{\"name\":\"" << escapeJSON(end.name) << "\",\"ph\":\"i\",\"s\":\"p\",\"pid\":1,\"tid\":1"
+          << ",\"ts\":" << end.hostNanoseconds / 1e3 << ",\"args\":{\"instret\":" << end.instret << "}}" << std::flush;
+    trace << std::defaultfloat;
+}
+
+void BootTimeline::printReport(std::ostream &out) const {
+    if(milestones.empty()) {
+        return;
+    }
+
+    out << "Boot timeline:" << std::endl;
+    out << std::right << std::setw(12) << "host ms" << std::setw(12) << "+ms" << std::setw(16) << "instret"
+        << std::setw(14) << "+instret" << "  milestone" << std::endl;
+    out << std::fixed << std::setprecision(3);
+    for(size_t i = 0; i < milestones.size(); ++i) {
+        const Milestone &milestone = milestones[i];
+        const Milestone &previous = milestones[i == 0 ? 0 : i - 1];
+        out << std::setw(12) << toMilliseconds(milestone.hostNanoseconds)
+            << std::setw(12) << toMilliseconds(milestone.hostNanoseconds - previous.hostNanoseconds)
+            << std::setw(16) << milestone.instret << std::setw(14) << milestone.instret - previous.instret
+            << "  " << milestone.name << std::endl;
+    }
+
+    // Phase i lasts from milestone i to milestone i + 1
+    std::vector<size_t> phases;
+    for(size_t i = 0; i + 1 < milestones.size(); ++i) {
+        phases.push_back(i);
+    }
+    auto duration = [this](size_t i) {
+        return milestones[i + 1].hostNanoseconds - milestones[i].hostNanoseconds;
+    };
+    std::sort(phases.begin(), phases.end(), [&duration](size_t a, size_t b) {
+        return duration(a) > duration(b);
+    });
+    phases.resize(std::min(phases.size(), LONGEST_PHASES));
+
+    uint64_t total = milestones.back().hostNanoseconds - milestones.front().hostNanoseconds;
+    if(!phases.empty()) {
+        out << "Longest phases:" << std::endl;
+    }
+    for(size_t i : phases) {
+        double share = total == 0 ? 0.0 : 100.0 * duration(i) / total;
+        out << std::setw(12) << toMilliseconds(duration(i)) << " ms" << std::setprecision(1) << std::setw(7) << share << "%"
+            << std::setw(14) << milestones[i + 1].instret - milestones[i].instret << " instructions  after "
+            << milestones[i].name << std::setprecision(3) << std::endl;
+    }
+    out << std::defaultfloat << std::setprecision(6);
+}
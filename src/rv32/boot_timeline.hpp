@@ -0,0 +1,78 @@
+#ifndef __BOOT_TIMELINE_HPP__
+#define __BOOT_TIMELINE_HPP__
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace RV32 {
+    // Milestones of a boot stamped with the host time since the emulator started and with instret. Each milestone
+    // starts a phase that lasts until the next one, so the longest phases show where the boot spends its time.
+    class BootTimeline {
+        public:
+            struct Milestone {
+                std::string name;
+                uint64_t hostNanoseconds;
+                uint64_t instret;
+            };
+
+            BootTimeline();
+            ~BootTimeline();
+
+            // Streams the phases as a Chrome trace while the guest runs, so an interrupted boot still leaves a trace
+            bool open(const std::string &fileName);
+
+            void addPCTrigger(uint32_t pc, const std::string &name);
+
+            // A milestone for the first time the console output contains text, ending the boot if endsBoot is set
+            void addConsoleTrigger(const std::string &text, bool endsBoot);
+
+            void record(const std::string &name, uint64_t instret);
+
+            // Called by the hart whenever paging or the privilege mode may have changed
+            void noteExecutionMode(bool paging, bool supervisor, uint64_t instret);
+
+            // Called by the hart for every instruction while PC triggers are left, returns true if one fired
+            bool watchesPC() const { return !pcTriggers.empty(); }
+            bool checkPC(uint32_t pc, uint64_t instret);
+
+            // Called for every character written to the console, every line is a milestone.
+            // Returns true once a trigger that ends the boot fired.
+            bool noteConsoleOutput(char c, uint64_t instret);
+
+            const std::vector<Milestone>& getMilestones() const { return milestones; }
+            void printReport(std::ostream &out) const;
+        private:
+            static constexpr size_t MAX_LINE_LENGTH = 120;
+            static constexpr size_t LONGEST_PHASES = 10;
+
+            struct PCTrigger {
+                uint32_t pc;
+                std::string name;
+            };
+
+            struct ConsoleTrigger {
+                std::string text;
+                bool endsBoot;
+            };
+
+            const std::chrono::steady_clock::time_point startTime;
+            std::vector<Milestone> milestones;
+
+            std::vector<PCTrigger> pcTriggers;
+            std::vector<ConsoleTrigger> consoleTriggers;
+            std::string line;
+
+            bool pagingEnabled = false;
+            bool userModeEntered = false;
+
+            std::ofstream trace;
+
+            void writePhase(const Milestone &start, const Milestone &end);
+    };
+};
+
+#endif /* __BOOT_TIMELINE_HPP__ */
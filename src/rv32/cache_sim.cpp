@@ -0,0 +1,247 @@
+#include "cache_sim.hpp"
+#include "emulator_exception.hpp"
+#include <algorithm>
+#include <iomanip>
+
+using RV32::SetAssociativeCache;
+using RV32::MemoryHierarchySimulator;
+using RV32::MemoryHierarchyConfig;
+using RV32::MemoryAccess;
+
+namespace {
+    constexpr uint32_t PAGE_SIZE = 4096;
+
+    bool isPowerOfTwo(uint32_t val) {
+        return val != 0 && (val & (val - 1)) == 0;
+    }
+
+    void printLevel(std::ostream &out, const SetAssociativeCache &cache) {
+        if(!cache.isEnabled()) {
+            return;
+        }
+
+        uint64_t accesses = cache.getHits() + cache.getMisses();
+        double missRate = accesses == 0 ? 0.0 : 100.0 * cache.getMisses() / accesses;
+        std::streamsize precision = out.precision();
+        out << "  " << std::left << std::setw(5) << cache.getName() << std::right
+            << " accesses: " << std::setw(12) << accesses
+            << " misses: " << std::setw(12) << cache.getMisses()
+            << " (" << std::fixed << std::setprecision(2) << missRate << std::defaultfloat << std::setprecision(precision) << "%)";
+        if(cache.getWritebacks() != 0) {
+            out << " writebacks: " << cache.getWritebacks();
+        }
+        out << std::endl;
+    }
+}
+
+SetAssociativeCache::SetAssociativeCache(const std::string &name, uint32_t numEntries, uint32_t ways, uint32_t blockSize): name(name) {
+    if(numEntries == 0) {
+        return;
+    }
+    if(ways == 0 || numEntries % ways != 0 || !isPowerOfTwo(numEntries / ways) || !isPowerOfTwo(blockSize)) {
+        throw EmulatorException("Invalid " + name + " geometry, sets and block size must be powers of two");
+    }
+
+    numSets = numEntries / ways;
+    this->ways = ways;
+    while((1u << blockShift) < blockSize) {
+        ++blockShift;
+    }
+    entries.resize(numEntries, Way {0, 0, false, false});
+}
+
+bool SetAssociativeCache::access(uint32_t addr, bool write) {
+    uint32_t block = addr >> blockShift;
+    uint32_t set = block & (numSets - 1);
+    Way *setWays = &entries[set * ways];
+    Way *victim = setWays;
+
+    ++useCounter;
+    for(uint32_t i = 0; i < ways; ++i) {
+        Way &way = setWays[i];
+        if(way.valid && way.tag == block) {
+            way.lastUse = useCounter;
+            way.dirty |= write;
+            ++hits;
+            return true;
+        }
+        // Prefer an empty way, otherwise the least recently used one
+        if(victim->valid && (!way.valid || way.lastUse < victim->lastUse)) {
+            victim = &way;
+        }
+    }
+
+    ++misses;
+    if(victim->valid && victim->dirty) {
+        ++writebacks;
+    }
+    *victim = Way {block, useCounter, true, write};
+    return false;
+}
+
+void SetAssociativeCache::flush() {
+    for(Way &way : entries) {
+        way.valid = false;
+    }
+}
+
+MemoryHierarchySimulator::MemoryHierarchySimulator(const MemoryHierarchyConfig &config):
+    l1i("L1I", config.l1i.lineSize == 0 ? 0 : config.l1i.size / config.l1i.lineSize, config.l1i.ways, config.l1i.lineSize),
+    l1d("L1D", config.l1d.lineSize == 0 ? 0 : config.l1d.size / config.l1d.lineSize, config.l1d.ways, config.l1d.lineSize),
+    l2("L2", config.l2.lineSize == 0 ? 0 : config.l2.size / config.l2.lineSize, config.l2.ways, config.l2.lineSize),
+    itlb("ITLB", config.itlb.entries, config.itlb.ways, PAGE_SIZE),
+    dtlb("DTLB", config.dtlb.entries, config.dtlb.ways, PAGE_SIZE) {
+    batch.reserve(BATCH_SIZE);
+    worker = std::thread(&MemoryHierarchySimulator::run, this);
+}
+
+MemoryHierarchySimulator::~MemoryHierarchySimulator() {
+    finish();
+}
+
+void MemoryHierarchySimulator::submitBatch() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+
+    // Bounded so a slow simulation throttles the hart instead of growing without limit
+    queueChanged.wait(lock, [this]() { return queue.size() < MAX_QUEUED_BATCHES; });
+    queue.push_back(std::move(batch));
+    ++pendingBatches;
+    ++submittedBatches;
+
+    if(freeBatches.empty()) {
+        batch = std::vector<MemoryAccess>();
+        batch.reserve(BATCH_SIZE);
+    } else {
+        batch = std::move(freeBatches.back());
+        freeBatches.pop_back();
+    }
+
+    queueChanged.notify_all();
+}
+
+void MemoryHierarchySimulator::flush() {
+    if(worker.joinable() && !batch.empty()) {
+        submitBatch();
+    }
+}
+
+void MemoryHierarchySimulator::finish() {
+    if(!worker.joinable()) {
+        return;
+    }
+
+    if(!batch.empty()) {
+        submitBatch();
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueChanged.notify_all();
+    worker.join();
+}
+
+void MemoryHierarchySimulator::run() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+
+    while(true) {
+        queueChanged.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if(queue.empty()) {
+            break;
+        }
+
+        std::vector<MemoryAccess> current = std::move(queue.front());
+        queue.pop_front();
+        queueChanged.notify_all();
+
+        lock.unlock();
+        for(const MemoryAccess &access : current) {
+            simulate(access);
+        }
+        current.clear();
+        lock.lock();
+
+        freeBatches.push_back(std::move(current));
+        --pendingBatches;
+        queueChanged.notify_all();
+    }
+}
+
+MemoryHierarchySimulator::TLBMisses MemoryHierarchySimulator::getTLBMisses() {
+    if(countedBatches == submittedBatches) {
+        return countedTLBMisses;
+    }
+
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueChanged.wait(lock, [this]() { return pendingBatches == 0; });
+    countedBatches = submittedBatches;
+    countedTLBMisses = tlbMisses;
+    return countedTLBMisses;
+}
+
+void MemoryHierarchySimulator::simulate(const MemoryAccess &access) {
+    if(access.kind == MemoryAccess::Kind::TLB_FLUSH) {
+        itlb.flush();
+        dtlb.flush();
+        return;
+    }
+
+    bool fetch = access.kind == MemoryAccess::Kind::FETCH;
+    bool write = access.kind == MemoryAccess::Kind::STORE;
+    SetAssociativeCache &tlb = fetch ? itlb : dtlb;
+    SetAssociativeCache &l1 = fetch ? l1i : l1d;
+
+    bool tlbMiss = access.translated && tlb.isEnabled() && !tlb.access(access.vaddr, false);
+    if(tlbMiss) {
+        uint64_t &count = fetch ? tlbMisses.fetches : write ? tlbMisses.stores : tlbMisses.loads;
+        ++count;
+    }
+    bool l1Miss = l1.isEnabled() && !l1.access(access.paddr, write);
+
+    // L2 only sees what missed in L1, or everything when there is no L1
+    bool l2Miss = false;
+    if(l2.isEnabled() && (l1Miss || !l1.isEnabled())) {
+        l2Miss = !l2.access(access.paddr, write);
+    }
+
+    if(tlbMiss || l1Miss || l2Miss) {
+        PCStats &stats = pcStats[access.pc];
+        stats.tlbMisses += tlbMiss;
+        stats.l1Misses += l1Miss;
+        stats.l2Misses += l2Miss;
+    }
+}
+
+void MemoryHierarchySimulator::printReport(std::ostream &out, const Symbolizer &symbolizer, size_t topCount) const {
+    out << "Memory hierarchy:" << std::endl;
+    printLevel(out, itlb);
+    printLevel(out, dtlb);
+    printLevel(out, l1i);
+    printLevel(out, l1d);
+    printLevel(out, l2);
+
+    // Rank by the misses of the outermost level first, those are the most expensive
+    std::vector<std::pair<uint32_t, PCStats>> ranked(pcStats.begin(), pcStats.end());
+    std::sort(ranked.begin(), ranked.end(), [](const auto &a, const auto &b) {
+        if(a.second.l2Misses != b.second.l2Misses) {
+            return a.second.l2Misses > b.second.l2Misses;
+        }
+        if(a.second.l1Misses != b.second.l1Misses) {
+            return a.second.l1Misses > b.second.l1Misses;
+        }
+        return a.second.tlbMisses > b.second.tlbMisses;
+    });
+    ranked.resize(std::min(ranked.size(), topCount));
+
+    out << "Top missing instructions:" << std::endl;
+    out << "  " << std::left << std::setw(8) << "pc" << std::right << std::setw(12) << "L2" << std::setw(12) << "L1" << std::setw(12) << "TLB" << std::endl;
+    for(const auto &[pc, stats] : ranked) {
+        out << "  " << std::hex << std::setfill('0') << std::setw(8) << pc << std::dec << std::setfill(' ')
+            << std::setw(12) << stats.l2Misses << std::setw(12) << stats.l1Misses << std::setw(12) << stats.tlbMisses;
+        std::string symbol = symbolizer ? symbolizer(pc) : std::string();
+        if(!symbol.empty()) {
+            out << "  " << symbol;
+        }
+        out << std::endl;
+    }
+}
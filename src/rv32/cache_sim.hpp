@@ -0,0 +1,164 @@
+#ifndef __CACHE_SIM_HPP__
+#define __CACHE_SIM_HPP__
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace RV32 {
+    struct MemoryAccess {
+        enum class Kind: uint8_t {
+            FETCH, LOAD, STORE, TLB_FLUSH
+        };
+
+        uint32_t pc;
+        uint32_t vaddr;
+        uint32_t paddr;
+        Kind kind;
+        bool translated; // went through the page tables, so it is looked up in a TLB
+    };
+
+    // A size of zero disables the level
+    struct CacheConfig {
+        uint32_t size = 0;
+        uint32_t ways = 0;
+        uint32_t lineSize = 0;
+    };
+
+    // An entry count of zero disables the TLB, ways equal to entries makes it fully associative
+    struct TLBConfig {
+        uint32_t entries = 0;
+        uint32_t ways = 0;
+    };
+
+    struct MemoryHierarchyConfig {
+        CacheConfig l1i {32 * 1024, 8, 64};
+        CacheConfig l1d {32 * 1024, 8, 64};
+        CacheConfig l2 {512 * 1024, 8, 64};
+        TLBConfig itlb {32, 32};
+        TLBConfig dtlb {32, 32};
+    };
+
+    // Set associative array of tags with LRU replacement, models both caches and TLBs
+    class SetAssociativeCache {
+        public:
+            SetAssociativeCache(const std::string &name, uint32_t entries, uint32_t ways, uint32_t blockSize);
+
+            bool isEnabled() const { return numSets != 0; }
+            const std::string& getName() const { return name; }
+
+            // Returns true on a hit, misses allocate the block and may evict a dirty one
+            bool access(uint32_t addr, bool write);
+            void flush();
+
+            uint64_t getHits() const { return hits; }
+            uint64_t getMisses() const { return misses; }
+            uint64_t getWritebacks() const { return writebacks; }
+        private:
+            struct Way {
+                uint32_t tag;
+                uint64_t lastUse;
+                bool valid;
+                bool dirty;
+            };
+
+            const std::string name;
+            uint32_t numSets = 0;
+            uint32_t ways = 0;
+            uint32_t blockShift = 0;
+            std::vector<Way> entries;
+
+            uint64_t useCounter = 0;
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t writebacks = 0;
+    };
+
+    // Receives memory accesses from the hart in batches and simulates them on a worker thread
+    class MemoryHierarchySimulator {
+        public:
+            using Symbolizer = std::function<std::string(uint32_t pc)>;
+
+            struct TLBMisses {
+                uint64_t fetches = 0;
+                uint64_t loads = 0;
+                uint64_t stores = 0;
+            };
+
+            explicit MemoryHierarchySimulator(const MemoryHierarchyConfig &config);
+            ~MemoryHierarchySimulator();
+
+            void record(const MemoryAccess &access) {
+                batch.push_back(access);
+                if(batch.size() == BATCH_SIZE) {
+                    submitBatch();
+                }
+            }
+
+            // Simulates all recorded accesses and stops the worker, must be called before reading results
+            void finish();
+
+            // Hands the accesses recorded so far to the worker without waiting for a full batch
+            void flush();
+
+            void printReport(std::ostream &out, const Symbolizer &symbolizer, size_t topCount = 20) const;
+
+            // TLB misses of every batch handed to the worker so far, the batch being filled is not included.
+            // Waits for the worker whenever a batch was handed over since the last call, so the counts only
+            // depend on the recorded accesses and not on how far the worker got.
+            TLBMisses getTLBMisses();
+
+            const SetAssociativeCache& getL1I() const { return l1i; }
+            const SetAssociativeCache& getL1D() const { return l1d; }
+            const SetAssociativeCache& getL2() const { return l2; }
+            const SetAssociativeCache& getITLB() const { return itlb; }
+            const SetAssociativeCache& getDTLB() const { return dtlb; }
+        private:
+            static constexpr size_t BATCH_SIZE = 1 << 14;
+            static constexpr size_t MAX_QUEUED_BATCHES = 8;
+
+            struct PCStats {
+                uint64_t l1Misses = 0;
+                uint64_t l2Misses = 0;
+                uint64_t tlbMisses = 0;
+            };
+
+            SetAssociativeCache l1i;
+            SetAssociativeCache l1d;
+            SetAssociativeCache l2;
+            SetAssociativeCache itlb;
+            SetAssociativeCache dtlb;
+            std::unordered_map<uint32_t, PCStats> pcStats;
+            TLBMisses tlbMisses;
+
+            // Only used by the hart thread
+            uint64_t submittedBatches = 0;
+            uint64_t countedBatches = 0;
+            TLBMisses countedTLBMisses;
+
+            // Filled by the hart, handed to the worker when full
+            std::vector<MemoryAccess> batch;
+
+            std::mutex queueMutex;
+            std::condition_variable queueChanged;
+            std::deque<std::vector<MemoryAccess>> queue;
+            std::vector<std::vector<MemoryAccess>> freeBatches;
+            size_t pendingBatches = 0; // queued or being simulated
+            bool stopping = false;
+            std::thread worker;
+
+            void submitBatch();
+            void run();
+            void simulate(const MemoryAccess &access);
+    };
+};
+
+#endif /* __CACHE_SIM_HPP__ */
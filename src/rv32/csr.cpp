@@ -0,0 +1,187 @@
+#include "csr.hpp"
+#include "hart.hpp"
+#include "emulator_exception.hpp"
+#include <array>
+#include <utility>
+
+namespace {
+    using namespace RV32;
+
+    constexpr uint32_t SSTATUS_WRITE_MASK = 0x000C6722; // SIE, SPIE, VS, SPP, FS, SUM, MXR
+    constexpr uint32_t SIE_WRITE_MASK     = 0x00002222; // SSIE, STIE, SEIE, LCOFIE
+    constexpr uint32_t SIP_WRITE_MASK     = 0x00002002; // only SSIP and LCOFIP are writable from S-mode
+    constexpr uint32_t STVEC_WRITE_MASK   = 0xFFFFFFFD; // direct and vectored modes only
+    constexpr uint32_t SEPC_WRITE_MASK    = 0xFFFFFFFE; // IALIGN = 16
+    constexpr uint32_t SATP_WRITE_MASK    = 0x803FFFFF; // ASIDs are not implemented
+    constexpr uint32_t SCOUNTEREN_WRITE_MASK = 0xFFFFFFFF;
+    constexpr uint32_t FFLAGS_WRITE_MASK  = 0x0000001F;
+    constexpr uint32_t FRM_WRITE_MASK     = 0x00000007;
+    constexpr uint32_t FCSR_WRITE_MASK    = 0x000000FF;
+    constexpr uint32_t VSTART_WRITE_MASK  = 0x000003FF; // enough for VLMAX at the largest VLEN
+    constexpr uint32_t VXSAT_WRITE_MASK   = 0x00000001;
+    constexpr uint32_t VXRM_WRITE_MASK    = 0x00000003;
+    constexpr uint32_t VCSR_WRITE_MASK    = 0x00000007;
+
+    uint32_t readCycle(Hart &hart, uint32_t) {
+        return hart.getCycle() & 0xFFFFFFFF;
+    }
+
+    uint32_t readCycleh(Hart &hart, uint32_t) {
+        return hart.getCycle() >> 32;
+    }
+
+    uint32_t readTime(Hart &hart, uint32_t) {
+        return hart.getTime() & 0xFFFFFFFF;
+    }
+
+    uint32_t readTimeh(Hart &hart, uint32_t) {
+        return hart.getTime() >> 32;
+    }
+
+    uint32_t readFcsr(Hart &hart, uint32_t) {
+        CSRs &csr = hart.getCSRs();
+        return (csr.frm << 5) | csr.fflags;
+    }
+
+    void markFPDirty(Hart &hart) {
+        hart.getCSRs().markFPDirty();
+    }
+
+    void writeFcsr(Hart &hart) {
+        CSRs &csr = hart.getCSRs();
+        csr.fflags = csr.fcsr & FFLAGS_WRITE_MASK;
+        csr.frm = csr.fcsr >> 5;
+        csr.markFPDirty();
+    }
+
+    uint32_t readVcsr(Hart &hart, uint32_t) {
+        CSRs &csr = hart.getCSRs();
+        return (csr.vxrm << 1) | csr.vxsat;
+    }
+
+    void markVectorDirty(Hart &hart) {
+        hart.getCSRs().markVectorDirty();
+    }
+
+    void writeVcsr(Hart &hart) {
+        CSRs &csr = hart.getCSRs();
+        csr.vxsat = csr.vcsr & VXSAT_WRITE_MASK;
+        csr.vxrm = (csr.vcsr >> 1) & VXRM_WRITE_MASK;
+        csr.markVectorDirty();
+    }
+
+    void updateInterrupts(Hart &hart) {
+        hart.updateInterruptPending();
+    }
+
+    void updateStatus(Hart &hart) {
+        hart.getCSRs().updateDirtySummary();
+        hart.updateInterruptPending();
+    }
+
+    void updateExecutionMode(Hart &hart) {
+        hart.updateExecutionMode();
+    }
+
+    constexpr CSRDescriptor counter(int32_t counterEnableBit, CSRDescriptor::Storage storage, CSRDescriptor::ReadHook readHook = nullptr) {
+        return CSRDescriptor { CSRAccessType::URO, 0, counterEnableBit, storage, readHook, nullptr };
+    }
+
+    constexpr CSRDescriptor supervisor(uint32_t writeMask, CSRDescriptor::Storage storage, CSRDescriptor::WriteHook writeHook = nullptr) {
+        return CSRDescriptor { CSRAccessType::SRW, writeMask, -1, storage, nullptr, writeHook };
+    }
+
+    constexpr CSRDescriptor floatingPoint(uint32_t writeMask, CSRDescriptor::Storage storage, CSRDescriptor::WriteHook writeHook, CSRDescriptor::ReadHook readHook = nullptr) {
+        return CSRDescriptor { CSRAccessType::FRW, writeMask, -1, storage, readHook, writeHook };
+    }
+
+    constexpr CSRDescriptor vector(uint32_t writeMask, CSRDescriptor::Storage storage, CSRDescriptor::WriteHook writeHook, CSRDescriptor::ReadHook readHook = nullptr) {
+        return CSRDescriptor { CSRAccessType::VRW, writeMask, -1, storage, readHook, writeHook };
+    }
+
+    constexpr CSRDescriptor vectorConfig(CSRDescriptor::Storage storage) {
+        return CSRDescriptor { CSRAccessType::VRO, 0, -1, storage, nullptr, nullptr };
+    }
+
+    constexpr CSRDescriptor supervisorReadOnly(CSRDescriptor::Storage storage) {
+        return CSRDescriptor { CSRAccessType::SRO, 0, -1, storage, nullptr, nullptr };
+    }
+
+    template<uint32_t INDEX>
+    uint32_t& hpmcounter(CSRs &csr) {
+        return csr.hpmcounter[INDEX];
+    }
+
+    template<uint32_t INDEX>
+    uint32_t& hpmcounterh(CSRs &csr) {
+        return csr.hpmcounterh[INDEX];
+    }
+
+    template<uint32_t... INDICES>
+    constexpr void setHPMCounters(std::array<CSRDescriptor, NUM_CSRS> &table, std::integer_sequence<uint32_t, INDICES...>) {
+        constexpr uint32_t low = static_cast<uint32_t>(CSRAddress::HPMCOUNTER3);
+        constexpr uint32_t high = static_cast<uint32_t>(CSRAddress::HPMCOUNTER3H);
+        ((table[low + INDICES] = counter(3 + INDICES, hpmcounter<INDICES>)), ...);
+        ((table[high + INDICES] = counter(3 + INDICES, hpmcounterh<INDICES>)), ...);
+    }
+
+    constexpr std::array<CSRDescriptor, NUM_CSRS> buildCSRTable() {
+        std::array<CSRDescriptor, NUM_CSRS> table {};
+
+        for(auto &descriptor : table) {
+            descriptor = CSRDescriptor { CSRAccessType::INVALID, 0, -1, nullptr, nullptr, nullptr };
+        }
+
+        auto set = [&table](CSRAddress addr, CSRDescriptor descriptor) {
+            table[static_cast<uint32_t>(addr)] = descriptor;
+        };
+
+        set(CSRAddress::CYCLE,      counter(0, [](CSRs &csr) -> uint32_t& { return csr.cycle; }, readCycle));
+        set(CSRAddress::CYCLEH,     counter(0, [](CSRs &csr) -> uint32_t& { return csr.cycleh; }, readCycleh));
+        set(CSRAddress::TIME,       counter(1, [](CSRs &csr) -> uint32_t& { return csr.time; }, readTime));
+        set(CSRAddress::TIMEH,      counter(1, [](CSRs &csr) -> uint32_t& { return csr.timeh; }, readTimeh));
+        set(CSRAddress::INSTRET,    counter(2, [](CSRs &csr) -> uint32_t& { return csr.instret; }));
+        set(CSRAddress::INSTRETH,   counter(2, [](CSRs &csr) -> uint32_t& { return csr.instreth; }));
+        setHPMCounters(table, std::make_integer_sequence<uint32_t, NUM_HPM_COUNTERS>());
+
+        set(CSRAddress::FFLAGS,     floatingPoint(FFLAGS_WRITE_MASK, [](CSRs &csr) -> uint32_t& { return csr.fflags; }, markFPDirty));
+        set(CSRAddress::FRM,        floatingPoint(FRM_WRITE_MASK, [](CSRs &csr) -> uint32_t& { return csr.frm; }, markFPDirty));
+        set(CSRAddress::FCSR,       floatingPoint(FCSR_WRITE_MASK, [](CSRs &csr) -> uint32_t& { return csr.fcsr; }, writeFcsr, readFcsr));
+
+        set(CSRAddress::VSTART,     vector(VSTART_WRITE_MASK, [](CSRs &csr) -> uint32_t& { return csr.vstart; }, markVectorDirty));
+        set(CSRAddress::VXSAT,      vector(VXSAT_WRITE_MASK, [](CSRs &csr) -> uint32_t& { return csr.vxsat; }, markVectorDirty));
+        set(CSRAddress::VXRM,       vector(VXRM_WRITE_MASK, [](CSRs &csr) -> uint32_t& { return csr.vxrm; }, markVectorDirty));
+        set(CSRAddress::VCSR,       vector(VCSR_WRITE_MASK, [](CSRs &csr) -> uint32_t& { return csr.vcsr; }, writeVcsr, readVcsr));
+        set(CSRAddress::VL,         vectorConfig([](CSRs &csr) -> uint32_t& { return csr.vl; }));
+        set(CSRAddress::VTYPE,      vectorConfig([](CSRs &csr) -> uint32_t& { return csr.vtype; }));
+        set(CSRAddress::VLENB,      vectorConfig([](CSRs &csr) -> uint32_t& { return csr.vlenb; }));
+
+        set(CSRAddress::SSTATUS,    supervisor(SSTATUS_WRITE_MASK, [](CSRs &csr) -> uint32_t& { return csr.sstatus.bits; }, updateStatus));
+        set(CSRAddress::SIE,        supervisor(SIE_WRITE_MASK, [](CSRs &csr) -> uint32_t& { return csr.sie.bits; }, updateInterrupts));
+        set(CSRAddress::STVEC,      supervisor(STVEC_WRITE_MASK, [](CSRs &csr) -> uint32_t& { return csr.stvec.bits; }));
+        set(CSRAddress::SCOUNTEREN, supervisor(SCOUNTEREN_WRITE_MASK, [](CSRs &csr) -> uint32_t& { return csr.scounteren.bits; }));
+        set(CSRAddress::SSCRATCH,   supervisor(0xFFFFFFFF, [](CSRs &csr) -> uint32_t& { return csr.sscratch; }));
+        set(CSRAddress::SEPC,       supervisor(SEPC_WRITE_MASK, [](CSRs &csr) -> uint32_t& { return csr.sepc; }));
+        set(CSRAddress::SCAUSE,     supervisor(0xFFFFFFFF, [](CSRs &csr) -> uint32_t& { return csr.scause.bits; }));
+        set(CSRAddress::STVAL,      supervisor(0xFFFFFFFF, [](CSRs &csr) -> uint32_t& { return csr.stval; }));
+        set(CSRAddress::SIP,        supervisor(SIP_WRITE_MASK, [](CSRs &csr) -> uint32_t& { return csr.sip.bits; }, updateInterrupts));
+        set(CSRAddress::SATP,       supervisor(SATP_WRITE_MASK, [](CSRs &csr) -> uint32_t& { return csr.satp.bits; }, updateExecutionMode));
+        set(CSRAddress::SCOUNTOVF,  supervisorReadOnly([](CSRs &csr) -> uint32_t& { return csr.scountovf; }));
+
+        return table;
+    }
+
+    constexpr std::array<CSRDescriptor, NUM_CSRS> CSR_TABLE = buildCSRTable();
+};
+
+const RV32::CSRDescriptor& RV32::getCSRDescriptor(uint32_t addr) {
+    return CSR_TABLE[addr & (NUM_CSRS - 1)];
+}
+
+uint32_t& RV32::CSRs::operator[](uint32_t addr) {
+    const CSRDescriptor &descriptor = getCSRDescriptor(addr);
+    if(descriptor.storage == nullptr) {
+        throw EmulatorException("Unknown CSR " + std::to_string(addr));
+    }
+    return descriptor.storage(*this);
+}
@@ -2,19 +2,39 @@
 #define __CSR_HPP__
 
 #include <cstdint>
-#include <unordered_map>
+#include <cstring>
 #include "bit_field.hpp"
 #include "emulator_exception.hpp"
 
 namespace RV32 {
+    class Hart;
+    struct CSRs;
+
+    constexpr uint32_t NUM_CSRS = 4096;
+    constexpr uint32_t NUM_HPM_COUNTERS = 29;
+
     enum class CSRAccessType: uint32_t {
-        URW, URO, SRW
+        URW, URO, SRW, SRO,
+        FRW,        // like URW, but illegal while sstatus.FS is off
+        VRW, VRO,   // like URW and URO, but illegal while sstatus.VS is off
+        INVALID
     };
 
     enum class CSRAddress: uint32_t {
+        FFLAGS = 0x001,
+        FRM = 0x002,
+        FCSR = 0x003,
+        VSTART = 0x008,
+        VXSAT = 0x009,
+        VXRM = 0x00A,
+        VCSR = 0x00F,
         CYCLE = 0xC00,
         TIME = 0xC01,
         INSTRET = 0xC02,
+        HPMCOUNTER3 = 0xC03,
+        VL = 0xC20,
+        VTYPE = 0xC21,
+        VLENB = 0xC22,
         SSTATUS = 0x100,
         SIE = 0x104,
         STVEC = 0x105,
@@ -25,12 +45,23 @@ namespace RV32 {
         STVAL = 0x143,
         SIP = 0x144,
         SATP = 0x180,
+        SCOUNTOVF = 0xDA0,
         CYCLEH = 0xc80,
         TIMEH = 0xc81,
         INSTRETH = 0xc82,
+        HPMCOUNTER3H = 0xc83,
     };
 
     struct CSRs {
+        CSRs() = default;
+        CSRs(const CSRs& other) { *this = other; }
+
+        // The bit field unions are not assignable, so copy the raw register file
+        CSRs& operator=(const CSRs& other) {
+            std::memcpy(static_cast<void*>(this), &other, sizeof(CSRs));
+            return *this;
+        }
+
         uint32_t cycle;
         uint32_t cycleh;
 
@@ -39,6 +70,23 @@ namespace RV32 {
 
         uint32_t instret;
         uint32_t instreth;
+
+        // hpmcounter3 to hpmcounter31, programmed through the SBI PMU extension
+        uint32_t hpmcounter[NUM_HPM_COUNTERS];
+        uint32_t hpmcounterh[NUM_HPM_COUNTERS];
+        uint32_t scountovf;
+
+        uint32_t fflags;
+        uint32_t frm;
+        uint32_t fcsr;  // only holds writes, reads are composed from fflags and frm
+
+        uint32_t vstart;
+        uint32_t vxsat;
+        uint32_t vxrm;
+        uint32_t vcsr;  // only holds writes, reads are composed from vxrm and vxsat
+        uint32_t vl;
+        uint32_t vtype;
+        uint32_t vlenb;
         
         uint32_t sscratch;
         uint32_t sepc;
@@ -65,6 +113,7 @@ namespace RV32 {
             U32BitField<1, 1>    ssie;
             U32BitField<5, 5>    stie;
             U32BitField<9, 9>    seie;
+            U32BitField<13, 13>  lcofie;
         } sie;
 
         union {
@@ -80,6 +129,7 @@ namespace RV32 {
             U32BitField<0, 0>    cy;
             U32BitField<1, 1>    tm;
             U32BitField<2, 2>    ir;
+            U32BitField<3, 31>   hpm;
         } scounteren;
 
         union {
@@ -95,6 +145,7 @@ namespace RV32 {
             U32BitField<1, 1>    ssip;
             U32BitField<5, 5>    stip;
             U32BitField<9, 9>    seip;
+            U32BitField<13, 13>  lcofip;
         } sip;
 
         union {
@@ -105,71 +156,39 @@ namespace RV32 {
             U32BitField<31, 31>  mode;
         } satp;
 
-        uint32_t& operator[](uint32_t addr) {
-            switch(CSRAddress(addr)) {
-                case CSRAddress::CYCLE:
-                    return cycle;
-                case CSRAddress::TIME:
-                    return time;
-                case CSRAddress::INSTRET:
-                    return instret;
-                case CSRAddress::SSTATUS:
-                    return sstatus.bits;
-                case CSRAddress::SIE:
-                    return sie.bits;
-                case CSRAddress::STVEC:
-                    return stvec.bits;
-                case CSRAddress::SCOUNTEREN:
-                    return scounteren.bits;
-                case CSRAddress::SSCRATCH:
-                    return sscratch;
-                case CSRAddress::SEPC:
-                    return sepc;
-                case CSRAddress::SCAUSE:
-                    return scause.bits;
-                case CSRAddress::STVAL:
-                    return stval;
-                case CSRAddress::SIP:
-                    return sip.bits;
-                case CSRAddress::SATP:
-                    return satp.bits;
-                case CSRAddress::CYCLEH:
-                    return cycleh;
-                case CSRAddress::TIMEH:
-                    return timeh;
-                case CSRAddress::INSTRETH:
-                    return instreth;
-                default:
-                    throw EmulatorException("Unknown CSR " + std::to_string(addr));
-            }
+        // Raw access to the storage of a CSR, without permission checks or hooks
+        uint32_t& operator[](uint32_t addr);
+
+        // Called whenever the float or vector state changes, SD summarizes the dirty extension state
+        void markFPDirty() {
+            sstatus.fs = 3;
+            sstatus.sd = 1;
+        }
+
+        void markVectorDirty() {
+            sstatus.vs = 3;
+            sstatus.sd = 1;
         }
 
-        static constexpr CSRAccessType getAccessType(uint32_t addr) {
-            switch(CSRAddress(addr)) {
-                case CSRAddress::CYCLE:
-                case CSRAddress::TIME:
-                case CSRAddress::INSTRET:
-                case CSRAddress::CYCLEH:
-                case CSRAddress::TIMEH:
-                case CSRAddress::INSTRETH:
-                    return CSRAccessType::URO;
-                case CSRAddress::SSTATUS:
-                case CSRAddress::SIE:
-                case CSRAddress::STVEC:
-                case CSRAddress::SCOUNTEREN:
-                case CSRAddress::SSCRATCH:
-                case CSRAddress::SEPC:
-                case CSRAddress::SCAUSE:
-                case CSRAddress::STVAL:
-                case CSRAddress::SIP:
-                case CSRAddress::SATP:
-                    return CSRAccessType::SRW;
-                default:
-                    throw EmulatorException("Unknown CSR " + std::to_string(addr));
-            }
+        void updateDirtySummary() {
+            sstatus.sd = sstatus.fs == 3 || sstatus.vs == 3 || sstatus.xs == 3;
         }
     };
 
+    struct CSRDescriptor {
+        using Storage = uint32_t& (*)(CSRs &csr);
+        using ReadHook = uint32_t (*)(Hart &hart, uint32_t value);
+        using WriteHook = void (*)(Hart &hart);
+
+        CSRAccessType accessType;
+        uint32_t writeMask;         // bits outside the mask are read-only (WARL)
+        int32_t counterEnableBit;   // scounteren bit gating U-mode reads, or -1
+        Storage storage;
+        ReadHook readHook;          // computes the value on read, optional
+        WriteHook writeHook;        // applies side effects after a write, optional
+    };
+
+    const CSRDescriptor& getCSRDescriptor(uint32_t addr);
 };
 
 #endif /* __CSR_HPP__ */
@@ -1,264 +1,356 @@
 #include "decoder.hpp"
-#include "emulator_exception.hpp"
-
-RV32::InstructionType RV32::decodeInstructionType(Instruction instr) {
-    switch(instr.opcode) {
-        case 0b0000011: 
-            return InstructionType::LOAD;
-        case 0b0100011:
-            return InstructionType::STORE;
-        case 0b1100011:
-            return InstructionType::BRANCH;
-        case 0b1100111:
-        case 0b1101111:
-            return InstructionType::JUMP;
-        case 0b0101111:
-            return InstructionType::AMO;
-        case 0b0010011:
-            return InstructionType::OP_IMM;
-        case 0b0110011:
-            return InstructionType::OP;
-        case 0b1110011:
-            return InstructionType::SYSTEM;
-        case 0b0110111:
-        case 0b0010111:
-            return InstructionType::OP_UI;
-        case 0b0001111:
-            return InstructionType::OP_FENCE;
-        default:
-            throw DecoderException("Unknown instruction type", instr);
+#include "instruction_table.hpp"
+#include <array>
+
+namespace {
+    using namespace RV32;
+
+    // Instructions are bucketed by major opcode (bits 6:2) and funct3 (bits 14:12),
+    // so decoding is one bucket lookup followed by a short mask/match scan.
+    constexpr uint32_t BUCKET_FIELDS = 0x0000707C;
+    constexpr size_t NUM_BUCKETS = 256;
+    constexpr size_t NUM_INSTRUCTIONS = sizeof(INSTRUCTION_TABLE) / sizeof(INSTRUCTION_TABLE[0]);
+    constexpr size_t NUM_OPCODES = static_cast<size_t>(Opcode::INVALID) + 1;
+
+    using OperandExtractor = void (*)(Instruction instr, DecodedInstruction &decoded);
+
+    struct DecodeEntry {
+        uint32_t mask;
+        uint32_t match;
+        const InstructionDescriptor *descriptor;
+        OperandExtractor extract;
+    };
+
+    struct DecodeBucket {
+        uint16_t begin;
+        uint16_t end;
+    };
+
+    struct DecodeTables {
+        std::array<DecodeBucket, NUM_BUCKETS> buckets;
+        std::array<DecodeEntry, NUM_INSTRUCTIONS * 8> entries;
+        std::array<const InstructionDescriptor*, NUM_OPCODES> descriptors;
+    };
+
+    template<InstructionFormat FORMAT>
+    void extractOperands(Instruction instr, DecodedInstruction &decoded) {
+        if constexpr(FORMAT == InstructionFormat::R) {
+            decoded.rd = instr.r.rd;
+            decoded.rs1 = instr.r.rs1;
+            decoded.rs2 = instr.r.rs2;
+        } else if constexpr(FORMAT == InstructionFormat::I) {
+            decoded.rd = instr.i.rd;
+            decoded.rs1 = instr.i.rs1;
+            decoded.imm = instr.i.immediateValue();
+        } else if constexpr(FORMAT == InstructionFormat::SHIFT) {
+            decoded.rd = instr.i.rd;
+            decoded.rs1 = instr.i.rs1;
+            decoded.imm = instr.r.rs2;
+        } else if constexpr(FORMAT == InstructionFormat::S) {
+            decoded.rs1 = instr.s.rs1;
+            decoded.rs2 = instr.s.rs2;
+            decoded.imm = instr.s.immediateValue();
+        } else if constexpr(FORMAT == InstructionFormat::B) {
+            decoded.rs1 = instr.b.rs1;
+            decoded.rs2 = instr.b.rs2;
+            decoded.imm = instr.b.immediateValue();
+        } else if constexpr(FORMAT == InstructionFormat::U) {
+            decoded.rd = instr.u.rd;
+            decoded.imm = instr.u.immediateValue();
+        } else if constexpr(FORMAT == InstructionFormat::J) {
+            decoded.rd = instr.j.rd;
+            decoded.imm = instr.j.immediateValue();
+        } else if constexpr(FORMAT == InstructionFormat::CSR) {
+            decoded.rd = instr.i.rd;
+            decoded.rs1 = instr.i.rs1;
+            decoded.imm = instr.i.imm_11_0;
+        } else if constexpr(FORMAT == InstructionFormat::UNARY) {
+            decoded.rd = instr.i.rd;
+            decoded.rs1 = instr.i.rs1;
+        } else if constexpr(FORMAT == InstructionFormat::R4) {
+            decoded.rd = instr.r.rd;
+            decoded.rs1 = instr.r.rs1;
+            decoded.rs2 = instr.r.rs2;
+            decoded.imm = instr.r.funct7 >> 2;
+        } else if constexpr(FORMAT == InstructionFormat::V) {
+            decoded.rd = instr.r.rd;
+            decoded.rs1 = instr.r.rs1;
+            decoded.rs2 = instr.r.rs2;
+            decoded.imm = SIGN_EXTEND(instr.r.rs1, 5);
+        }
     }
-}
 
-RV32::Opcode RV32::decodeOpcode(Instruction instr) {
-    switch(decodeInstructionType(instr)) {
-        case InstructionType::LOAD: {
-            switch(instr.r.funct3) {
-                case 0b000:
-                    return Opcode::LB;
-                case 0b001:
-                    return Opcode::LH;
-                case 0b010:
-                    return Opcode::LW;
-                case 0b100:
-                    return Opcode::LBU;
-                case 0b101:
-                    return Opcode::LHU;
-                default:
-                    throw DecoderException("Unknown LOAD instruction", instr);
-            }
+    constexpr OperandExtractor getExtractor(InstructionFormat format) {
+        switch(format) {
+            case InstructionFormat::R:
+                return &extractOperands<InstructionFormat::R>;
+            case InstructionFormat::I:
+                return &extractOperands<InstructionFormat::I>;
+            case InstructionFormat::SHIFT:
+                return &extractOperands<InstructionFormat::SHIFT>;
+            case InstructionFormat::S:
+                return &extractOperands<InstructionFormat::S>;
+            case InstructionFormat::B:
+                return &extractOperands<InstructionFormat::B>;
+            case InstructionFormat::U:
+                return &extractOperands<InstructionFormat::U>;
+            case InstructionFormat::J:
+                return &extractOperands<InstructionFormat::J>;
+            case InstructionFormat::CSR:
+                return &extractOperands<InstructionFormat::CSR>;
+            case InstructionFormat::UNARY:
+                return &extractOperands<InstructionFormat::UNARY>;
+            case InstructionFormat::R4:
+                return &extractOperands<InstructionFormat::R4>;
+            case InstructionFormat::V:
+                return &extractOperands<InstructionFormat::V>;
+            case InstructionFormat::NONE:
+                break;
         }
-        case InstructionType::STORE: {
-            switch(instr.s.funct3) {
-                case 0b000:
-                    return Opcode::SB;
-                case 0b001:
-                    return Opcode::SH;
-                case 0b010:
-                    return Opcode::SW;
-                default:
-                    throw DecoderException("Unknown STORE instruction", instr);
+        return &extractOperands<InstructionFormat::NONE>;
+    }
+
+    constexpr uint32_t getBucketIndex(uint32_t bits) {
+        return (((bits >> 2) & 0x1F) << 3) | ((bits >> 12) & 0x7);
+    }
+
+    constexpr uint32_t getBucketBits(uint32_t index) {
+        return ((index >> 3) << 2) | ((index & 0x7) << 12);
+    }
+
+    // An entry belongs in every bucket whose opcode and funct3 bits its mask/match allows
+    constexpr bool isInBucket(const InstructionDescriptor &descriptor, uint32_t index) {
+        return ((getBucketBits(index) ^ descriptor.match) & descriptor.mask & BUCKET_FIELDS) == 0;
+    }
+
+    constexpr DecodeTables buildDecodeTables() {
+        DecodeTables tables {};
+        uint16_t count = 0;
+
+        for(uint32_t index = 0; index < NUM_BUCKETS; ++index) {
+            tables.buckets[index].begin = count;
+            for(const auto &descriptor : INSTRUCTION_TABLE) {
+                if(isInBucket(descriptor, index)) {
+                    tables.entries[count++] = DecodeEntry {
+                        descriptor.mask, descriptor.match, &descriptor, getExtractor(descriptor.format)
+                    };
+                }
             }
+            tables.buckets[index].end = count;
         }
-        case InstructionType::BRANCH: {
-            switch(instr.b.funct3) {
-                case 0b000:
-                    return Opcode::BEQ;
-                case 0b001:
-                    return Opcode::BNE;
-                case 0b100:
-                    return Opcode::BLT;
-                case 0b101:
-                    return Opcode::BGE;
-                case 0b110:
-                    return Opcode::BLTU;
-                case 0b111:
-                    return Opcode::BGEU;
-                default:
-                    throw DecoderException("Unknown BRANCH instruction", instr);
-            }
+
+        for(const auto &descriptor : INSTRUCTION_TABLE) {
+            tables.descriptors[static_cast<size_t>(descriptor.opcode)] = &descriptor;
         }
-        case InstructionType::JUMP: {
-            switch(instr.opcode) {
-                case 0b1100111:
-                    return Opcode::JALR;
-                case 0b1101111:
-                    return Opcode::JAL;
-                default:
-                    throw DecoderException("Unknown JUMP instruction", instr);
-            } 
+
+        return tables;
+    }
+
+    constexpr DecodeTables DECODE_TABLES = buildDecodeTables();
+
+    constexpr InstructionDescriptor INVALID_DESCRIPTOR = {
+        0, 0, InstructionType::INVALID, Opcode::INVALID, InstructionFormat::NONE, "invalid"
+    };
+
+    constexpr uint32_t OPCODE_LOAD     = 0b0000011;
+    constexpr uint32_t OPCODE_LOAD_FP  = 0b0000111;
+    constexpr uint32_t OPCODE_OP_IMM   = 0b0010011;
+    constexpr uint32_t OPCODE_STORE    = 0b0100011;
+    constexpr uint32_t OPCODE_STORE_FP = 0b0100111;
+    constexpr uint32_t OPCODE_OP       = 0b0110011;
+    constexpr uint32_t OPCODE_LUI      = 0b0110111;
+    constexpr uint32_t OPCODE_BRANCH   = 0b1100011;
+    constexpr uint32_t OPCODE_JALR     = 0b1100111;
+    constexpr uint32_t OPCODE_JAL      = 0b1101111;
+    constexpr uint32_t EBREAK_BITS     = 0x00100073;
+
+    // Reserved compressed encodings expand to zero, which is not a valid instruction either
+    constexpr uint32_t ILLEGAL_EXPANSION = 0;
+
+    constexpr uint32_t field(uint32_t bits, uint32_t high, uint32_t low) {
+        return (bits >> low) & ((1u << (high - low + 1)) - 1);
+    }
+
+    constexpr uint32_t encodeR(uint32_t opcode, uint32_t funct3, uint32_t funct7, uint32_t rd, uint32_t rs1, uint32_t rs2) {
+        return encode(opcode, funct3, funct7) | (rd << 7) | (rs1 << 15) | (rs2 << 20);
+    }
+
+    constexpr uint32_t encodeI(uint32_t opcode, uint32_t funct3, uint32_t rd, uint32_t rs1, uint32_t imm) {
+        return encode(opcode, funct3) | (rd << 7) | (rs1 << 15) | (imm << 20);
+    }
+
+    constexpr uint32_t encodeS(uint32_t opcode, uint32_t funct3, uint32_t rs1, uint32_t rs2, uint32_t imm) {
+        return encode(opcode, funct3) | (field(imm, 4, 0) << 7) | (rs1 << 15) | (rs2 << 20) | (field(imm, 11, 5) << 25);
+    }
+
+    constexpr uint32_t encodeB(uint32_t funct3, uint32_t rs1, uint32_t imm) {
+        return encode(OPCODE_BRANCH, funct3) | (field(imm, 11, 11) << 7) | (field(imm, 4, 1) << 8) | (rs1 << 15)
+            | (field(imm, 10, 5) << 25) | (field(imm, 12, 12) << 31);
+    }
+
+    constexpr uint32_t encodeJ(uint32_t rd, uint32_t imm) {
+        return encode(OPCODE_JAL) | (rd << 7) | (field(imm, 19, 12) << 12) | (field(imm, 11, 11) << 20)
+            | (field(imm, 10, 1) << 21) | (field(imm, 20, 20) << 31);
+    }
+
+    // C.SRLI, C.SRAI, C.ANDI and the register-register operations on x8-x15
+    constexpr uint32_t expandArithmetic(uint32_t bits) {
+        uint32_t rd = 8 + field(bits, 9, 7);
+        uint32_t rs2 = 8 + field(bits, 4, 2);
+        uint32_t shamt = field(bits, 6, 2);
+        bool bit12 = field(bits, 12, 12) != 0; // shamt[5] on RV64, reserved on RV32
+
+        switch(field(bits, 11, 10)) {
+            case 0b00:
+                return bit12 ? ILLEGAL_EXPANSION : encodeI(OPCODE_OP_IMM, 0b101, rd, rd, shamt);
+            case 0b01:
+                return bit12 ? ILLEGAL_EXPANSION : encodeI(OPCODE_OP_IMM, 0b101, rd, rd, shamt | 0x400);
+            case 0b10:
+                return encodeI(OPCODE_OP_IMM, 0b111, rd, rd, SIGN_EXTEND((field(bits, 12, 12) << 5) | shamt, 6));
+            default:
+                break;
         }
-        case InstructionType::AMO: {
-            switch(instr.r.funct7 >> 2) {
-                case 0b00010:
-                    return Opcode::LR_W;
-                case 0b00011:
-                    return Opcode::SC_W;
-                case 0b00001:
-                    return Opcode::AMOSWAP_W;
-                case 0b00000:
-                    return Opcode::AMOADD_W;
-                case 0b00100:
-                    return Opcode::AMOXOR_W;
-                case 0b01100:
-                    return Opcode::AMOAND_W;
-                case 0b01000:
-                    return Opcode::AMOOR_W;
-                case 0b10000:
-                    return Opcode::AMOMIN_W;
-                case 0b10100:
-                    return Opcode::AMOMAX_W;
-                case 0b11000:
-                    return Opcode::AMOMINU_W;
-                case 0b11100:
-                    return Opcode::AMOMAXU_W;
-                default:
-                    throw DecoderException("Unknown AMO instruction", instr);
-            }
+
+        if(bit12) {
+            return ILLEGAL_EXPANSION;
         }
-        case InstructionType::OP_IMM: {
-             switch(instr.r.funct3) {
-                 case 0b000:
-                     return Opcode::ADDI;
-                 case 0b010:
-                     return Opcode::SLTI;
-                 case 0b011:
-                     return Opcode::SLTIU;
-                 case 0b100:
-                     return Opcode::XORI;
-                 case 0b110:
-                     return Opcode::ORI;
-                 case 0b111:
-                     return Opcode::ANDI;
-                 case 0b001:
-                     return Opcode::SLLI;
-                 case 0b101:
-                     if(instr.r.funct7 == 0b0000000) {
-                         return Opcode::SRLI;
-                     } else if(instr.r.funct7 == 0b0100000) {
-                         return Opcode::SRAI;
-                     }
-                default:
-                    throw DecoderException("Unknown OP_IMM instruction", instr);
-             }
+
+        switch(field(bits, 6, 5)) {
+            case 0b00:
+                return encodeR(OPCODE_OP, 0b000, 0b0100000, rd, rd, rs2);
+            case 0b01:
+                return encodeR(OPCODE_OP, 0b100, 0, rd, rd, rs2);
+            case 0b10:
+                return encodeR(OPCODE_OP, 0b110, 0, rd, rd, rs2);
+            default:
+                return encodeR(OPCODE_OP, 0b111, 0, rd, rd, rs2);
         }
-        case InstructionType::OP: {
-            if((instr.r.funct7 & 0b0000001) == 0) {
-                switch(instr.r.funct3) {
-                    case 0b000:
-                        if(instr.r.funct7 == 0b0000000) {
-                            return Opcode::ADD;
-                        } else if(instr.r.funct7 == 0b0100000) {
-                            return Opcode::SUB;
-                        }
-                        throw DecoderException("Unknown OP instruction", instr);
-                    case 0b001:
-                        return Opcode::SLL;
-                    case 0b010:
-                        return Opcode::SLT;
-                    case 0b011:
-                        return Opcode::SLTU;
-                    case 0b100:
-                        return Opcode::XOR;
-                    case 0b101:
-                        if(instr.r.funct7 == 0b0000000) {
-                            return Opcode::SRL;
-                        } else if(instr.r.funct7 == 0b0100000) {
-                            return Opcode::SRA;
-                        }
-                        throw DecoderException("Unknown OP instruction", instr);
-                    case 0b110:
-                        return Opcode::OR;
-                    case 0b111:
-                        return Opcode::AND;
-                    default:
-                        throw DecoderException("Unknown OP instruction", instr);
-                }
-            } else {
-                switch(instr.r.funct3) {
-                    case 0b000:
-                        return Opcode::MUL;
-                    case 0b001:
-                        return Opcode::MULH;
-                    case 0b010:
-                        return Opcode::MULHSU;
-                    case 0b011:
-                        return Opcode::MULHU;
-                    case 0b100:
-                        return Opcode::DIV;
-                    case 0b101:
-                        return Opcode::DIVU;
-                    case 0b110:
-                        return Opcode::REM;
-                    case 0b111:
-                        return Opcode::REMU;
-                    default:
-                        throw DecoderException("Unknown M-extension instruction", instr);
-                }
+    }
+
+    // C.JR, C.MV, C.EBREAK, C.JALR and C.ADD
+    constexpr uint32_t expandJumpOrAdd(uint32_t bits) {
+        uint32_t rd = field(bits, 11, 7);
+        uint32_t rs2 = field(bits, 6, 2);
+
+        if(field(bits, 12, 12) == 0) {
+            if(rs2 != 0) {
+                return encodeR(OPCODE_OP, 0b000, 0, rd, 0, rs2);
             }
+            return rd != 0 ? encodeI(OPCODE_JALR, 0b000, 0, rd, 0) : ILLEGAL_EXPANSION;
         }
-        case InstructionType::SYSTEM: {
-            switch(instr.i.funct3) {
-                case 0b000:
-                    switch(instr.i.immediateValue()) {
-                        case 0x000:
-                            return Opcode::ECALL;
-                        case 0x001:
-                            return Opcode::EBREAK;
-                        case 0x102:
-                            return Opcode::SRET;
-                        case 0x105:
-                            return Opcode::WFI;
-                        default:
-                            switch(instr.r.funct7) {
-                                case 0b0001001:
-                                    return Opcode::SFENCE_VMA;
-                                case 0b0001011:
-                                    return Opcode::SINVAL_VMA;
-                                case 0b0001100:
-                                    if(instr.r.rs2 == 0b00000) {
-                                        return Opcode::SFENCE_W_INVAL;
-                                    } else if(instr.r.rs2 == 0b00001) {
-                                        return Opcode::SFENCE_INVAL_IR;
-                                    }
-                                    throw DecoderException("Unknown SFENCE instruction", instr);
-                            }
-                    }
-                case 0b001:
-                    return Opcode::CSRRW;
-                case 0b010:
-                    return Opcode::CSRRS;
-                case 0b011:
-                    return Opcode::CSRRC;
-                case 0b101:
-                    return Opcode::CSRRWI;
-                case 0b110:
-                    return Opcode::CSRRSI;
-                case 0b111:
-                    return Opcode::CSRRCI;
-                default:
-                    throw DecoderException("Unknown SYSTEM instruction", instr);
-            }
+
+        if(rs2 != 0) {
+            return encodeR(OPCODE_OP, 0b000, 0, rd, rd, rs2);
         }
-        case InstructionType::OP_UI: {
-            switch(instr.opcode) {
-                case 0b0110111:
-                    return Opcode::LUI;
-                case 0b0010111:
-                    return Opcode::AUIPC;
-                default:
-                    throw DecoderException("Unknown OP_UI instruction", instr);
+        return rd != 0 ? encodeI(OPCODE_JALR, 0b000, 1, rd, 0) : EBREAK_BITS;
+    }
+
+    // Returns the 32-bit instruction a 16-bit C extension instruction is shorthand for
+    constexpr uint32_t expandCompressed(uint32_t bits) {
+        uint32_t rd = field(bits, 11, 7);
+        uint32_t rs2 = field(bits, 6, 2);
+        uint32_t rdPrime = 8 + field(bits, 4, 2); // also rs2' of stores
+        uint32_t rs1Prime = 8 + field(bits, 9, 7);
+
+        uint32_t imm = SIGN_EXTEND((field(bits, 12, 12) << 5) | field(bits, 6, 2), 6);
+        uint32_t wordOffset = (field(bits, 12, 10) << 3) | (field(bits, 6, 6) << 2) | (field(bits, 5, 5) << 6);
+        uint32_t doubleOffset = (field(bits, 12, 10) << 3) | (field(bits, 6, 5) << 6);
+        uint32_t jumpOffset = SIGN_EXTEND((field(bits, 12, 12) << 11) | (field(bits, 11, 11) << 4) | (field(bits, 10, 9) << 8)
+            | (field(bits, 8, 8) << 10) | (field(bits, 7, 7) << 6) | (field(bits, 6, 6) << 7) | (field(bits, 5, 3) << 1)
+            | (field(bits, 2, 2) << 5), 12);
+        uint32_t branchOffset = SIGN_EXTEND((field(bits, 12, 12) << 8) | (field(bits, 11, 10) << 3) | (field(bits, 6, 5) << 6)
+            | (field(bits, 4, 3) << 1) | (field(bits, 2, 2) << 5), 9);
+        uint32_t wordStackLoad = (field(bits, 12, 12) << 5) | (field(bits, 6, 4) << 2) | (field(bits, 3, 2) << 6);
+        uint32_t doubleStackLoad = (field(bits, 12, 12) << 5) | (field(bits, 6, 5) << 3) | (field(bits, 4, 2) << 6);
+        uint32_t wordStackStore = (field(bits, 12, 9) << 2) | (field(bits, 8, 7) << 6);
+        uint32_t doubleStackStore = (field(bits, 12, 10) << 3) | (field(bits, 9, 7) << 6);
+
+        // Quadrant in bits 1:0, funct3 in bits 15:13
+        switch((field(bits, 1, 0) << 3) | field(bits, 15, 13)) {
+            case 0b00000: {
+                uint32_t offset = (field(bits, 12, 11) << 4) | (field(bits, 10, 7) << 6) | (field(bits, 6, 6) << 2) | (field(bits, 5, 5) << 3);
+                return offset != 0 ? encodeI(OPCODE_OP_IMM, 0b000, rdPrime, 2, offset) : ILLEGAL_EXPANSION; // C.ADDI4SPN
             }
-        }
-        case InstructionType::OP_FENCE: {
-            switch(instr.i.funct3) {
-                case 0b000:
-                    return Opcode::FENCE;
-                case 0b001:
-                    return Opcode::FENCE_I;
-                default:
-                    throw DecoderException("Unknown OP_FENCE instruction", instr);
+            case 0b00001:
+                return encodeI(OPCODE_LOAD_FP, 0b011, rdPrime, rs1Prime, doubleOffset);         // C.FLD
+            case 0b00010:
+                return encodeI(OPCODE_LOAD, 0b010, rdPrime, rs1Prime, wordOffset);              // C.LW
+            case 0b00011:
+                return encodeI(OPCODE_LOAD_FP, 0b010, rdPrime, rs1Prime, wordOffset);           // C.FLW
+            case 0b00101:
+                return encodeS(OPCODE_STORE_FP, 0b011, rs1Prime, rdPrime, doubleOffset);        // C.FSD
+            case 0b00110:
+                return encodeS(OPCODE_STORE, 0b010, rs1Prime, rdPrime, wordOffset);             // C.SW
+            case 0b00111:
+                return encodeS(OPCODE_STORE_FP, 0b010, rs1Prime, rdPrime, wordOffset);          // C.FSW
+            case 0b01000:
+                return encodeI(OPCODE_OP_IMM, 0b000, rd, rd, imm);                              // C.ADDI, C.NOP
+            case 0b01001:
+                return encodeJ(1, jumpOffset);                                                  // C.JAL
+            case 0b01010:
+                return encodeI(OPCODE_OP_IMM, 0b000, rd, 0, imm);                               // C.LI
+            case 0b01011: {
+                if(rd == 2) {
+                    uint32_t offset = SIGN_EXTEND((field(bits, 12, 12) << 9) | (field(bits, 6, 6) << 4) | (field(bits, 5, 5) << 6)
+                        | (field(bits, 4, 3) << 7) | (field(bits, 2, 2) << 5), 10);
+                    return offset != 0 ? encodeI(OPCODE_OP_IMM, 0b000, 2, 2, offset) : ILLEGAL_EXPANSION; // C.ADDI16SP
+                }
+                return imm != 0 ? encode(OPCODE_LUI) | (rd << 7) | (imm << 12) : ILLEGAL_EXPANSION; // C.LUI
             }
+            case 0b01100:
+                return expandArithmetic(bits);
+            case 0b01101:
+                return encodeJ(0, jumpOffset);                                                  // C.J
+            case 0b01110:
+                return encodeB(0b000, rs1Prime, branchOffset);                                  // C.BEQZ
+            case 0b01111:
+                return encodeB(0b001, rs1Prime, branchOffset);                                  // C.BNEZ
+            case 0b10000:
+                return field(bits, 12, 12) == 0 ? encodeI(OPCODE_OP_IMM, 0b001, rd, rd, rs2) : ILLEGAL_EXPANSION; // C.SLLI
+            case 0b10001:
+                return encodeI(OPCODE_LOAD_FP, 0b011, rd, 2, doubleStackLoad);                  // C.FLDSP
+            case 0b10010:
+                return rd != 0 ? encodeI(OPCODE_LOAD, 0b010, rd, 2, wordStackLoad) : ILLEGAL_EXPANSION; // C.LWSP
+            case 0b10011:
+                return encodeI(OPCODE_LOAD_FP, 0b010, rd, 2, wordStackLoad);                    // C.FLWSP
+            case 0b10100:
+                return expandJumpOrAdd(bits);
+            case 0b10101:
+                return encodeS(OPCODE_STORE_FP, 0b011, 2, rs2, doubleStackStore);               // C.FSDSP
+            case 0b10110:
+                return encodeS(OPCODE_STORE, 0b010, 2, rs2, wordStackStore);                    // C.SWSP
+            case 0b10111:
+                return encodeS(OPCODE_STORE_FP, 0b010, 2, rs2, wordStackStore);                 // C.FSWSP
+            default:
+                return ILLEGAL_EXPANSION;
+        }
+    }
+};
+
+RV32::DecodedInstruction RV32::decode(Instruction instr) {
+    Instruction expanded = instr;
+    uint8_t length = 4;
+    if(isCompressed(instr.bits)) {
+        instr.bits &= 0xFFFF;
+        expanded.bits = expandCompressed(instr.bits);
+        length = 2;
+    }
+
+    const DecodeBucket &bucket = DECODE_TABLES.buckets[getBucketIndex(expanded.bits)];
+
+    for(uint32_t i = bucket.begin; i < bucket.end; ++i) {
+        const DecodeEntry &entry = DECODE_TABLES.entries[i];
+        if((expanded.bits & entry.mask) == entry.match) {
+            DecodedInstruction decoded { entry.descriptor->opcode, entry.descriptor->type, 0, 0, 0, length, 0, instr };
+            entry.extract(expanded, decoded);
+            return decoded;
         }
     }
+
+    return DecodedInstruction { Opcode::INVALID, InstructionType::INVALID, 0, 0, 0, length, 0, instr };
+}
+
+const RV32::InstructionDescriptor& RV32::getDescriptor(Opcode opcode) {
+    const InstructionDescriptor *descriptor = DECODE_TABLES.descriptors[static_cast<size_t>(opcode)];
+    return descriptor != nullptr ? *descriptor : INVALID_DESCRIPTOR;
 }
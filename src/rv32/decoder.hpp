@@ -7,14 +7,39 @@
 namespace RV32 {
     enum class Opcode;
     enum class InstructionType;
+    enum class InstructionFormat;
 
-    Opcode decodeOpcode(Instruction instr);
-    InstructionType decodeInstructionType(Instruction instr);
+    struct InstructionDescriptor;
+    struct DecodedInstruction;
+
+    // Unknown encodings decode to InstructionType::INVALID / Opcode::INVALID. Compressed instructions
+    // decode to the instruction they expand to, only instr and length tell them apart.
+    DecodedInstruction decode(Instruction instr);
+    const InstructionDescriptor& getDescriptor(Opcode opcode);
 };
 
 enum class RV32::InstructionType {
     LOAD, STORE, BRANCH, JUMP, AMO,
-    OP_IMM, OP, SYSTEM, OP_UI, OP_FENCE
+    OP_IMM, OP, SYSTEM, OP_UI, OP_FENCE,
+    LOAD_FP, STORE_FP, OP_FP,
+    LOAD_V, STORE_V, OP_V,
+    INVALID
+};
+
+// Determines which operand fields are extracted from an instruction
+enum class RV32::InstructionFormat {
+    R,      // rd, rs1, rs2
+    I,      // rd, rs1, imm = sign extended imm[11:0]
+    SHIFT,  // rd, rs1, imm = shamt
+    S,      // rs1, rs2, imm
+    B,      // rs1, rs2, imm
+    U,      // rd, imm
+    J,      // rd, imm
+    CSR,    // rd, rs1 = source register or uimm, imm = CSR address
+    UNARY,  // rd, rs1
+    R4,     // rd, rs1, rs2, imm = rs3
+    V,      // vd, vs1/rs1, vs2, imm = sign extended simm5, vm is bit 25
+    NONE
 };
 
 enum class RV32::Opcode {
@@ -38,8 +63,92 @@ enum class RV32::Opcode {
     // A Extension //
     LR_W, SC_W, AMOSWAP_W, AMOADD_W, AMOXOR_W,
     AMOAND_W, AMOOR_W, AMOMIN_W, AMOMAX_W,
-    AMOMINU_W, AMOMAXU_W
+    AMOMINU_W, AMOMAXU_W,
+
+    // Zba Extension //
+    SH1ADD, SH2ADD, SH3ADD,
+
+    // Zbb Extension //
+    ANDN, ORN, XNOR, CLZ, CTZ, CPOP, MAX, MAXU, MIN, MINU,
+    SEXT_B, SEXT_H, ZEXT_H, ROL, ROR, RORI, ORC_B, REV8,
+
+    // Zbs Extension //
+    BCLR, BCLRI, BEXT, BEXTI, BINV, BINVI, BSET, BSETI,
+
+    // F Extension //
+    FLW, FSW, FMADD_S, FMSUB_S, FNMSUB_S, FNMADD_S,
+    FADD_S, FSUB_S, FMUL_S, FDIV_S, FSQRT_S, FSGNJ_S,
+    FSGNJN_S, FSGNJX_S, FMIN_S, FMAX_S, FCVT_W_S,
+    FCVT_WU_S, FMV_X_W, FEQ_S, FLT_S, FLE_S, FCLASS_S,
+    FCVT_S_W, FCVT_S_WU, FMV_W_X,
+
+    // D Extension //
+    FLD, FSD, FMADD_D, FMSUB_D, FNMSUB_D, FNMADD_D,
+    FADD_D, FSUB_D, FMUL_D, FDIV_D, FSQRT_D, FSGNJ_D,
+    FSGNJN_D, FSGNJX_D, FMIN_D, FMAX_D, FCVT_S_D,
+    FCVT_D_S, FEQ_D, FLT_D, FLE_D, FCLASS_D, FCVT_W_D,
+    FCVT_WU_D, FCVT_D_W, FCVT_D_WU,
+
+    // V Extension //
+    VSETVLI, VSETIVLI, VSETVL, VLE8_V, VLE16_V, VLE32_V,
+    VLE64_V, VLSE8_V, VLSE16_V, VLSE32_V, VLSE64_V, VLM_V,
+    VL1RE8_V, VL1RE16_V, VL1RE32_V, VL1RE64_V, VL2RE8_V,
+    VL2RE16_V, VL2RE32_V, VL2RE64_V, VL4RE8_V, VL4RE16_V,
+    VL4RE32_V, VL4RE64_V, VL8RE8_V, VL8RE16_V, VL8RE32_V,
+    VL8RE64_V, VSE8_V, VSE16_V, VSE32_V, VSE64_V, VSSE8_V,
+    VSSE16_V, VSSE32_V, VSSE64_V, VSM_V, VS1R_V, VS2R_V,
+    VS4R_V, VS8R_V, VADD_VV, VADD_VX, VADD_VI, VSUB_VV,
+    VSUB_VX, VRSUB_VX, VRSUB_VI, VMINU_VV, VMINU_VX,
+    VMIN_VV, VMIN_VX, VMAXU_VV, VMAXU_VX, VMAX_VV, VMAX_VX,
+    VAND_VV, VAND_VX, VAND_VI, VOR_VV, VOR_VX, VOR_VI,
+    VXOR_VV, VXOR_VX, VXOR_VI, VSLIDEUP_VX, VSLIDEUP_VI,
+    VSLIDEDOWN_VX, VSLIDEDOWN_VI, VMERGE_VVM, VMERGE_VXM,
+    VMERGE_VIM, VMV_V_V, VMV_V_X, VMV_V_I, VMSEQ_VV,
+    VMSEQ_VX, VMSEQ_VI, VMSNE_VV, VMSNE_VX, VMSNE_VI,
+    VMSLTU_VV, VMSLTU_VX, VMSLT_VV, VMSLT_VX, VMSLEU_VV,
+    VMSLEU_VX, VMSLEU_VI, VMSLE_VV, VMSLE_VX, VMSLE_VI,
+    VMSGTU_VX, VMSGTU_VI, VMSGT_VX, VMSGT_VI, VSADDU_VV,
+    VSADDU_VX, VSADDU_VI, VSADD_VV, VSADD_VX, VSADD_VI,
+    VSSUBU_VV, VSSUBU_VX, VSSUB_VV, VSSUB_VX, VSLL_VV,
+    VSLL_VX, VSLL_VI, VMV1R_V, VMV2R_V, VMV4R_V, VMV8R_V,
+    VSRL_VV, VSRL_VX, VSRL_VI, VSRA_VV, VSRA_VX, VSRA_VI,
+    VWREDSUMU_VS, VWREDSUM_VS, VREDSUM_VS, VREDAND_VS,
+    VREDOR_VS, VREDXOR_VS, VREDMINU_VS, VREDMIN_VS,
+    VREDMAXU_VS, VREDMAX_VS, VMV_X_S, VCPOP_M, VFIRST_M,
+    VMV_S_X, VZEXT_VF8, VSEXT_VF8, VZEXT_VF4, VSEXT_VF4,
+    VZEXT_VF2, VSEXT_VF2, VID_V, VMANDN_MM, VMAND_MM,
+    VMOR_MM, VMXOR_MM, VMORN_MM, VMNAND_MM, VMNOR_MM,
+    VMXNOR_MM, VDIVU_VV, VDIVU_VX, VDIV_VV, VDIV_VX,
+    VREMU_VV, VREMU_VX, VREM_VV, VREM_VX, VMULHU_VV,
+    VMULHU_VX, VMUL_VV, VMUL_VX, VMULHSU_VV, VMULHSU_VX,
+    VMULH_VV, VMULH_VX, VMADD_VV, VMADD_VX, VNMSUB_VV,
+    VNMSUB_VX, VMACC_VV, VMACC_VX, VNMSAC_VV, VNMSAC_VX,
+    VWADDU_VV, VWADDU_VX, VWADD_VV, VWADD_VX, VWSUBU_VV,
+    VWSUBU_VX, VWSUB_VV, VWSUB_VX, VWMULU_VV, VWMULU_VX,
+    VWMUL_VV, VWMUL_VX, VWMACCU_VV, VWMACCU_VX, VWMACC_VV,
+    VWMACC_VX,
+
+    INVALID
 };
 
+struct RV32::InstructionDescriptor {
+    uint32_t mask;
+    uint32_t match;
+    InstructionType type;
+    Opcode opcode;
+    InstructionFormat format;
+    const char* name;
+};
+
+struct RV32::DecodedInstruction {
+    Opcode opcode;
+    InstructionType type;
+    uint8_t rd;
+    uint8_t rs1;
+    uint8_t rs2;
+    uint8_t length;     // 2 for compressed instructions, otherwise 4
+    uint32_t imm;
+    Instruction instr;  // as fetched, the upper half of compressed instructions is zero
+};
 
 #endif /* __DECODER_HPP__ */
@@ -0,0 +1,239 @@
+#include "disassembler.hpp"
+#include "decoder.hpp"
+#include "fpu.hpp"
+#include "vector.hpp"
+#include <sstream>
+#include <iomanip>
+
+namespace {
+    using namespace RV32;
+
+    void printVectorType(std::ostream &out, uint32_t vtype) {
+        static const char* lmul[] = { "m1", "m2", "m4", "m8", "m?", "mf8", "mf4", "mf2" };
+        out << "e" << (8u << ((vtype >> 3) & 0x7)) << ", " << lmul[vtype & 0x7]
+            << ((vtype & 0x40) ? ", ta" : ", tu") << ((vtype & 0x80) ? ", ma" : ", mu");
+    }
+
+    // Operands of the V format, vd first and the mask last as in the assembler syntax
+    void printVectorOperands(std::ostream &out, const DecodedInstruction &decoded) {
+        const char *vd = getVectorRegisterName(decoded.rd);
+        const char *vs2 = getVectorRegisterName(decoded.rs2);
+        bool masked = ((decoded.instr.bits >> 25) & 1) == 0;
+
+        if(decoded.type == InstructionType::LOAD_V || decoded.type == InstructionType::STORE_V) {
+            out << " " << vd << ", (" << getRegisterName(decoded.rs1) << ")";
+            if(((decoded.instr.bits >> 26) & 0x3) == 0b10) {
+                out << ", " << getRegisterName(decoded.rs2);
+            }
+        } else {
+            // funct3 selects a vector, immediate or scalar operand
+            std::ostringstream operand;
+            switch(decoded.instr.r.funct3) {
+                case 0b000:
+                case 0b010:
+                    operand << getVectorRegisterName(decoded.rs1);
+                    break;
+                case 0b011:
+                    switch(decoded.opcode) {
+                        case Opcode::VSLL_VI:
+                        case Opcode::VSRL_VI:
+                        case Opcode::VSRA_VI:
+                        case Opcode::VSLIDEUP_VI:
+                        case Opcode::VSLIDEDOWN_VI:
+                            operand << static_cast<uint32_t>(decoded.rs1);
+                            break;
+                        default:
+                            operand << static_cast<int32_t>(decoded.imm);
+                            break;
+                    }
+                    break;
+                default:
+                    operand << getRegisterName(decoded.rs1);
+                    break;
+            }
+
+            switch(decoded.opcode) {
+                case Opcode::VMV_X_S:
+                case Opcode::VCPOP_M:
+                case Opcode::VFIRST_M:
+                    out << " " << getRegisterName(decoded.rd) << ", " << vs2;
+                    break;
+                case Opcode::VMV_S_X:
+                case Opcode::VMV_V_V:
+                case Opcode::VMV_V_X:
+                case Opcode::VMV_V_I:
+                    out << " " << vd << ", " << operand.str();
+                    break;
+                case Opcode::VMV1R_V:
+                case Opcode::VMV2R_V:
+                case Opcode::VMV4R_V:
+                case Opcode::VMV8R_V:
+                case Opcode::VZEXT_VF2:
+                case Opcode::VSEXT_VF2:
+                case Opcode::VZEXT_VF4:
+                case Opcode::VSEXT_VF4:
+                case Opcode::VZEXT_VF8:
+                case Opcode::VSEXT_VF8:
+                    out << " " << vd << ", " << vs2;
+                    break;
+                case Opcode::VID_V:
+                    out << " " << vd;
+                    break;
+                case Opcode::VMERGE_VVM:
+                case Opcode::VMERGE_VXM:
+                case Opcode::VMERGE_VIM:
+                    out << " " << vd << ", " << vs2 << ", " << operand.str() << ", v0";
+                    masked = false;
+                    break;
+                case Opcode::VMACC_VV:
+                case Opcode::VMACC_VX:
+                case Opcode::VNMSAC_VV:
+                case Opcode::VNMSAC_VX:
+                case Opcode::VMADD_VV:
+                case Opcode::VMADD_VX:
+                case Opcode::VNMSUB_VV:
+                case Opcode::VNMSUB_VX:
+                case Opcode::VWMACCU_VV:
+                case Opcode::VWMACCU_VX:
+                case Opcode::VWMACC_VV:
+                case Opcode::VWMACC_VX:
+                    out << " " << vd << ", " << operand.str() << ", " << vs2;
+                    break;
+                default:
+                    out << " " << vd << ", " << vs2 << ", " << operand.str();
+                    break;
+            }
+        }
+
+        if(masked) {
+            out << ", v0.t";
+        }
+    }
+};
+
+const char* RV32::getRegisterName(uint32_t index) {
+    static const char* names[] = {
+        "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
+        "s0", "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+        "a6", "a7", "s2", "s3", "s4", "s5", "s6", "s7",
+        "s8", "s9", "s10", "s11", "t3", "t4", "t5", "t6"
+    };
+    return names[index & 0x1F];
+}
+
+const char* RV32::getFloatRegisterName(uint32_t index) {
+    static const char* names[] = {
+        "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "ft7",
+        "fs0", "fs1", "fa0", "fa1", "fa2", "fa3", "fa4", "fa5",
+        "fa6", "fa7", "fs2", "fs3", "fs4", "fs5", "fs6", "fs7",
+        "fs8", "fs9", "fs10", "fs11", "ft8", "ft9", "ft10", "ft11"
+    };
+    return names[index & 0x1F];
+}
+
+const char* RV32::getVectorRegisterName(uint32_t index) {
+    static const char* names[] = {
+        "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7",
+        "v8", "v9", "v10", "v11", "v12", "v13", "v14", "v15",
+        "v16", "v17", "v18", "v19", "v20", "v21", "v22", "v23",
+        "v24", "v25", "v26", "v27", "v28", "v29", "v30", "v31"
+    };
+    return names[index & 0x1F];
+}
+
+const char* RV32::getOpcodeName(Opcode opcode) {
+    return getDescriptor(opcode).name;
+}
+
+std::string RV32::disassemble(Instruction instr, uint32_t pc) {
+    std::ostringstream out;
+    DecodedInstruction decoded = decode(instr);
+    const InstructionDescriptor &descriptor = getDescriptor(decoded.opcode);
+
+    if(decoded.opcode == Opcode::INVALID) {
+        if(decoded.length == 2) {
+            out << ".half 0x" << std::hex << std::setw(4) << std::setfill('0') << decoded.instr.bits;
+        } else {
+            out << ".word 0x" << std::hex << std::setw(8) << std::setfill('0') << instr.bits;
+        }
+        return out.str();
+    }
+
+    out << descriptor.name;
+
+    // F and D instructions name float registers, except for their integer operands and load/store base
+    bool isFloat = decoded.type == InstructionType::OP_FP;
+    bool floatRd = (isFloat && !writesIntegerRegister(decoded.opcode)) || decoded.type == InstructionType::LOAD_FP;
+    bool floatRs1 = isFloat && !readsIntegerRegister(decoded.opcode);
+    bool floatRs2 = isFloat || decoded.type == InstructionType::STORE_FP;
+    const char *rd = floatRd ? getFloatRegisterName(decoded.rd) : getRegisterName(decoded.rd);
+    const char *rs1 = floatRs1 ? getFloatRegisterName(decoded.rs1) : getRegisterName(decoded.rs1);
+    const char *rs2 = floatRs2 ? getFloatRegisterName(decoded.rs2) : getRegisterName(decoded.rs2);
+
+    switch(descriptor.format) {
+        case InstructionFormat::R:
+            if(decoded.type == InstructionType::AMO) {
+                out << " " << rd << ", ";
+                if(decoded.opcode != Opcode::LR_W) {
+                    out << rs2 << ", ";
+                }
+                out << "(" << rs1 << ")";
+            } else if(decoded.type == InstructionType::SYSTEM) {
+                out << " " << rs1 << ", " << rs2;
+            } else {
+                out << " " << rd << ", " << rs1 << ", " << rs2;
+            }
+            break;
+        case InstructionFormat::I:
+            if(decoded.opcode == Opcode::VSETVLI) {
+                out << " " << rd << ", " << rs1 << ", ";
+                printVectorType(out, decoded.imm);
+            } else if(decoded.opcode == Opcode::VSETIVLI) {
+                out << " " << rd << ", " << static_cast<uint32_t>(decoded.rs1) << ", ";
+                printVectorType(out, decoded.imm);
+            } else if(decoded.type == InstructionType::LOAD || decoded.type == InstructionType::LOAD_FP || decoded.opcode == Opcode::JALR) {
+                out << " " << rd << ", " << static_cast<int32_t>(decoded.imm)
+                    << "(" << rs1 << ")";
+            } else {
+                out << " " << rd << ", " << rs1 << ", " << static_cast<int32_t>(decoded.imm);
+            }
+            break;
+        case InstructionFormat::SHIFT:
+            out << " " << rd << ", " << rs1 << ", " << decoded.imm;
+            break;
+        case InstructionFormat::S:
+            out << " " << rs2 << ", " << static_cast<int32_t>(decoded.imm)
+                << "(" << rs1 << ")";
+            break;
+        case InstructionFormat::B:
+            out << " " << rs1 << ", " << rs2 << ", 0x" << std::hex << (pc + decoded.imm);
+            break;
+        case InstructionFormat::U:
+            out << " " << rd << ", 0x" << std::hex << (decoded.imm >> 12);
+            break;
+        case InstructionFormat::J:
+            out << " " << rd << ", 0x" << std::hex << (pc + decoded.imm);
+            break;
+        case InstructionFormat::CSR:
+            out << " " << rd << ", 0x" << std::hex << decoded.imm << ", ";
+            if(decoded.opcode == Opcode::CSRRWI || decoded.opcode == Opcode::CSRRSI || decoded.opcode == Opcode::CSRRCI) {
+                out << std::dec << static_cast<uint32_t>(decoded.rs1);
+            } else {
+                out << rs1;
+            }
+            break;
+        case InstructionFormat::UNARY:
+            out << " " << rd << ", " << rs1;
+            break;
+        case InstructionFormat::R4:
+            out << " " << rd << ", " << rs1 << ", " << rs2 << ", " << getFloatRegisterName(decoded.imm);
+            break;
+        case InstructionFormat::V:
+            printVectorOperands(out, decoded);
+            break;
+        case InstructionFormat::NONE:
+            break;
+    }
+
+    return out.str();
+}
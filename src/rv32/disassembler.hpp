@@ -0,0 +1,17 @@
+#ifndef __DISASSEMBLER_HPP__
+#define __DISASSEMBLER_HPP__
+
+#include <string>
+#include "instruction.hpp"
+
+namespace RV32 {
+    enum class Opcode;
+
+    const char* getOpcodeName(Opcode opcode);
+    const char* getRegisterName(uint32_t index);
+    const char* getFloatRegisterName(uint32_t index);
+    const char* getVectorRegisterName(uint32_t index);
+    std::string disassemble(Instruction instr, uint32_t pc);
+};
+
+#endif /* __DISASSEMBLER_HPP__ */
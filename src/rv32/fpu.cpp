@@ -0,0 +1,394 @@
+#include "fpu.hpp"
+#include <cfenv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using RV32::Opcode;
+using RV32::RoundingMode;
+using RV32::FPResult;
+
+namespace {
+    using namespace RV32;
+
+    constexpr uint32_t FUNCT3_MASK = 0x00007000;
+
+    template<typename T>
+    struct FloatTraits;
+
+    // Wide holds every midpoint between two neighbouring values exactly, which finds the ties of RMM
+    template<>
+    struct FloatTraits<float> {
+        using Bits = uint32_t;
+        using Wide = double;
+        static constexpr Bits SIGN = 0x80000000;
+        static constexpr Bits QUIET = 0x00400000;
+        static constexpr Bits CANONICAL_NAN = 0x7FC00000;
+    };
+
+    template<>
+    struct FloatTraits<double> {
+        using Bits = uint64_t;
+        using Wide = long double;
+        static constexpr Bits SIGN = 0x8000000000000000;
+        static constexpr Bits QUIET = 0x0008000000000000;
+        static constexpr Bits CANONICAL_NAN = 0x7FF8000000000000;
+    };
+
+    static_assert(std::numeric_limits<long double>::digits > std::numeric_limits<double>::digits,
+                  "RMM rounding of double precision needs a wider long double");
+
+    template<typename T>
+    typename FloatTraits<T>::Bits toBits(T value) {
+        typename FloatTraits<T>::Bits bits;
+        std::memcpy(&bits, &value, sizeof(T));
+        return bits;
+    }
+
+    template<typename T>
+    uint64_t boxBits(typename FloatTraits<T>::Bits bits) {
+        if constexpr(sizeof(T) == sizeof(float)) {
+            return NAN_BOX | bits;
+        } else {
+            return bits;
+        }
+    }
+
+    // NaN results are always the canonical NaN, payloads are not propagated
+    template<typename T>
+    uint64_t box(T value) {
+        if(std::isnan(value)) {
+            return boxBits<T>(FloatTraits<T>::CANONICAL_NAN);
+        }
+        return boxBits<T>(toBits(value));
+    }
+
+    // A single precision operand that is not properly NaN-boxed reads as the canonical NaN
+    template<typename T>
+    T unbox(uint64_t reg) {
+        typename FloatTraits<T>::Bits bits = reg;
+        if constexpr(sizeof(T) == sizeof(float)) {
+            if((reg & NAN_BOX) != NAN_BOX) {
+                bits = FloatTraits<T>::CANONICAL_NAN;
+            }
+        }
+
+        T value;
+        std::memcpy(&value, &bits, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    bool isSignalingNaN(T value) {
+        return std::isnan(value) && (toBits(value) & FloatTraits<T>::QUIET) == 0;
+    }
+
+    // RMM runs as round to nearest even and is fixed up afterwards
+    int getHostRoundingMode(uint32_t rm) {
+        switch(static_cast<RoundingMode>(rm)) {
+            case RoundingMode::RTZ:
+                return FE_TOWARDZERO;
+            case RoundingMode::RDN:
+                return FE_DOWNWARD;
+            case RoundingMode::RUP:
+                return FE_UPWARD;
+            default:
+                return FE_TONEAREST;
+        }
+    }
+
+    uint32_t getHostFlags() {
+        int raised = std::fetestexcept(FE_ALL_EXCEPT);
+        uint32_t flags = 0;
+        flags |= (raised & FE_INEXACT) ? FFLAG_NX : 0;
+        flags |= (raised & FE_UNDERFLOW) ? FFLAG_UF : 0;
+        flags |= (raised & FE_OVERFLOW) ? FFLAG_OF : 0;
+        flags |= (raised & FE_DIVBYZERO) ? FFLAG_DZ : 0;
+        flags |= (raised & FE_INVALID) ? FFLAG_NV : 0;
+        return flags;
+    }
+
+    // The host has no ties to max magnitude mode, and round to nearest even only differs from it on an exact tie.
+    // op is repeated in the wide format, where a tie is an exact result halfway between nearest and its neighbour.
+    template<typename R, typename A, typename Op>
+    R roundTiesToMaxMagnitude(R nearest, A a, A b, A c, Op op) {
+        using Wide = typename FloatTraits<R>::Wide;
+        if(!std::isfinite(nearest)) {
+            return nearest;
+        }
+
+        volatile Wide va = a;
+        volatile Wide vb = b;
+        volatile Wide vc = c;
+        std::feclearexcept(FE_ALL_EXCEPT);
+        volatile Wide exact = op(va, vb, vc);
+        if(std::fetestexcept(FE_INEXACT) || exact == nearest) {
+            return nearest;
+        }
+
+        R neighbour = std::nextafter(nearest, exact > nearest ? std::numeric_limits<R>::infinity() : -std::numeric_limits<R>::infinity());
+        Wide midpoint = (static_cast<Wide>(nearest) + static_cast<Wide>(neighbour)) / 2;
+        if(exact != midpoint || std::fabs(neighbour) < std::fabs(nearest)) {
+            return nearest;
+        }
+        return neighbour;
+    }
+
+    // Runs op on the host FPU in the guest rounding mode and collects the exceptions it raises. The operands
+    // and result go through volatile copies, so the compiler cannot move the operation across the fenv calls.
+    // The host stays in round to nearest between instructions, which is the common case and needs no switch.
+    // op takes the operands in their own type and the result is rounded to R when it is stored.
+    template<typename R, typename A, typename Op>
+    R computeRounded(uint32_t rm, uint32_t &flags, A a, A b, A c, Op op) {
+        volatile A va = a;
+        volatile A vb = b;
+        volatile A vc = c;
+        bool switchMode = rm != static_cast<uint32_t>(RoundingMode::RNE) && rm != static_cast<uint32_t>(RoundingMode::RMM);
+
+        std::feclearexcept(FE_ALL_EXCEPT);
+        if(switchMode) {
+            std::fesetround(getHostRoundingMode(rm));
+        }
+
+        volatile R result = op(va, vb, vc);
+        flags |= getHostFlags();
+
+        if(switchMode) {
+            std::fesetround(FE_TONEAREST);
+        }
+        if(rm == static_cast<uint32_t>(RoundingMode::RMM)) {
+            return roundTiesToMaxMagnitude<R>(result, a, b, c, op);
+        }
+        return result;
+    }
+
+    double roundToIntegral(double value, uint32_t rm) {
+        switch(static_cast<RoundingMode>(rm)) {
+            case RoundingMode::RTZ:
+                return std::trunc(value);
+            case RoundingMode::RDN:
+                return std::floor(value);
+            case RoundingMode::RUP:
+                return std::ceil(value);
+            case RoundingMode::RMM:
+                return std::round(value);
+            default:
+                return std::nearbyint(value);
+        }
+    }
+
+    // Out of range values and NaNs saturate and raise the invalid flag
+    template<typename I>
+    uint32_t convertToInteger(double value, uint32_t rm, uint32_t &flags) {
+        constexpr double MIN = std::numeric_limits<I>::min();
+        constexpr double MAX = std::numeric_limits<I>::max();
+
+        if(std::isnan(value)) {
+            flags |= FFLAG_NV;
+            return std::numeric_limits<I>::max();
+        }
+
+        double rounded = roundToIntegral(value, rm);
+        if(rounded < MIN) {
+            flags |= FFLAG_NV;
+            return std::numeric_limits<I>::min();
+        }
+        if(rounded > MAX) {
+            flags |= FFLAG_NV;
+            return std::numeric_limits<I>::max();
+        }
+
+        if(rounded != value) {
+            flags |= FFLAG_NX;
+        }
+        return static_cast<I>(rounded);
+    }
+
+    template<typename T>
+    uint32_t classify(T value) {
+        bool negative = std::signbit(value);
+        switch(std::fpclassify(value)) {
+            case FP_INFINITE:
+                return negative ? 1 << 0 : 1 << 7;
+            case FP_NORMAL:
+                return negative ? 1 << 1 : 1 << 6;
+            case FP_SUBNORMAL:
+                return negative ? 1 << 2 : 1 << 5;
+            case FP_ZERO:
+                return negative ? 1 << 3 : 1 << 4;
+            default:
+                return isSignalingNaN(value) ? 1 << 8 : 1 << 9;
+        }
+    }
+
+    // -0 is smaller than +0, and a NaN operand is ignored unless both are NaNs
+    template<typename T>
+    uint64_t minMax(T a, T b, bool isMax, uint32_t &flags) {
+        if(isSignalingNaN(a) || isSignalingNaN(b)) {
+            flags |= FFLAG_NV;
+        }
+
+        if(std::isnan(a) && std::isnan(b)) {
+            return boxBits<T>(FloatTraits<T>::CANONICAL_NAN);
+        } else if(std::isnan(a)) {
+            return box(b);
+        } else if(std::isnan(b)) {
+            return box(a);
+        } else if(a == b) {
+            return box(std::signbit(a) == isMax ? b : a);
+        }
+        return box((a < b) != isMax ? a : b);
+    }
+
+    template<typename T>
+    uint64_t fusedMultiplyAdd(uint32_t rm, uint32_t &flags, T a, T b, T c) {
+        // Invalid even when the addend is a quiet NaN
+        if((std::isinf(a) && b == 0) || (a == 0 && std::isinf(b))) {
+            flags |= FFLAG_NV;
+        }
+        return box(computeRounded<T>(rm, flags, a, b, c, [](auto x, auto y, auto z) { return std::fma(x, y, z); }));
+    }
+
+    // Operations shared by the single and double precision instructions
+    template<typename T>
+    uint64_t execute(Opcode opcode, uint32_t rm, uint64_t rs1, uint64_t rs2, uint64_t rs3, uint32_t &flags) {
+        using Bits = typename FloatTraits<T>::Bits;
+        constexpr Bits SIGN = FloatTraits<T>::SIGN;
+
+        T a = unbox<T>(rs1);
+        T b = unbox<T>(rs2);
+        T c = unbox<T>(rs3);
+
+        switch(opcode) {
+            case Opcode::FMADD_S:
+            case Opcode::FMADD_D:
+                return fusedMultiplyAdd(rm, flags, a, b, c);
+            case Opcode::FMSUB_S:
+            case Opcode::FMSUB_D:
+                return fusedMultiplyAdd(rm, flags, a, b, -c);
+            case Opcode::FNMSUB_S:
+            case Opcode::FNMSUB_D:
+                return fusedMultiplyAdd(rm, flags, -a, b, c);
+            case Opcode::FNMADD_S:
+            case Opcode::FNMADD_D:
+                return fusedMultiplyAdd(rm, flags, -a, b, -c);
+            case Opcode::FADD_S:
+            case Opcode::FADD_D:
+                return box(computeRounded<T>(rm, flags, a, b, c, [](auto x, auto y, auto) { return x + y; }));
+            case Opcode::FSUB_S:
+            case Opcode::FSUB_D:
+                return box(computeRounded<T>(rm, flags, a, b, c, [](auto x, auto y, auto) { return x - y; }));
+            case Opcode::FMUL_S:
+            case Opcode::FMUL_D:
+                return box(computeRounded<T>(rm, flags, a, b, c, [](auto x, auto y, auto) { return x * y; }));
+            case Opcode::FDIV_S:
+            case Opcode::FDIV_D:
+                return box(computeRounded<T>(rm, flags, a, b, c, [](auto x, auto y, auto) { return x / y; }));
+            case Opcode::FSQRT_S:
+            case Opcode::FSQRT_D:
+                return box(computeRounded<T>(rm, flags, a, b, c, [](auto x, auto, auto) { return std::sqrt(x); }));
+            case Opcode::FSGNJ_S:
+            case Opcode::FSGNJ_D:
+                return boxBits<T>((toBits(a) & ~SIGN) | (toBits(b) & SIGN));
+            case Opcode::FSGNJN_S:
+            case Opcode::FSGNJN_D:
+                return boxBits<T>((toBits(a) & ~SIGN) | (~toBits(b) & SIGN));
+            case Opcode::FSGNJX_S:
+            case Opcode::FSGNJX_D:
+                return boxBits<T>(toBits(a) ^ (toBits(b) & SIGN));
+            case Opcode::FMIN_S:
+            case Opcode::FMIN_D:
+                return minMax(a, b, false, flags);
+            case Opcode::FMAX_S:
+            case Opcode::FMAX_D:
+                return minMax(a, b, true, flags);
+            case Opcode::FEQ_S:
+            case Opcode::FEQ_D:
+                if(isSignalingNaN(a) || isSignalingNaN(b)) {
+                    flags |= FFLAG_NV;
+                }
+                return a == b;
+            case Opcode::FLT_S:
+            case Opcode::FLT_D:
+                if(std::isnan(a) || std::isnan(b)) {
+                    flags |= FFLAG_NV;
+                }
+                return std::isless(a, b);
+            case Opcode::FLE_S:
+            case Opcode::FLE_D:
+                if(std::isnan(a) || std::isnan(b)) {
+                    flags |= FFLAG_NV;
+                }
+                return std::islessequal(a, b);
+            case Opcode::FCLASS_S:
+            case Opcode::FCLASS_D:
+                return classify(a);
+            case Opcode::FCVT_W_S:
+            case Opcode::FCVT_W_D:
+                return convertToInteger<int32_t>(a, rm, flags);
+            case Opcode::FCVT_WU_S:
+            case Opcode::FCVT_WU_D:
+                return convertToInteger<uint32_t>(a, rm, flags);
+            case Opcode::FCVT_S_W:
+            case Opcode::FCVT_D_W: {
+                int32_t value = static_cast<int32_t>(rs1);
+                return box(computeRounded<T>(rm, flags, value, 0, 0, [](auto x, auto, auto) { return x; }));
+            }
+            case Opcode::FCVT_S_WU:
+            case Opcode::FCVT_D_WU: {
+                uint32_t value = static_cast<uint32_t>(rs1);
+                return box(computeRounded<T>(rm, flags, value, 0u, 0u, [](auto x, auto, auto) { return x; }));
+            }
+            case Opcode::FMV_X_W:
+                return rs1 & 0xFFFFFFFF;
+            case Opcode::FMV_W_X:
+                return NAN_BOX | (rs1 & 0xFFFFFFFF);
+            default:
+                return 0;
+        }
+    }
+};
+
+bool RV32::executeFloatingPoint(const DecodedInstruction &decoded, uint32_t frm, uint64_t rs1, uint64_t rs2, uint64_t rs3, FPResult &result) {
+    uint32_t rm = decoded.instr.r.funct3;
+
+    // Instructions that select the operation with funct3 have no rounding mode
+    if((getDescriptor(decoded.opcode).mask & FUNCT3_MASK) == 0) {
+        if(rm == static_cast<uint32_t>(RoundingMode::DYN)) {
+            rm = frm;
+        }
+        if(rm > static_cast<uint32_t>(RoundingMode::RMM)) {
+            return false;
+        }
+    }
+
+    result.flags = 0;
+
+    switch(decoded.opcode) {
+        case Opcode::FCVT_S_D: {
+            double value = unbox<double>(rs1);
+            result.value = box(computeRounded<float>(rm, result.flags, value, 0.0, 0.0, [](auto x, auto, auto) { return x; }));
+            break;
+        }
+        case Opcode::FCVT_D_S: {
+            float value = unbox<float>(rs1);
+            if(isSignalingNaN(value)) {
+                result.flags |= FFLAG_NV;
+            }
+            result.value = box(static_cast<double>(value));
+            break;
+        }
+        default: {
+            // fmt in the low bits of funct7 selects the precision
+            bool isDouble = (decoded.instr.bits >> 25) & 1;
+            if(isDouble) {
+                result.value = execute<double>(decoded.opcode, rm, rs1, rs2, rs3, result.flags);
+            } else {
+                result.value = execute<float>(decoded.opcode, rm, rs1, rs2, rs3, result.flags);
+            }
+            break;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,85 @@
+#ifndef __FPU_HPP__
+#define __FPU_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include "decoder.hpp"
+
+namespace RV32 {
+    constexpr uint64_t NAN_BOX = 0xFFFFFFFF00000000;
+
+    // Single precision values are NaN-boxed in the upper 32 bits
+    struct FloatRegisters {
+        static constexpr size_t NUM_FPR = 32;
+
+        uint64_t f[NUM_FPR];
+
+        void reset() {
+            for(auto& reg : f) {
+                reg = 0;
+            }
+        }
+    };
+
+    // Accrued exception flags, as in fflags
+    constexpr uint32_t FFLAG_NX = 1 << 0; // inexact
+    constexpr uint32_t FFLAG_UF = 1 << 1; // underflow
+    constexpr uint32_t FFLAG_OF = 1 << 2; // overflow
+    constexpr uint32_t FFLAG_DZ = 1 << 3; // divide by zero
+    constexpr uint32_t FFLAG_NV = 1 << 4; // invalid operation
+
+    enum class RoundingMode: uint32_t {
+        RNE = 0,    // to nearest, ties to even
+        RTZ = 1,    // towards zero
+        RDN = 2,    // down
+        RUP = 3,    // up
+        RMM = 4,    // to nearest, ties to max magnitude
+        DYN = 7     // use frm
+    };
+
+    struct FPResult {
+        uint64_t value;
+        uint32_t flags;
+    };
+
+    // F and D instructions whose source or destination is an integer register instead of a float register
+    constexpr bool readsIntegerRegister(Opcode opcode) {
+        switch(opcode) {
+            case Opcode::FCVT_S_W:
+            case Opcode::FCVT_S_WU:
+            case Opcode::FMV_W_X:
+            case Opcode::FCVT_D_W:
+            case Opcode::FCVT_D_WU:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    constexpr bool writesIntegerRegister(Opcode opcode) {
+        switch(opcode) {
+            case Opcode::FCVT_W_S:
+            case Opcode::FCVT_WU_S:
+            case Opcode::FMV_X_W:
+            case Opcode::FEQ_S:
+            case Opcode::FLT_S:
+            case Opcode::FLE_S:
+            case Opcode::FCLASS_S:
+            case Opcode::FEQ_D:
+            case Opcode::FLT_D:
+            case Opcode::FLE_D:
+            case Opcode::FCLASS_D:
+            case Opcode::FCVT_W_D:
+            case Opcode::FCVT_WU_D:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Executes an OP_FP instruction on the host FPU. rs1 holds the integer register for instructions that read one,
+    // and the result goes to x[rd] if writesIntegerRegister. Returns false for a reserved rounding mode.
+    bool executeFloatingPoint(const DecodedInstruction &decoded, uint32_t frm, uint64_t rs1, uint64_t rs2, uint64_t rs3, FPResult &result);
+};
+
+#endif /* __FPU_HPP__ */
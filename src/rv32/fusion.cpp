@@ -0,0 +1,78 @@
+#include "fusion.hpp"
+
+bool RV32::isFusionHead(Opcode opcode) {
+    switch(opcode) {
+        case Opcode::LUI:
+        case Opcode::AUIPC:
+        case Opcode::SLLI:
+        case Opcode::SLT:
+        case Opcode::SLTU:
+        case Opcode::SLTI:
+        case Opcode::SLTIU:
+            return true;
+        default:
+            return false;
+    }
+}
+
+RV32::FusionKind RV32::detectFusion(const DecodedInstruction &first, const DecodedInstruction &second) {
+    // Writes to x0 are discarded, so the second instruction would not see the first's result
+    if(first.rd == 0) {
+        return FusionKind::NONE;
+    }
+
+    bool chained = second.rs1 == first.rd && second.rd == first.rd;
+
+    switch(first.opcode) {
+        case Opcode::LUI:
+            if(second.opcode == Opcode::ADDI && chained) {
+                return FusionKind::LUI_ADDI;
+            }
+            break;
+        case Opcode::AUIPC:
+            if(second.opcode == Opcode::ADDI && chained) {
+                return FusionKind::AUIPC_ADDI;
+            }
+            if(second.opcode == Opcode::JALR && second.rs1 == first.rd) {
+                return FusionKind::AUIPC_JALR;
+            }
+            break;
+        case Opcode::SLLI:
+            if(second.opcode == Opcode::SRLI && chained) {
+                return FusionKind::SLLI_SRLI;
+            }
+            break;
+        case Opcode::SLT:
+        case Opcode::SLTU:
+        case Opcode::SLTI:
+        case Opcode::SLTIU:
+            if((second.opcode == Opcode::BEQ || second.opcode == Opcode::BNE) &&
+               ((second.rs1 == first.rd && second.rs2 == 0) || (second.rs2 == first.rd && second.rs1 == 0))) {
+                return FusionKind::COMPARE_BRANCH;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return FusionKind::NONE;
+}
+
+const char* RV32::getFusionName(FusionKind kind) {
+    switch(kind) {
+        case FusionKind::LUI_ADDI:
+            return "lui+addi";
+        case FusionKind::AUIPC_ADDI:
+            return "auipc+addi";
+        case FusionKind::AUIPC_JALR:
+            return "auipc+jalr";
+        case FusionKind::SLLI_SRLI:
+            return "slli+srli";
+        case FusionKind::COMPARE_BRANCH:
+            return "compare+branch";
+        case FusionKind::NONE:
+        case FusionKind::COUNT:
+            break;
+    }
+    return "none";
+}
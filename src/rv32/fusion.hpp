@@ -0,0 +1,30 @@
+#ifndef __FUSION_HPP__
+#define __FUSION_HPP__
+
+#include <cstdint>
+#include <cstddef>
+#include "decoder.hpp"
+
+namespace RV32 {
+    // Instruction pairs the hart can execute as a single operation
+    enum class FusionKind: uint32_t {
+        NONE,
+        LUI_ADDI,           // lui rd, hi; addi rd, rd, lo
+        AUIPC_ADDI,         // auipc rd, hi; addi rd, rd, lo
+        AUIPC_JALR,         // auipc rd, hi; jalr rd2, lo(rd)
+        SLLI_SRLI,          // slli rd, rs, n; srli rd, rd, m
+        COMPARE_BRANCH,     // slt[i][u] rd, ...; beqz/bnez rd, target
+        COUNT
+    };
+
+    struct FusionStats {
+        uint64_t counts[static_cast<size_t>(FusionKind::COUNT)] = {};
+    };
+
+    // Returns true if the instruction can begin a fused pair
+    bool isFusionHead(Opcode opcode);
+    FusionKind detectFusion(const DecodedInstruction &first, const DecodedInstruction &second);
+    const char* getFusionName(FusionKind kind);
+};
+
+#endif /* __FUSION_HPP__ */
@@ -0,0 +1,716 @@
+#include "gdb_stub.hpp"
+#include "disassembler.hpp"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using RV32::GDBStub;
+
+namespace {
+    // GDB numbers the registers x0 to x31, pc, f0 to f31 and then the CSRs by address
+    constexpr uint32_t PC_REGISTER = 32;
+    constexpr uint32_t FIRST_FLOAT_REGISTER = 33;
+    constexpr uint32_t FIRST_CSR_REGISTER = 65;
+    constexpr uint32_t PRIV_REGISTER = FIRST_CSR_REGISTER + RV32::NUM_CSRS;
+
+    constexpr uint32_t EBREAK = 0x00100073;
+    constexpr uint16_t C_EBREAK = 0x9002;
+
+    // Signals in stop replies
+    constexpr uint32_t SIGNAL_INT = 2;
+    constexpr uint32_t SIGNAL_TRAP = 5;
+
+    struct NamedCSR {
+        const char *name;
+        RV32::CSRAddress addr;
+    };
+
+    // Shown by info registers, the floating-point CSRs belong to the fpu feature
+    constexpr NamedCSR SUPERVISOR_CSRS[] = {
+        {"sstatus", RV32::CSRAddress::SSTATUS},
+        {"sie", RV32::CSRAddress::SIE},
+        {"stvec", RV32::CSRAddress::STVEC},
+        {"scounteren", RV32::CSRAddress::SCOUNTEREN},
+        {"sscratch", RV32::CSRAddress::SSCRATCH},
+        {"sepc", RV32::CSRAddress::SEPC},
+        {"scause", RV32::CSRAddress::SCAUSE},
+        {"stval", RV32::CSRAddress::STVAL},
+        {"sip", RV32::CSRAddress::SIP},
+        {"satp", RV32::CSRAddress::SATP},
+        {"cycle", RV32::CSRAddress::CYCLE},
+        {"time", RV32::CSRAddress::TIME},
+        {"instret", RV32::CSRAddress::INSTRET},
+        {"cycleh", RV32::CSRAddress::CYCLEH},
+        {"timeh", RV32::CSRAddress::TIMEH},
+        {"instreth", RV32::CSRAddress::INSTRETH},
+    };
+
+    void appendRegister(std::ostream &out, const char *name, uint32_t bitSize, const char *type, uint32_t number) {
+        out << "<reg name=\"" << name << "\" bitsize=\"" << bitSize << "\" type=\"" << type << "\" regnum=\"" << number << "\"/>";
+    }
+
+    std::string buildTargetDescription() {
+        std::ostringstream out;
+        out << "<?xml version=\"1.0\"?><!DOCTYPE target SYSTEM \"gdb-target.dtd\"><target version=\"1.0\">"
+            << "<architecture>riscv:rv32</architecture><feature name=\"org.gnu.gdb.riscv.cpu\">";
+        for(uint32_t i = 0; i < 32; ++i) {
+            bool isPointer = i >= 1 && i <= 4;
+            appendRegister(out, RV32::getRegisterName(i), 32, i == 1 ? "code_ptr" : isPointer ? "data_ptr" : "int", i);
+        }
+        appendRegister(out, "pc", 32, "code_ptr", PC_REGISTER);
+
+        out << "</feature><feature name=\"org.gnu.gdb.riscv.fpu\">";
+        for(uint32_t i = 0; i < 32; ++i) {
+            appendRegister(out, RV32::getFloatRegisterName(i), 64, "ieee_double", FIRST_FLOAT_REGISTER + i);
+        }
+        appendRegister(out, "fflags", 32, "int", FIRST_CSR_REGISTER + static_cast<uint32_t>(RV32::CSRAddress::FFLAGS));
+        appendRegister(out, "frm", 32, "int", FIRST_CSR_REGISTER + static_cast<uint32_t>(RV32::CSRAddress::FRM));
+        appendRegister(out, "fcsr", 32, "int", FIRST_CSR_REGISTER + static_cast<uint32_t>(RV32::CSRAddress::FCSR));
+
+        out << "</feature><feature name=\"org.gnu.gdb.riscv.csr\">";
+        for(const NamedCSR &csr : SUPERVISOR_CSRS) {
+            appendRegister(out, csr.name, 32, "int", FIRST_CSR_REGISTER + static_cast<uint32_t>(csr.addr));
+        }
+
+        out << "</feature><feature name=\"org.gnu.gdb.riscv.virtual\">";
+        appendRegister(out, "priv", 32, "int", PRIV_REGISTER);
+        out << "</feature></target>";
+        return out.str();
+    }
+
+    // Registers and memory are sent as little endian hex bytes
+    void appendHex(std::string &out, uint64_t value, uint32_t bytes) {
+        static const char digits[] = "0123456789abcdef";
+        for(uint32_t i = 0; i < bytes; ++i) {
+            uint8_t byte = value >> (8 * i);
+            out += digits[byte >> 4];
+            out += digits[byte & 0xF];
+        }
+    }
+
+    int getHexDigit(char c) {
+        if(c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if(c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        if(c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        }
+        return -1;
+    }
+
+    bool parseHexBytes(const std::string &hex, size_t offset, uint32_t bytes, uint64_t &value) {
+        if(offset + 2 * bytes > hex.size()) {
+            return false;
+        }
+
+        value = 0;
+        for(uint32_t i = 0; i < bytes; ++i) {
+            int high = getHexDigit(hex[offset + 2 * i]);
+            int low = getHexDigit(hex[offset + 2 * i + 1]);
+            if(high < 0 || low < 0) {
+                return false;
+            }
+            value |= static_cast<uint64_t>((high << 4) | low) << (8 * i);
+        }
+        return true;
+    }
+
+    // Parses a big endian hex number such as an address, up to the end or the first separator
+    bool parseNumber(const std::string &text, size_t &pos, uint32_t &value) {
+        size_t start = pos;
+        value = 0;
+        while(pos < text.size() && getHexDigit(text[pos]) >= 0) {
+            value = (value << 4) | getHexDigit(text[pos++]);
+        }
+        return pos > start;
+    }
+
+    bool expect(const std::string &text, size_t &pos, char c) {
+        if(pos < text.size() && text[pos] == c) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+}
+
+GDBStub::GDBStub(Hart &hart): hart(hart) {
+}
+
+GDBStub::~GDBStub() {
+    if(connection >= 0) {
+        detach();
+    }
+    close();
+}
+
+bool GDBStub::open(const std::string &address) {
+    bool isPort = !address.empty() && std::all_of(address.begin(), address.end(), [](char c) { return c >= '0' && c <= '9'; });
+
+    int listener;
+    if(isPort) {
+        uint32_t port = address.size() <= 5 ? std::stoul(address) : 0;
+        if(port == 0 || port > 0xFFFF) {
+            return false;
+        }
+
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        if(listener < 0) {
+            return false;
+        }
+
+        int reuse = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if(bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            ::close(listener);
+            return false;
+        }
+    } else {
+        sockaddr_un addr {};
+        if(address.size() >= sizeof(addr.sun_path)) {
+            return false;
+        }
+
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if(listener < 0) {
+            return false;
+        }
+
+        addr.sun_family = AF_UNIX;
+        std::strcpy(addr.sun_path, address.c_str());
+        if(bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            ::close(listener);
+            return false;
+        }
+        socketPath = address;
+    }
+
+    // Only one debugger is served, so stop listening once it connected
+    if(listen(listener, 1) < 0) {
+        ::close(listener);
+        return false;
+    }
+    connection = accept(listener, nullptr, nullptr);
+    ::close(listener);
+    if(connection < 0) {
+        return false;
+    }
+
+    if(isPort) {
+        int noDelay = 1;
+        setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    }
+    return true;
+}
+
+void GDBStub::close() {
+    if(connection >= 0) {
+        ::close(connection);
+        connection = -1;
+    }
+    if(!socketPath.empty()) {
+        unlink(socketPath.c_str());
+        socketPath.clear();
+    }
+}
+
+void GDBStub::detach() {
+    for(const Breakpoint &breakpoint : breakpoints) {
+        patchBreakpoint(breakpoint, false);
+    }
+    breakpoints.clear();
+    watchpoints.clear();
+    hart.setDebugger(nullptr);
+    close();
+}
+
+GDBStub::Result GDBStub::serve(const bool &running) {
+    hart.setDebugger(this);
+
+    std::string packet;
+    while(receivePacket(packet)) {
+        char command = packet.empty() ? 0 : packet[0];
+
+        if(command == 'c' || command == 's') {
+            // Continuing or stepping from a different address
+            size_t pos = 1;
+            uint32_t addr;
+            if(parseNumber(packet, pos, addr)) {
+                hart.setPC(addr);
+            }
+
+            resume(command == 's', running);
+            if(!running) {
+                sendPacket("W00");
+                detach();
+                return Result::FINISHED;
+            }
+            sendPacket(getStopReply());
+        } else if(command == 'D') {
+            sendPacket("OK");
+            detach();
+            return Result::DETACHED;
+        } else if(command == 'k') {
+            detach();
+            return Result::KILLED;
+        } else {
+            sendPacket(handlePacket(packet));
+            if(packet == "QStartNoAckMode") {
+                noAck = true;
+            }
+        }
+    }
+
+    // The connection was lost
+    detach();
+    return Result::DETACHED;
+}
+
+void GDBStub::resume(bool step, const bool &running) {
+    stopReason = StopReason::NONE;
+
+    // The instruction under a breakpoint at the pc is executed with its original bits
+    auto breakpoint = findBreakpoint(hart.getPC());
+    if(breakpoint != breakpoints.end()) {
+        patchBreakpoint(*breakpoint, false);
+        hart.stepInstruction();
+        patchBreakpoint(*breakpoint, true);
+    } else {
+        hart.stepInstruction();
+    }
+
+    if(step) {
+        if(stopReason == StopReason::NONE) {
+            stopReason = StopReason::STEP;
+        }
+        return;
+    }
+
+    uint32_t untilPoll = POLL_INTERVAL;
+    while(stopReason == StopReason::NONE && running) {
+        if(--untilPoll == 0) {
+            untilPoll = POLL_INTERVAL;
+            if(interruptRequested()) {
+                stopReason = StopReason::INTERRUPT;
+                break;
+            }
+        }
+        hart.stepInstruction();
+    }
+}
+
+std::string GDBStub::getStopReply() const {
+    std::ostringstream reply;
+    reply << std::hex << std::setfill('0');
+    switch(stopReason) {
+        case StopReason::INTERRUPT:
+            reply << "S" << std::setw(2) << SIGNAL_INT;
+            break;
+        case StopReason::BREAKPOINT:
+            reply << "T" << std::setw(2) << SIGNAL_TRAP << (reportSwbreak ? "swbreak:;" : "");
+            break;
+        case StopReason::WATCHPOINT: {
+            const char *name = stopWatchpoint.kind == WatchKind::WRITE ? "watch" : stopWatchpoint.kind == WatchKind::READ ? "rwatch" : "awatch";
+            reply << "T" << std::setw(2) << SIGNAL_TRAP << name << ":" << stopWatchpoint.addr << ";";
+            break;
+        }
+        default:
+            reply << "S" << std::setw(2) << SIGNAL_TRAP;
+            break;
+    }
+    return reply.str();
+}
+
+std::string GDBStub::handlePacket(const std::string &packet) {
+    if(packet.empty()) {
+        return "";
+    }
+
+    size_t pos = 1;
+    switch(packet[0]) {
+        case '?':
+            return getStopReply();
+        case 'q':
+        case 'Q':
+            return handleQuery(packet);
+        case 'H':
+        case 'T':
+            return "OK"; // there is a single thread
+        case 'g': {
+            std::string reply;
+            for(uint32_t i = 0; i <= PC_REGISTER; ++i) {
+                readRegister(i, reply);
+            }
+            return reply;
+        }
+        case 'G': {
+            for(uint32_t i = 0; i <= PC_REGISTER && pos + 8 <= packet.size(); ++i, pos += 8) {
+                writeRegister(i, packet.substr(pos, 8));
+            }
+            return "OK";
+        }
+        case 'p': {
+            uint32_t index;
+            std::string reply;
+            if(!parseNumber(packet, pos, index) || !readRegister(index, reply)) {
+                return "E01";
+            }
+            return reply;
+        }
+        case 'P': {
+            uint32_t index;
+            if(!parseNumber(packet, pos, index) || !expect(packet, pos, '=') || !writeRegister(index, packet.substr(pos))) {
+                return "E01";
+            }
+            return "OK";
+        }
+        case 'm': {
+            uint32_t addr, length;
+            if(!parseNumber(packet, pos, addr) || !expect(packet, pos, ',') || !parseNumber(packet, pos, length)) {
+                return "E01";
+            }
+
+            // A partial read is answered with the bytes up to the first unmapped one
+            std::string reply;
+            for(uint32_t i = 0; i < std::min(length, PACKET_SIZE / 2); ++i) {
+                uint8_t value;
+                if(!readMemory(addr + i, value)) {
+                    break;
+                }
+                appendHex(reply, value, 1);
+            }
+            return reply.empty() ? "E14" : reply;
+        }
+        case 'M': {
+            uint32_t addr, length;
+            if(!parseNumber(packet, pos, addr) || !expect(packet, pos, ',') || !parseNumber(packet, pos, length) || !expect(packet, pos, ':')) {
+                return "E01";
+            }
+            for(uint32_t i = 0; i < length; ++i) {
+                uint64_t value;
+                if(!parseHexBytes(packet, pos + 2 * i, 1, value) || !writeMemory(addr + i, value)) {
+                    return "E14";
+                }
+            }
+            return "OK";
+        }
+        case 'Z':
+        case 'z': {
+            uint32_t type, addr, kind;
+            if(!parseNumber(packet, pos, type) || !expect(packet, pos, ',') || !parseNumber(packet, pos, addr)
+               || !expect(packet, pos, ',') || !parseNumber(packet, pos, kind)) {
+                return "E01";
+            }
+            return setBreakpoint(type, addr, kind, packet[0] == 'Z');
+        }
+        default:
+            return "";
+    }
+}
+
+std::string GDBStub::handleQuery(const std::string &packet) {
+    if(packet.rfind("qSupported", 0) == 0) {
+        reportSwbreak = packet.find("swbreak+") != std::string::npos;
+
+        std::ostringstream reply;
+        reply << "PacketSize=" << std::hex << PACKET_SIZE << ";qXfer:features:read+;swbreak+;QStartNoAckMode+";
+        return reply.str();
+    }
+    if(packet == "QStartNoAckMode") {
+        return "OK";
+    }
+    if(packet == "qAttached") {
+        return "1";
+    }
+    if(packet == "qC") {
+        return "QC1";
+    }
+    if(packet == "qfThreadInfo") {
+        return "m1";
+    }
+    if(packet == "qsThreadInfo") {
+        return "l";
+    }
+
+    const std::string features = "qXfer:features:read:target.xml:";
+    if(packet.rfind(features, 0) == 0) {
+        static const std::string description = buildTargetDescription();
+
+        size_t pos = features.size();
+        uint32_t offset, length;
+        if(!parseNumber(packet, pos, offset) || !expect(packet, pos, ',') || !parseNumber(packet, pos, length)) {
+            return "E01";
+        }
+        if(offset >= description.size()) {
+            return "l";
+        }
+        std::string chunk = description.substr(offset, std::min(length, PACKET_SIZE - 1));
+        return (offset + chunk.size() < description.size() ? "m" : "l") + chunk;
+    }
+
+    return "";
+}
+
+bool GDBStub::readRegister(uint32_t index, std::string &hex) {
+    if(index < PC_REGISTER) {
+        appendHex(hex, hart.getRegisters().r[index], 4);
+    } else if(index == PC_REGISTER) {
+        appendHex(hex, hart.getPC(), 4);
+    } else if(index < FIRST_CSR_REGISTER) {
+        appendHex(hex, hart.getFloatRegisters().f[index - FIRST_FLOAT_REGISTER], 8);
+    } else if(index == PRIV_REGISTER) {
+        appendHex(hex, hart.isSupervisorMode() ? 1 : 0, 4);
+    } else {
+        uint32_t value;
+        if(index > PRIV_REGISTER || !hart.readDebugCSR(index - FIRST_CSR_REGISTER, value)) {
+            return false;
+        }
+        appendHex(hex, value, 4);
+    }
+    return true;
+}
+
+bool GDBStub::writeRegister(uint32_t index, const std::string &hex) {
+    uint64_t value;
+    if(index < PC_REGISTER) {
+        if(!parseHexBytes(hex, 0, 4, value)) {
+            return false;
+        }
+        if(index != 0) {
+            hart.getRegisters().r[index] = value;
+        }
+    } else if(index == PC_REGISTER) {
+        if(!parseHexBytes(hex, 0, 4, value)) {
+            return false;
+        }
+        hart.setPC(value);
+    } else if(index < FIRST_CSR_REGISTER) {
+        if(!parseHexBytes(hex, 0, 8, value)) {
+            return false;
+        }
+        hart.getFloatRegisters().f[index - FIRST_FLOAT_REGISTER] = value;
+    } else {
+        // The privilege mode can not be changed
+        if(index >= PRIV_REGISTER || !parseHexBytes(hex, 0, 4, value)) {
+            return false;
+        }
+        return hart.writeDebugCSR(index - FIRST_CSR_REGISTER, value);
+    }
+    return true;
+}
+
+bool GDBStub::readMemory(uint32_t addr, uint8_t &value) {
+    if(!hart.readDebugMemory(addr, value)) {
+        return false;
+    }
+    for(const Breakpoint &breakpoint : breakpoints) {
+        if(addr - breakpoint.addr < breakpoint.length) {
+            value = breakpoint.original[addr - breakpoint.addr];
+        }
+    }
+    return true;
+}
+
+bool GDBStub::writeMemory(uint32_t addr, uint8_t value) {
+    // Writes to a patched instruction take effect when the breakpoint is removed
+    for(Breakpoint &breakpoint : breakpoints) {
+        if(addr - breakpoint.addr < breakpoint.length) {
+            breakpoint.original[addr - breakpoint.addr] = value;
+            return true;
+        }
+    }
+    return hart.writeDebugMemory(addr, value);
+}
+
+std::string GDBStub::setBreakpoint(uint32_t type, uint32_t addr, uint32_t kind, bool insert) {
+    // Hardware breakpoints are patched like software ones
+    if(type == 0 || type == 1) {
+        if(kind != 2 && kind != 4) {
+            return "E01";
+        }
+
+        auto existing = findBreakpoint(addr);
+        if(!insert) {
+            if(existing != breakpoints.end()) {
+                patchBreakpoint(*existing, false);
+                breakpoints.erase(existing);
+            }
+            return "OK";
+        }
+        if(existing != breakpoints.end()) {
+            return "OK";
+        }
+
+        Breakpoint breakpoint { addr, kind, {} };
+        for(uint32_t i = 0; i < kind; ++i) {
+            if(!hart.readDebugMemory(addr + i, breakpoint.original[i])) {
+                return "E14";
+            }
+        }
+        if(!patchBreakpoint(breakpoint, true)) {
+            patchBreakpoint(breakpoint, false);
+            return "E14";
+        }
+        breakpoints.push_back(breakpoint);
+        return "OK";
+    }
+
+    if(type < static_cast<uint32_t>(WatchKind::WRITE) || type > static_cast<uint32_t>(WatchKind::ACCESS) || kind == 0) {
+        return "";
+    }
+
+    Watchpoint watchpoint { addr, kind, static_cast<WatchKind>(type) };
+    auto existing = std::find_if(watchpoints.begin(), watchpoints.end(), [&watchpoint](const Watchpoint &w) {
+        return w.addr == watchpoint.addr && w.length == watchpoint.length && w.kind == watchpoint.kind;
+    });
+    if(insert && existing == watchpoints.end()) {
+        watchpoints.push_back(watchpoint);
+    } else if(!insert && existing != watchpoints.end()) {
+        watchpoints.erase(existing);
+    }
+
+    // The first watchpoint makes the hart report its data accesses, removing the last one stops it
+    hart.updateExecutionMode();
+    return "OK";
+}
+
+std::vector<GDBStub::Breakpoint>::iterator GDBStub::findBreakpoint(uint32_t addr) {
+    return std::find_if(breakpoints.begin(), breakpoints.end(), [addr](const Breakpoint &breakpoint) {
+        return breakpoint.addr == addr;
+    });
+}
+
+bool GDBStub::patchBreakpoint(const Breakpoint &breakpoint, bool insert) {
+    // The hart validates decoded instructions against the fetched bits, so patched code is decoded again
+    uint32_t instr = breakpoint.length == 2 ? C_EBREAK : EBREAK;
+    bool patched = true;
+    for(uint32_t i = 0; i < breakpoint.length; ++i) {
+        uint8_t value = insert ? instr >> (8 * i) : breakpoint.original[i];
+        patched &= hart.writeDebugMemory(breakpoint.addr + i, value);
+    }
+    return patched;
+}
+
+bool GDBStub::hitBreakpoint(uint32_t pc) {
+    if(findBreakpoint(pc) == breakpoints.end()) {
+        return false;
+    }
+    stopReason = StopReason::BREAKPOINT;
+    return true;
+}
+
+void GDBStub::checkWatchpoints(uint32_t addr, uint32_t size, bool reads, bool writes) {
+    for(const Watchpoint &watchpoint : watchpoints) {
+        bool overlaps = addr < watchpoint.addr + watchpoint.length && watchpoint.addr < addr + size;
+        bool matches = watchpoint.kind == WatchKind::ACCESS || (watchpoint.kind == WatchKind::WRITE ? writes : reads);
+        if(overlaps && matches) {
+            stopReason = StopReason::WATCHPOINT;
+            stopWatchpoint = watchpoint;
+            return;
+        }
+    }
+}
+
+bool GDBStub::receive() {
+    char buffer[PACKET_SIZE];
+    ssize_t received = recv(connection, buffer, sizeof(buffer), 0);
+    if(received <= 0) {
+        return false;
+    }
+    input.append(buffer, received);
+    return true;
+}
+
+bool GDBStub::readChar(char &c) {
+    if(input.empty() && !receive()) {
+        return false;
+    }
+    c = input[0];
+    input.erase(0, 1);
+    return true;
+}
+
+bool GDBStub::receivePacket(std::string &packet) {
+    char c;
+    while(readChar(c)) {
+        // Acknowledgements and interrupts while stopped are ignored
+        if(c != '$') {
+            continue;
+        }
+
+        packet.clear();
+        uint8_t checksum = 0;
+        while(readChar(c) && c != '#') {
+            packet += c;
+            checksum += c;
+        }
+
+        char digits[2];
+        if(!readChar(digits[0]) || !readChar(digits[1])) {
+            return false;
+        }
+        if(noAck) {
+            return true;
+        }
+
+        bool valid = getHexDigit(digits[0]) >= 0 && getHexDigit(digits[1]) >= 0 && ((getHexDigit(digits[0]) << 4) | getHexDigit(digits[1])) == checksum;
+        if(send(connection, valid ? "+" : "-", 1, MSG_NOSIGNAL) != 1) {
+            return false;
+        }
+        if(valid) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool GDBStub::sendPacket(const std::string &payload) {
+    uint8_t checksum = 0;
+    for(char c : payload) {
+        checksum += c;
+    }
+
+    std::string packet = "$" + payload + "#";
+    appendHex(packet, checksum, 1);
+
+    const char *data = packet.data();
+    size_t remaining = packet.size();
+    while(remaining > 0) {
+        ssize_t sent = send(connection, data, remaining, MSG_NOSIGNAL);
+        if(sent <= 0) {
+            return false;
+        }
+        data += sent;
+        remaining -= sent;
+    }
+    return true;
+}
+
+bool GDBStub::interruptRequested() {
+    pollfd request { connection, POLLIN, 0 };
+    if(poll(&request, 1, 0) > 0 && !receive()) {
+        return true; // a lost connection stops the hart as well, serve notices it next
+    }
+
+    size_t interrupt = input.find('\x03');
+    if(interrupt == std::string::npos) {
+        return false;
+    }
+    input.erase(interrupt, 1);
+    return true;
+}
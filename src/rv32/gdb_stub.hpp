@@ -0,0 +1,101 @@
+#ifndef __GDB_STUB_HPP__
+#define __GDB_STUB_HPP__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "hart.hpp"
+
+namespace RV32 {
+    // Serves the GDB remote serial protocol on a local socket. Breakpoints are ebreak instructions patched into
+    // guest memory, so the hart runs its normal execution loop until it reaches one. Only while watchpoints are
+    // set does the hart switch to the instrumented loop to report its data accesses.
+    class GDBStub {
+        public:
+            enum class Result: uint32_t {
+                DETACHED,   // GDB detached or disconnected, the hart keeps running without it
+                KILLED,     // GDB asked to end the emulation
+                FINISHED    // the guest shut down while GDB let it run
+            };
+
+            explicit GDBStub(Hart &hart);
+            ~GDBStub();
+
+            // Listens on a localhost TCP port, or on a Unix socket if the address is not a number,
+            // and waits for GDB to connect
+            bool open(const std::string &address);
+
+            // Serves GDB until it detaches or running is cleared, the hart only runs when GDB continues or steps it
+            Result serve(const bool &running);
+
+            // Called by the hart on every ebreak, returns true if it is one of the breakpoints
+            bool hitBreakpoint(uint32_t pc);
+
+            // Called by the hart after every load and store while watchesMemory() is true
+            bool watchesMemory() const { return !watchpoints.empty(); }
+            void checkWatchpoints(uint32_t addr, uint32_t size, bool reads, bool writes);
+        private:
+            static constexpr uint32_t POLL_INTERVAL = 0x10000; // instructions between checks for an interrupt from GDB
+            static constexpr uint32_t PACKET_SIZE = 0x4000;
+
+            enum class StopReason: uint32_t {
+                NONE, STEP, INTERRUPT, BREAKPOINT, WATCHPOINT
+            };
+
+            // Numbered like the Z packet types
+            enum class WatchKind: uint32_t {
+                WRITE = 2, READ = 3, ACCESS = 4
+            };
+
+            struct Breakpoint {
+                uint32_t addr;
+                uint32_t length;    // 2 for c.ebreak, 4 for ebreak
+                uint8_t original[4];
+            };
+
+            struct Watchpoint {
+                uint32_t addr;
+                uint32_t length;
+                WatchKind kind;
+            };
+
+            Hart &hart;
+            int connection = -1;
+            std::string socketPath; // removed again for Unix sockets
+            std::string input;      // received bytes not yet consumed
+            bool noAck = false;
+            bool reportSwbreak = false;
+
+            std::vector<Breakpoint> breakpoints;
+            std::vector<Watchpoint> watchpoints;
+
+            StopReason stopReason = StopReason::NONE;
+            Watchpoint stopWatchpoint {};
+
+            bool receive();
+            bool readChar(char &c);
+            bool receivePacket(std::string &packet);
+            bool sendPacket(const std::string &payload);
+            bool interruptRequested();
+            void close();
+            void detach();
+
+            void resume(bool step, const bool &running);
+            std::string getStopReply() const;
+            std::string handlePacket(const std::string &packet);
+            std::string handleQuery(const std::string &packet);
+
+            bool readRegister(uint32_t index, std::string &hex);
+            bool writeRegister(uint32_t index, const std::string &hex);
+
+            // Guest memory as GDB sees it, without the patched breakpoints
+            bool readMemory(uint32_t addr, uint8_t &value);
+            bool writeMemory(uint32_t addr, uint8_t value);
+
+            std::string setBreakpoint(uint32_t type, uint32_t addr, uint32_t kind, bool insert);
+            std::vector<Breakpoint>::iterator findBreakpoint(uint32_t addr);
+            bool patchBreakpoint(const Breakpoint &breakpoint, bool insert);
+    };
+};
+
+#endif /* __GDB_STUB_HPP__ */
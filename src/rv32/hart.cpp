@@ -4,15 +4,125 @@
 #include "decoder.hpp"
 #include "vmem.hpp"
 #include "instruction.hpp"
+#include "gdb_stub.hpp"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 using RV32::Hart;
 using RV32::InstructionType;
 using RV32::Opcode;
+using RV32::InstructionFormat;
+using RV32::SpinDetector;
+using RV32::TraceRecord;
+using RV32::MemoryAccess;
+using RV32::DecodedInstruction;
+using RV32::FPResult;
+using RV32::PMUEvent;
+using RV32::PMUEventCounts;
+using RV32::SBIResult;
+using RV32::SyscallRecord;
+
+namespace {
+    uint32_t getAccessSize(Opcode opcode) {
+        switch(opcode) {
+            case Opcode::LB:
+            case Opcode::LBU:
+            case Opcode::SB:
+                return 1;
+            case Opcode::LH:
+            case Opcode::LHU:
+            case Opcode::SH:
+                return 2;
+            default:
+                return 4;
+        }
+    }
+
+    // Bytes accessed by a scalar load, store or AMO
+    uint32_t getDataAccessSize(const DecodedInstruction &decoded) {
+        switch(decoded.type) {
+            case InstructionType::LOAD:
+            case InstructionType::STORE:
+                return getAccessSize(decoded.opcode);
+            case InstructionType::LOAD_FP:
+                return decoded.opcode == Opcode::FLD ? 8 : 4;
+            case InstructionType::STORE_FP:
+                return decoded.opcode == Opcode::FSD ? 8 : 4;
+            default:
+                return 4;
+        }
+    }
+
+    // Only the low five bits of the amount are used, so rotating left is rotating right by the negated amount
+    uint32_t rotateRight(uint32_t val, uint32_t amount) {
+        amount &= 0x1F;
+        return (val >> amount) | (val << ((32 - amount) & 0x1F));
+    }
+
+    // Vector elements are little endian in memory and in the register file
+    void readElement(MemoryMapManager &mem, uint32_t addr, uint32_t size, uint8_t *element) {
+        switch(size) {
+            case 1:
+                element[0] = mem.readByte(addr);
+                break;
+            case 2: {
+                uint16_t value = mem.readHalfword(addr);
+                std::memcpy(element, &value, sizeof(value));
+                break;
+            }
+            default:
+                for(uint32_t offset = 0; offset < size; offset += 4) {
+                    uint32_t value = mem.readWord(addr + offset);
+                    std::memcpy(element + offset, &value, sizeof(value));
+                }
+                break;
+        }
+    }
+
+    void writeElement(MemoryMapManager &mem, uint32_t addr, uint32_t size, const uint8_t *element) {
+        switch(size) {
+            case 1:
+                mem.writeByte(addr, element[0]);
+                break;
+            case 2: {
+                uint16_t value;
+                std::memcpy(&value, element, sizeof(value));
+                mem.writeHalfword(addr, value);
+                break;
+            }
+            default:
+                for(uint32_t offset = 0; offset < size; offset += 4) {
+                    uint32_t value;
+                    std::memcpy(&value, element + offset, sizeof(value));
+                    mem.writeWord(addr + offset, value);
+                }
+                break;
+        }
+    }
+}
 
 Hart::Hart(uint32_t pc, MemoryMapManager &mem, const HartConfig& hartConfig):
-    pc(pc), mem(mem), hartConfig(hartConfig), lastTime(std::chrono::system_clock::now()), timebasePeriod(SECONDS_TO_NANSECONDS * (1.0 / hartConfig.timebaseFreq)) {
+    pc(pc), mem(mem), hartConfig(hartConfig), csr(), lastTime(std::chrono::system_clock::now()), timebasePeriod(SECONDS_TO_NANSECONDS * (1.0 / hartConfig.timebaseFreq)) {
+    bool countsTicks = hartConfig.timeSource == TimeSource::INSTRET || hartConfig.timeSource == TimeSource::CYCLE;
+    if(countsTicks && hartConfig.instructionsPerTick == 0) {
+        throw EmulatorException("instructionsPerTick must be nonzero");
+    }
+
+    uint32_t vlen = hartConfig.vlen;
+    if((vlen & (vlen - 1)) != 0 || vlen < VectorRegisters::MIN_VLEN || vlen > VectorRegisters::MAX_VLEN) {
+        throw EmulatorException("vlen must be a power of two from 128 to 1024");
+    }
+    csr.vlenb = vlen / 8;
+    csr.vtype = VTYPE_VILL;
+
     this->reset();
+    updateExecutionMode();
+    resetTickCountdown();
+
+    if(hartConfig.enableFusion) {
+        decodeCache = std::make_unique<DecodeCacheEntry[]>(DECODE_CACHE_SIZE);
+    }
 }
 
 uint32_t Hart::getRegister(uint32_t index) const {
@@ -25,129 +135,300 @@ void Hart::setRegister(uint32_t index, uint32_t value) {
 }
 
 void Hart::stepInstruction() {
-    if((pc & 0b11) != 0) {
+    if((pc & 1) != 0) {
         handleException(ExceptionCode::INSTR_MISALIGNED_EXC, pc);
     }
 
-    handleInterrupts();
+    if(interruptPending) {
+        handleInterrupts();
+    }
+
+    (this->*executeFunction)();
+}
+
+void Hart::updateExecutionMode() {
+    // Indexed by paging, supervisor mode and whether any instrumentation is attached
+    static constexpr ExecuteFunction EXECUTE_FUNCTIONS[2][2][2] = {
+        {
+            {&Hart::executeInstruction<false, false, false>, &Hart::executeInstruction<false, false, true>},
+            {&Hart::executeInstruction<false, true, false>, &Hart::executeInstruction<false, true, true>},
+        },
+        {
+            {&Hart::executeInstruction<true, false, false>, &Hart::executeInstruction<true, false, true>},
+            {&Hart::executeInstruction<true, true, false>, &Hart::executeInstruction<true, true, true>},
+        },
+    };
+
+    // Paging and privilege changes all come through here, so the timeline sees them without a per-instruction check
+    if(bootTimeline != nullptr) {
+        bootTimeline->noteExecutionMode(csr.satp.mode != 0, supervisorMode, getInstret());
+    }
+
+    // Breakpoints are patched into memory, only watchpoints need to see the data accesses
+    bool watching = debugger != nullptr && debugger->watchesMemory();
+    bool watchingPC = bootTimeline != nullptr && bootTimeline->watchesPC();
+    bool instrumented = traceBuffer != nullptr || memorySimulator != nullptr || timingModel != nullptr || blockProfiler != nullptr
+        || pmu.isActive() || watching || watchingPC;
+    executeFunction = EXECUTE_FUNCTIONS[csr.satp.mode != 0][supervisorMode][instrumented];
+}
+
+void Hart::setTraceBuffer(TraceRingBuffer *buffer) {
+    traceBuffer = buffer;
+    updateExecutionMode();
+}
+
+void Hart::setMemorySimulator(MemoryHierarchySimulator *simulator) {
+    memorySimulator = simulator;
+    if(memorySimulator != nullptr) {
+        countedTLBMisses = memorySimulator->getTLBMisses();
+    }
+    updateExecutionMode();
+}
+
+void Hart::setTimingModel(TimingModel *model) {
+    // cycle continues from its current value
+    uint64_t cycle = getCycle();
+    csr.cycle = cycle & 0xFFFFFFFF;
+    csr.cycleh = cycle >> 32;
+
+    timingModel = model;
+    updateExecutionMode();
+    resetTickCountdown();
+}
+
+void Hart::setBlockProfiler(BasicBlockProfiler *profiler) {
+    blockProfiler = profiler;
+    updateExecutionMode();
+}
+
+void Hart::setBootTimeline(BootTimeline *timeline) {
+    bootTimeline = timeline;
+    updateExecutionMode();
+}
+
+void Hart::setDebugger(GDBStub *stub) {
+    debugger = stub;
+    updateExecutionMode();
+}
+
+uint64_t Hart::getCycle() const {
+    if(timingModel == nullptr) {
+        return getInstret();
+    }
+    return (static_cast<uint64_t>(csr.cycleh) << 32) | csr.cycle;
+}
 
-    uint32_t pcPhysicalAddr = pc;
-    if(!translateAddress(pcPhysicalAddr, MemoryAccessType::EXECUTE)) {
+template<bool PAGING, bool SUPERVISOR>
+bool Hart::fetchInstruction(uint32_t &pcPhysicalAddr, Instruction &instr) {
+    pcPhysicalAddr = pc;
+    if(!translateAddress<PAGING, SUPERVISOR>(pcPhysicalAddr, MemoryAccessType::EXECUTE)) {
         handleException(ExceptionCode::INSTR_PAGE_FAULT_EXC, pc);
-        pcPhysicalAddr = pc;
-        if(!translateAddress(pcPhysicalAddr, MemoryAccessType::EXECUTE)) {
-            throw EmulatorException("Page fault while translating exception handler address");
+        return false;
+    }
+
+    // Only a 32-bit instruction in the last halfword of a page continues on the next page
+    if((pcPhysicalAddr & (PAGE_SIZE - 1)) != PAGE_SIZE - 2) {
+        instr.bits = mem.readWord(pcPhysicalAddr);
+    } else {
+        instr.bits = mem.readHalfword(pcPhysicalAddr);
+        if(!isCompressed(instr.bits)) {
+            uint32_t upperPhysicalAddr = pc + 2;
+            if(!translateAddress<PAGING, SUPERVISOR>(upperPhysicalAddr, MemoryAccessType::EXECUTE)) {
+                handleException(ExceptionCode::INSTR_PAGE_FAULT_EXC, pc + 2);
+                return false;
+            }
+            instr.bits |= static_cast<uint32_t>(mem.readHalfword(upperPhysicalAddr)) << 16;
+        }
+    }
+
+    if(isCompressed(instr.bits)) {
+        instr.bits &= 0xFFFF;
+    }
+    return true;
+}
+
+bool Hart::fetchInstruction(uint32_t &pcPhysicalAddr, Instruction &instr) {
+    if(csr.satp.mode == 0) {
+        return fetchInstruction<false, false>(pcPhysicalAddr, instr);
+    }
+    return supervisorMode ? fetchInstruction<true, true>(pcPhysicalAddr, instr) : fetchInstruction<true, false>(pcPhysicalAddr, instr);
+}
+
+template<bool PAGING, bool SUPERVISOR, bool INSTRUMENTED>
+void Hart::executeInstruction() {
+    // A fetch fault traps, the handler runs on the next step in the loop matching its privilege and paging mode
+    uint32_t pcPhysicalAddr;
+    Instruction instr { 0 };
+    if(!fetchInstruction<PAGING, SUPERVISOR>(pcPhysicalAddr, instr)) {
+        if(!fetchInstruction(pcPhysicalAddr, instr)) {
+            throw EmulatorException("Page fault while fetching exception handler");
         }
+        return;
     }
 
-    Instruction instr { mem.readWord(pcPhysicalAddr) };
+    uint32_t instrPC = pc;
+
     shouldIncrementPC = true;
 
-    switch(decodeInstructionType(instr)) {
+    DecodedInstruction decoded;
+    if(decodeCache) {
+        const DecodeCacheEntry &entry = lookupDecodeCache(pcPhysicalAddr, instr);
+        // Instrumentation observes every instruction separately and a debugger steps them one by one, so pairs are not fused
+        if(!INSTRUMENTED && debugger == nullptr && entry.fusion != FusionKind::NONE && executeFused(entry)) {
+            incrementCounters();
+            incrementCounters();
+            return;
+        }
+        decoded = entry.first;
+    } else {
+        decoded = decode(instr);
+    }
+
+    Opcode opcode = decoded.opcode;
+
+    // Captured before execution, a load may overwrite its base register
+    uint32_t traceMemAddr = 0;
+    uint32_t dataPhysAddr = 0;
+    bool hasDataAccess = false;
+
+    // SBI calls that start or stop the counters are not counted themselves
+    bool countingEvents = INSTRUMENTED && pmu.isActive();
+    if constexpr(INSTRUMENTED) {
+        bool isAMO = decoded.type == InstructionType::AMO;
+        bool isFloatMemory = decoded.type == InstructionType::LOAD_FP || decoded.type == InstructionType::STORE_FP;
+        bool isVectorMemory = decoded.type == InstructionType::LOAD_V || decoded.type == InstructionType::STORE_V;
+        if(decoded.type == InstructionType::LOAD || decoded.type == InstructionType::STORE || isAMO || isFloatMemory) {
+            traceMemAddr = getRegister(decoded.rs1) + (isAMO ? 0 : decoded.imm);
+        } else if(isVectorMemory) {
+            traceMemAddr = getRegister(decoded.rs1); // base address, elements are recorded as they are accessed
+        }
+    }
+
+    switch(decoded.type) {
         case InstructionType::LOAD: {
-                uint32_t effectiveAddr = getRegister(instr.i.rs1) + instr.i.immediateValue();
+                uint32_t effectiveAddr = getRegister(decoded.rs1) + decoded.imm;
+                uint32_t accessSize = getAccessSize(opcode);
+
+                if((effectiveAddr & (accessSize - 1)) != 0) {
+                    uint32_t value;
+                    uint32_t physAddr;
+                    if(!hartConfig.emulateMisaligned) {
+                        handleException(ExceptionCode::LOAD_MISALIGNED_EXC, effectiveAddr);
+                    } else if(loadMisaligned(effectiveAddr, accessSize, value, physAddr)) {
+                        if constexpr(INSTRUMENTED) {
+                            dataPhysAddr = physAddr;
+                            hasDataAccess = true;
+                        }
+                        setRegister(decoded.rd, opcode == Opcode::LH ? SIGN_EXTEND(value, 16) : value);
+                    }
+                    break;
+                }
 
-                if(!translateAddress(effectiveAddr, MemoryAccessType::READ)) {
+                if(!translateAddress<PAGING, SUPERVISOR>(effectiveAddr, MemoryAccessType::READ)) {
                     handleException(ExceptionCode::LOAD_PAGE_FAULT_EXC, effectiveAddr);
                     break;
                 }
 
-                switch(decodeOpcode(instr)) {
+                if constexpr(INSTRUMENTED) {
+                    dataPhysAddr = effectiveAddr;
+                    hasDataAccess = true;
+                }
+
+                switch(opcode) {
                     case Opcode::LB:
-                        setRegister(instr.i.rd, SIGN_EXTEND(mem.readByte(effectiveAddr), 8));
+                        setRegister(decoded.rd, SIGN_EXTEND(mem.readByte(effectiveAddr), 8));
                         break;
                     case Opcode::LH:
-                        if((effectiveAddr & 0b1) != 0) {
-                            handleException(ExceptionCode::LOAD_MISALIGNED_EXC, effectiveAddr);
-                            break;
-                        }
-                        setRegister(instr.i.rd, SIGN_EXTEND(mem.readHalfword(effectiveAddr), 16));
+                        setRegister(decoded.rd, SIGN_EXTEND(mem.readHalfword(effectiveAddr), 16));
                         break;
                     case Opcode::LW:
-                        if((effectiveAddr & 0b11) != 0) {
-                            handleException(ExceptionCode::LOAD_MISALIGNED_EXC, effectiveAddr);
-                            break;
-                        }
-                        setRegister(instr.i.rd, mem.readWord(effectiveAddr));
+                        setRegister(decoded.rd, mem.readWord(effectiveAddr));
                         break;
                     case Opcode::LBU:
-                        setRegister(instr.i.rd, mem.readByte(effectiveAddr));
+                        setRegister(decoded.rd, mem.readByte(effectiveAddr));
                         break;
                     case Opcode::LHU:
-                        if((effectiveAddr & 0b1) != 0) {
-                            handleException(ExceptionCode::LOAD_MISALIGNED_EXC, effectiveAddr);
-                            break;
-                        }
-                        setRegister(instr.i.rd, mem.readHalfword(effectiveAddr));
+                        setRegister(decoded.rd, mem.readHalfword(effectiveAddr));
                         break;
                 }
             }
             break;
         case InstructionType::STORE: {
-                uint32_t effectiveAddr = getRegister(instr.s.rs1) + instr.s.immediateValue();
+                uint32_t effectiveAddr = getRegister(decoded.rs1) + decoded.imm;
+                uint32_t accessSize = getAccessSize(opcode);
+
+                if((effectiveAddr & (accessSize - 1)) != 0) {
+                    uint32_t physAddr;
+                    if(!hartConfig.emulateMisaligned) {
+                        handleException(ExceptionCode::STR_AMO_MISALIGNED_EXC, effectiveAddr);
+                    } else if(storeMisaligned(effectiveAddr, accessSize, getRegister(decoded.rs2), physAddr)) {
+                        if constexpr(INSTRUMENTED) {
+                            dataPhysAddr = physAddr;
+                            hasDataAccess = true;
+                        }
+                    }
+                    break;
+                }
 
-                if(!translateAddress(effectiveAddr, MemoryAccessType::WRITE)) {
+                if(!translateAddress<PAGING, SUPERVISOR>(effectiveAddr, MemoryAccessType::WRITE)) {
                     handleException(ExceptionCode::STR_AMO_PAGE_FAULT_EXC, effectiveAddr);
                     break;
                 }
 
-                switch(decodeOpcode(instr)) {
+                if constexpr(INSTRUMENTED) {
+                    dataPhysAddr = effectiveAddr;
+                    hasDataAccess = true;
+                }
+
+                switch(opcode) {
                     case Opcode::SB:
-                        mem.writeByte(effectiveAddr, getRegister(instr.s.rs2) & 0xFF);
+                        mem.writeByte(effectiveAddr, getRegister(decoded.rs2) & 0xFF);
                         break;
                     case Opcode::SH:
-                        if((effectiveAddr & 0b1) != 0) {
-                            handleException(ExceptionCode::STR_AMO_MISALIGNED_EXC, effectiveAddr);
-                            break;
-                        }
-                        mem.writeHalfword(effectiveAddr, getRegister(instr.s.rs2) & 0xFFFF);
+                        mem.writeHalfword(effectiveAddr, getRegister(decoded.rs2) & 0xFFFF);
                         break;
                     case Opcode::SW:
-                        if((effectiveAddr & 0b11) != 0) {
-                            handleException(ExceptionCode::STR_AMO_MISALIGNED_EXC, effectiveAddr);
-                            break;
-                        }
-                        mem.writeWord(effectiveAddr, getRegister(instr.s.rs2));
+                        mem.writeWord(effectiveAddr, getRegister(decoded.rs2));
                         break;
                 }
             }
             break;
         case InstructionType::BRANCH: {
-            uint32_t effectiveAddr = pc + instr.b.immediateValue();
+            uint32_t effectiveAddr = pc + decoded.imm;
 
-            switch(decodeOpcode(instr)) {
+            switch(opcode) {
                 case Opcode::BEQ:
-                    if(getRegister(instr.b.rs1) == getRegister(instr.b.rs2)) {
+                    if(getRegister(decoded.rs1) == getRegister(decoded.rs2)) {
                         shouldIncrementPC = false;
                         pc = effectiveAddr;
                     }
                     break;
                 case Opcode::BNE:
-                    if(getRegister(instr.b.rs1) != getRegister(instr.b.rs2)) {
+                    if(getRegister(decoded.rs1) != getRegister(decoded.rs2)) {
                         shouldIncrementPC = false;
                         pc = effectiveAddr;
                     }
                     break;
                 case Opcode::BLT:
-                    if(static_cast<int32_t>(getRegister(instr.b.rs1)) < static_cast<int32_t>(getRegister(instr.b.rs2))) {
+                    if(static_cast<int32_t>(getRegister(decoded.rs1)) < static_cast<int32_t>(getRegister(decoded.rs2))) {
                         shouldIncrementPC = false;
                         pc = effectiveAddr;
                     }
                     break;
                 case Opcode::BGE:
-                    if(static_cast<int32_t>(getRegister(instr.b.rs1)) >= static_cast<int32_t>(getRegister(instr.b.rs2))) {
+                    if(static_cast<int32_t>(getRegister(decoded.rs1)) >= static_cast<int32_t>(getRegister(decoded.rs2))) {
                         shouldIncrementPC = false;
                         pc = effectiveAddr;
                     }
                     break;
                 case Opcode::BLTU:
-                    if(getRegister(instr.b.rs1) < getRegister(instr.b.rs2)) {
+                    if(getRegister(decoded.rs1) < getRegister(decoded.rs2)) {
                         shouldIncrementPC = false;
                         pc = effectiveAddr;
                     }
                     break;
                 case Opcode::BGEU:
-                    if(getRegister(instr.b.rs1) >= getRegister(instr.b.rs2)) {
+                    if(getRegister(decoded.rs1) >= getRegister(decoded.rs2)) {
                         shouldIncrementPC = false;
                         pc = effectiveAddr;
                     }
@@ -157,25 +438,23 @@ void Hart::stepInstruction() {
         }
         case InstructionType::JUMP:
             shouldIncrementPC = false;
-            switch(decodeOpcode(instr)) {
+            switch(opcode) {
                     case Opcode::JAL: {
-                        setRegister(instr.j.rd, pc + 4);
-                        uint32_t effectiveAddr = pc + instr.j.immediateValue();
+                        setRegister(decoded.rd, pc + decoded.length);
+                        uint32_t effectiveAddr = pc + decoded.imm;
                         pc = effectiveAddr;
                         break;
                     }
                     case Opcode::JALR: {
-                        uint32_t effectiveAddr = getRegister(instr.i.rs1) + instr.i.immediateValue();
-                        setRegister(instr.i.rd, pc + 4);
+                        uint32_t effectiveAddr = getRegister(decoded.rs1) + decoded.imm;
+                        setRegister(decoded.rd, pc + decoded.length);
                         pc = effectiveAddr & 0xFFFFFFFE; // clear least significant bit
                         break;
                     }
             }
             break;
         case InstructionType::AMO: {
-            uint32_t addr = getRegister(instr.r.rs1);
-
-            Opcode opcode = decodeOpcode(instr);
+            uint32_t addr = getRegister(decoded.rs1);
 
             if((addr & 0b11) != 0) {
                 if(opcode == Opcode::LR_W) {
@@ -187,265 +466,394 @@ void Hart::stepInstruction() {
             }
 
             if(opcode == Opcode::LR_W) {
-                if(!translateAddress(addr, MemoryAccessType::READ)) {
+                if(!translateAddress<PAGING, SUPERVISOR>(addr, MemoryAccessType::READ)) {
                     handleException(ExceptionCode::LOAD_PAGE_FAULT_EXC, addr);
                     break;
                 }
             } else {
-                if(!translateAddress(addr, MemoryAccessType::WRITE)) {
+                if(!translateAddress<PAGING, SUPERVISOR>(addr, MemoryAccessType::WRITE)) {
                     handleException(ExceptionCode::STR_AMO_PAGE_FAULT_EXC, addr);
                     break;
                 }
             }
 
+            if constexpr(INSTRUMENTED) {
+                dataPhysAddr = addr;
+                hasDataAccess = true;
+            }
+
             uint32_t val = mem.readWord(addr);
 
             switch(opcode) {
                 case Opcode::LR_W: {
-                    setRegister(instr.r.rd, val);
+                    setRegister(decoded.rd, val);
                     reservationSetValid = true;
                     break;
                 }
                 case Opcode::SC_W: {
                     if(reservationSetValid) {
-                        mem.writeWord(addr, getRegister(instr.r.rs2));
-                        setRegister(instr.r.rd, 0);
+                        mem.writeWord(addr, getRegister(decoded.rs2));
+                        setRegister(decoded.rd, 0);
                         reservationSetValid = false;
                     } else {
-                        setRegister(instr.r.rd, 1);
+                        setRegister(decoded.rd, 1);
                     }
                     break;
                 }
                 case Opcode::AMOSWAP_W: {
-                    uint32_t temp = getRegister(instr.r.rs2);
-                    setRegister(instr.r.rs2, val);
+                    uint32_t temp = getRegister(decoded.rs2);
                     mem.writeWord(addr, temp);
-                    setRegister(instr.r.rd, val);
+                    setRegister(decoded.rd, val);
                     break;
                 }
                 case Opcode::AMOADD_W: {
-                    uint32_t temp = val + getRegister(instr.r.rs2);
+                    uint32_t temp = val + getRegister(decoded.rs2);
                     mem.writeWord(addr, temp);
-                    setRegister(instr.r.rd, val);
+                    setRegister(decoded.rd, val);
                     break;
                 }
                 case Opcode::AMOXOR_W: {
-                    uint32_t temp = val ^ getRegister(instr.r.rs2);
+                    uint32_t temp = val ^ getRegister(decoded.rs2);
                     mem.writeWord(addr, temp);
-                    setRegister(instr.r.rd, val);
+                    setRegister(decoded.rd, val);
                     break;
                 }
                 case Opcode::AMOAND_W: {
-                    uint32_t temp = val & getRegister(instr.r.rs2);
+                    uint32_t temp = val & getRegister(decoded.rs2);
                     mem.writeWord(addr, temp);
-                    setRegister(instr.r.rd, val);
+                    setRegister(decoded.rd, val);
                     break;
                 }
                 case Opcode::AMOOR_W: {
-                    uint32_t temp = val | getRegister(instr.r.rs2);
+                    uint32_t temp = val | getRegister(decoded.rs2);
                     mem.writeWord(addr, temp);
-                    setRegister(instr.r.rd, val);
+                    setRegister(decoded.rd, val);
                     break;
                 }
                 case Opcode::AMOMIN_W: {
-                    uint32_t temp = std::min(static_cast<int32_t>(val), static_cast<int32_t>(getRegister(instr.r.rs2)));
+                    uint32_t temp = std::min(static_cast<int32_t>(val), static_cast<int32_t>(getRegister(decoded.rs2)));
                     mem.writeWord(addr, temp);
-                    setRegister(instr.r.rd, val);
+                    setRegister(decoded.rd, val);
                     break;
                 }
                 case Opcode::AMOMAX_W: {
-                    uint32_t temp = std::max(static_cast<int32_t>(val), static_cast<int32_t>(getRegister(instr.r.rs2)));
+                    uint32_t temp = std::max(static_cast<int32_t>(val), static_cast<int32_t>(getRegister(decoded.rs2)));
                     mem.writeWord(addr, temp);
-                    setRegister(instr.r.rd, val);
+                    setRegister(decoded.rd, val);
                     break;
                 }
                 case Opcode::AMOMINU_W: {
-                    uint32_t temp = std::min(val, getRegister(instr.r.rs2));
+                    uint32_t temp = std::min(val, getRegister(decoded.rs2));
                     mem.writeWord(addr, temp);
-                    setRegister(instr.r.rd, val);
+                    setRegister(decoded.rd, val);
                     break;
                 }
                 case Opcode::AMOMAXU_W: {
-                    uint32_t temp = std::max(val, getRegister(instr.r.rs2));
+                    uint32_t temp = std::max(val, getRegister(decoded.rs2));
                     mem.writeWord(addr, temp);
-                    setRegister(instr.r.rd, val);
+                    setRegister(decoded.rd, val);
                     break;
                 }
             }
             break;
         }
         case InstructionType::OP_IMM: {
-                switch(decodeOpcode(instr)) {
+                switch(opcode) {
                     case Opcode::ADDI: {
-                        setRegister(instr.i.rd, getRegister(instr.i.rs1) + instr.i.immediateValue());
+                        setRegister(decoded.rd, getRegister(decoded.rs1) + decoded.imm);
                         break;
                     }
                     case Opcode::SLTI: {
-                        int32_t rs1Signed = getRegister(instr.i.rs1);
-                        int32_t immSigned = instr.i.immediateValue();
-                        setRegister(instr.i.rd, (rs1Signed < immSigned) ? 1 : 0);
+                        int32_t rs1Signed = getRegister(decoded.rs1);
+                        int32_t immSigned = decoded.imm;
+                        setRegister(decoded.rd, (rs1Signed < immSigned) ? 1 : 0);
                         break;
                     }
                     case Opcode::SLTIU: {
-                        uint32_t rs1Unsigned = getRegister(instr.i.rs1);
-                        uint32_t immUnsigned = instr.i.immediateValue();
-                        setRegister(instr.i.rd, (rs1Unsigned < immUnsigned) ? 1 : 0);
+                        uint32_t rs1Unsigned = getRegister(decoded.rs1);
+                        uint32_t immUnsigned = decoded.imm;
+                        setRegister(decoded.rd, (rs1Unsigned < immUnsigned) ? 1 : 0);
                         break;
                     }
                     case Opcode::XORI: {
-                        setRegister(instr.i.rd, getRegister(instr.i.rs1) ^ instr.i.immediateValue());
+                        setRegister(decoded.rd, getRegister(decoded.rs1) ^ decoded.imm);
                         break;
                     }
                     case Opcode::ORI: {
-                        setRegister(instr.i.rd, getRegister(instr.i.rs1) | instr.i.immediateValue());
+                        setRegister(decoded.rd, getRegister(decoded.rs1) | decoded.imm);
                         break;
                     }
                     case Opcode::ANDI: {
-                        setRegister(instr.i.rd, getRegister(instr.i.rs1) & instr.i.immediateValue());
+                        setRegister(decoded.rd, getRegister(decoded.rs1) & decoded.imm);
                         break;
                     }
                     case Opcode::SLLI: {
-                        uint32_t shamt = instr.r.rs2;
-                        setRegister(instr.i.rd, getRegister(instr.i.rs1) << shamt);
+                        uint32_t shamt = decoded.imm;
+                        setRegister(decoded.rd, getRegister(decoded.rs1) << shamt);
                         break;
                     }
                     case Opcode::SRLI: {
-                        uint32_t shamt = instr.r.rs2;
-                        setRegister(instr.i.rd, getRegister(instr.i.rs1) >> shamt);
+                        uint32_t shamt = decoded.imm;
+                        setRegister(decoded.rd, getRegister(decoded.rs1) >> shamt);
                         break;
                     }
                     case Opcode::SRAI: {
-                        uint32_t shamt = instr.r.rs2;
-                        setRegister(instr.i.rd, static_cast<int32_t>(getRegister(instr.i.rs1)) >> shamt);
+                        uint32_t shamt = decoded.imm;
+                        setRegister(decoded.rd, static_cast<int32_t>(getRegister(decoded.rs1)) >> shamt);
+                        break;
+                    }
+                    case Opcode::CLZ: {
+                        uint32_t rs1 = getRegister(decoded.rs1);
+                        setRegister(decoded.rd, rs1 == 0 ? 32 : __builtin_clz(rs1));
+                        break;
+                    }
+                    case Opcode::CTZ: {
+                        uint32_t rs1 = getRegister(decoded.rs1);
+                        setRegister(decoded.rd, rs1 == 0 ? 32 : __builtin_ctz(rs1));
+                        break;
+                    }
+                    case Opcode::CPOP: {
+                        setRegister(decoded.rd, __builtin_popcount(getRegister(decoded.rs1)));
+                        break;
+                    }
+                    case Opcode::SEXT_B: {
+                        setRegister(decoded.rd, static_cast<int8_t>(getRegister(decoded.rs1)));
+                        break;
+                    }
+                    case Opcode::SEXT_H: {
+                        setRegister(decoded.rd, static_cast<int16_t>(getRegister(decoded.rs1)));
+                        break;
+                    }
+                    case Opcode::RORI: {
+                        setRegister(decoded.rd, rotateRight(getRegister(decoded.rs1), decoded.imm));
+                        break;
+                    }
+                    case Opcode::ORC_B: {
+                        // The top bit of each byte ends up set if any bit of the byte was set
+                        uint32_t rs1 = getRegister(decoded.rs1);
+                        uint32_t nonZero = (((rs1 & 0x7F7F7F7F) + 0x7F7F7F7F) | rs1) & 0x80808080;
+                        setRegister(decoded.rd, (nonZero >> 7) * 0xFF);
+                        break;
+                    }
+                    case Opcode::REV8: {
+                        setRegister(decoded.rd, __builtin_bswap32(getRegister(decoded.rs1)));
+                        break;
+                    }
+                    case Opcode::BCLRI: {
+                        setRegister(decoded.rd, getRegister(decoded.rs1) & ~(1u << decoded.imm));
+                        break;
+                    }
+                    case Opcode::BEXTI: {
+                        setRegister(decoded.rd, (getRegister(decoded.rs1) >> decoded.imm) & 1);
+                        break;
+                    }
+                    case Opcode::BINVI: {
+                        setRegister(decoded.rd, getRegister(decoded.rs1) ^ (1u << decoded.imm));
+                        break;
+                    }
+                    case Opcode::BSETI: {
+                        setRegister(decoded.rd, getRegister(decoded.rs1) | (1u << decoded.imm));
                         break;
                     }
                 }
             }
             break;
         case InstructionType::OP: {
-            switch(decodeOpcode(instr)) {
+            switch(opcode) {
                 case Opcode::ADD: {
-                    setRegister(instr.r.rd, getRegister(instr.r.rs1) + getRegister(instr.r.rs2));
+                    setRegister(decoded.rd, getRegister(decoded.rs1) + getRegister(decoded.rs2));
                     break;
                 }
                 case Opcode::SUB: {
-                    setRegister(instr.r.rd, getRegister(instr.r.rs1) - getRegister(instr.r.rs2));
+                    setRegister(decoded.rd, getRegister(decoded.rs1) - getRegister(decoded.rs2));
                     break;
                 }
                 case Opcode::SLL: {
-                    uint32_t shamt = getRegister(instr.r.rs2) & 0x1F; // only use lower five bits for shift amount
-                    setRegister(instr.r.rd, getRegister(instr.r.rs1) << shamt);
+                    uint32_t shamt = getRegister(decoded.rs2) & 0x1F; // only use lower five bits for shift amount
+                    setRegister(decoded.rd, getRegister(decoded.rs1) << shamt);
                     break;
                 }
                 case Opcode::SLT: {
-                    int32_t rs1Signed = getRegister(instr.r.rs1);
-                    int32_t rs2Signed = getRegister(instr.r.rs2);
-                    setRegister(instr.r.rd, (rs1Signed < rs2Signed) ? 1 : 0);
+                    int32_t rs1Signed = getRegister(decoded.rs1);
+                    int32_t rs2Signed = getRegister(decoded.rs2);
+                    setRegister(decoded.rd, (rs1Signed < rs2Signed) ? 1 : 0);
                     break;
                 }
                 case Opcode::SLTU: {
-                    uint32_t rs1 = getRegister(instr.r.rs1);
-                    uint32_t rs2 = getRegister(instr.r.rs2);
-                    setRegister(instr.r.rd, (rs1 < rs2) ? 1 : 0);
+                    uint32_t rs1 = getRegister(decoded.rs1);
+                    uint32_t rs2 = getRegister(decoded.rs2);
+                    setRegister(decoded.rd, (rs1 < rs2) ? 1 : 0);
                     break;
                 }
                 case Opcode::XOR: {
-                    setRegister(instr.r.rd, getRegister(instr.r.rs1) ^ getRegister(instr.r.rs2));
+                    setRegister(decoded.rd, getRegister(decoded.rs1) ^ getRegister(decoded.rs2));
                     break;
                 }
                 case Opcode::SRL: {
-                    uint32_t shamt = getRegister(instr.r.rs2) & 0x1F;
-                    setRegister(instr.r.rd, getRegister(instr.r.rs1) >> shamt);
+                    uint32_t shamt = getRegister(decoded.rs2) & 0x1F;
+                    setRegister(decoded.rd, getRegister(decoded.rs1) >> shamt);
                     break;
                 }
                 case Opcode::SRA: {
-                    uint32_t shamt = getRegister(instr.r.rs2) & 0x1F;
-                    setRegister(instr.r.rd, static_cast<int32_t>(getRegister(instr.r.rs1)) >> shamt);
+                    uint32_t shamt = getRegister(decoded.rs2) & 0x1F;
+                    setRegister(decoded.rd, static_cast<int32_t>(getRegister(decoded.rs1)) >> shamt);
                     break;
                 }
                 case Opcode::OR: {
-                    setRegister(instr.r.rd, getRegister(instr.r.rs1) | getRegister(instr.r.rs2));
+                    setRegister(decoded.rd, getRegister(decoded.rs1) | getRegister(decoded.rs2));
                     break;
                 }
                 case Opcode::AND: {
-                    setRegister(instr.r.rd, getRegister(instr.r.rs1) & getRegister(instr.r.rs2));
+                    setRegister(decoded.rd, getRegister(decoded.rs1) & getRegister(decoded.rs2));
                     break;
                 }
                 case Opcode::MUL: {
-                    uint64_t result = getRegister(instr.r.rs1) * getRegister(instr.r.rs2);
-                    setRegister(instr.r.rd, result & 0xFFFFFFFF);
+                    uint64_t result = getRegister(decoded.rs1) * getRegister(decoded.rs2);
+                    setRegister(decoded.rd, result & 0xFFFFFFFF);
                     break;
                 }
                 case Opcode::MULH: {
-                    uint64_t result = SIGN_EXTEND(static_cast<int64_t>(getRegister(instr.r.rs1)), 32) * SIGN_EXTEND(static_cast<int64_t>(getRegister(instr.r.rs2)), 32);
-                    setRegister(instr.r.rd, (result >> 32) & 0xFFFFFFFF);
+                    uint64_t result = SIGN_EXTEND(static_cast<int64_t>(getRegister(decoded.rs1)), 32) * SIGN_EXTEND(static_cast<int64_t>(getRegister(decoded.rs2)), 32);
+                    setRegister(decoded.rd, (result >> 32) & 0xFFFFFFFF);
                     break;
                 }
                 case Opcode::MULHU: {
-                    uint64_t result = static_cast<uint64_t>(getRegister(instr.r.rs1)) * static_cast<uint64_t>(getRegister(instr.r.rs2));
-                    setRegister(instr.r.rd, (result >> 32) & 0xFFFFFFFF);
+                    uint64_t result = static_cast<uint64_t>(getRegister(decoded.rs1)) * static_cast<uint64_t>(getRegister(decoded.rs2));
+                    setRegister(decoded.rd, (result >> 32) & 0xFFFFFFFF);
                     break;
                 }
                 case Opcode::MULHSU: {
-                    uint64_t result = SIGN_EXTEND(static_cast<int64_t>(getRegister(instr.r.rs1)), 32) * static_cast<uint64_t>(getRegister(instr.r.rs2));
-                    setRegister(instr.r.rd, (result >> 32) & 0xFFFFFFFF);
+                    uint64_t result = SIGN_EXTEND(static_cast<int64_t>(getRegister(decoded.rs1)), 32) * static_cast<uint64_t>(getRegister(decoded.rs2));
+                    setRegister(decoded.rd, (result >> 32) & 0xFFFFFFFF);
                     break;
                 }
                 case Opcode::DIV: {
-                    uint32_t dividend = getRegister(instr.r.rs1);
-                    uint32_t divisor = getRegister(instr.r.rs2);
+                    uint32_t dividend = getRegister(decoded.rs1);
+                    uint32_t divisor = getRegister(decoded.rs2);
 
                     // If dividend is most negative value and divisor is -1, result is dividend
                     if(dividend == 0x80000000 && divisor == 0xFFFFFFFF) {
-                        setRegister(instr.r.rd, dividend);
+                        setRegister(decoded.rd, dividend);
                     } else if(divisor != 0) {
-                        setRegister(instr.r.rd, static_cast<int32_t>(dividend) / static_cast<int32_t>(divisor));
+                        setRegister(decoded.rd, static_cast<int32_t>(dividend) / static_cast<int32_t>(divisor));
                     } else {
-                        setRegister(instr.r.rd, 0xFFFFFFFF); // result is -1 if division by zero
+                        setRegister(decoded.rd, 0xFFFFFFFF); // result is -1 if division by zero
                     }
                     break;
                 }
                 case Opcode::DIVU: {
-                    uint32_t divisor = getRegister(instr.r.rs2);
+                    uint32_t divisor = getRegister(decoded.rs2);
 
                     if(divisor != 0) {
-                        setRegister(instr.r.rd, getRegister(instr.r.rs1) / divisor);
+                        setRegister(decoded.rd, getRegister(decoded.rs1) / divisor);
                     } else {
-                        setRegister(instr.r.rd, 0xFFFFFFFF); // result is maximum unsigned value
+                        setRegister(decoded.rd, 0xFFFFFFFF); // result is maximum unsigned value
                     }
                     break;
                 }
                 case Opcode::REM: {
-                    uint32_t dividend = getRegister(instr.r.rs1);
-                    uint32_t divisor = getRegister(instr.r.rs2);
+                    uint32_t dividend = getRegister(decoded.rs1);
+                    uint32_t divisor = getRegister(decoded.rs2);
 
                     // If divident is most negative value and divisor is -1, result is zero
                     if(dividend == 0x80000000 && divisor == 0xFFFFFFFF) {
-                        setRegister(instr.r.rd, 0);
+                        setRegister(decoded.rd, 0);
                     } else if(divisor != 0) {
-                        setRegister(instr.r.rd, static_cast<int32_t>(dividend) % static_cast<int32_t>(divisor));
+                        setRegister(decoded.rd, static_cast<int32_t>(dividend) % static_cast<int32_t>(divisor));
                     } else {
-                        setRegister(instr.r.rd, dividend); // result is -1 if dividend
+                        setRegister(decoded.rd, dividend); // result is -1 if dividend
                     }
                     break;
                 }
                 case Opcode::REMU: {
-                    uint32_t dividend = getRegister(instr.r.rs1);
-                    uint32_t divisor = getRegister(instr.r.rs2);
+                    uint32_t dividend = getRegister(decoded.rs1);
+                    uint32_t divisor = getRegister(decoded.rs2);
 
                     if(divisor != 0) {
-                        setRegister(instr.r.rd, dividend % divisor);
+                        setRegister(decoded.rd, dividend % divisor);
                     } else {
-                        setRegister(instr.r.rd, dividend); // result is dividend
+                        setRegister(decoded.rd, dividend); // result is dividend
                     }
                     break;
                 }
+                case Opcode::SH1ADD: {
+                    setRegister(decoded.rd, (getRegister(decoded.rs1) << 1) + getRegister(decoded.rs2));
+                    break;
+                }
+                case Opcode::SH2ADD: {
+                    setRegister(decoded.rd, (getRegister(decoded.rs1) << 2) + getRegister(decoded.rs2));
+                    break;
+                }
+                case Opcode::SH3ADD: {
+                    setRegister(decoded.rd, (getRegister(decoded.rs1) << 3) + getRegister(decoded.rs2));
+                    break;
+                }
+                case Opcode::ANDN: {
+                    setRegister(decoded.rd, getRegister(decoded.rs1) & ~getRegister(decoded.rs2));
+                    break;
+                }
+                case Opcode::ORN: {
+                    setRegister(decoded.rd, getRegister(decoded.rs1) | ~getRegister(decoded.rs2));
+                    break;
+                }
+                case Opcode::XNOR: {
+                    setRegister(decoded.rd, ~(getRegister(decoded.rs1) ^ getRegister(decoded.rs2)));
+                    break;
+                }
+                case Opcode::MAX: {
+                    int32_t rs1Signed = getRegister(decoded.rs1);
+                    int32_t rs2Signed = getRegister(decoded.rs2);
+                    setRegister(decoded.rd, std::max(rs1Signed, rs2Signed));
+                    break;
+                }
+                case Opcode::MAXU: {
+                    setRegister(decoded.rd, std::max(getRegister(decoded.rs1), getRegister(decoded.rs2)));
+                    break;
+                }
+                case Opcode::MIN: {
+                    int32_t rs1Signed = getRegister(decoded.rs1);
+                    int32_t rs2Signed = getRegister(decoded.rs2);
+                    setRegister(decoded.rd, std::min(rs1Signed, rs2Signed));
+                    break;
+                }
+                case Opcode::MINU: {
+                    setRegister(decoded.rd, std::min(getRegister(decoded.rs1), getRegister(decoded.rs2)));
+                    break;
+                }
+                case Opcode::ZEXT_H: {
+                    setRegister(decoded.rd, getRegister(decoded.rs1) & 0xFFFF);
+                    break;
+                }
+                case Opcode::ROL: {
+                    setRegister(decoded.rd, rotateRight(getRegister(decoded.rs1), -getRegister(decoded.rs2)));
+                    break;
+                }
+                case Opcode::ROR: {
+                    setRegister(decoded.rd, rotateRight(getRegister(decoded.rs1), getRegister(decoded.rs2)));
+                    break;
+                }
+                case Opcode::BCLR: {
+                    setRegister(decoded.rd, getRegister(decoded.rs1) & ~(1u << (getRegister(decoded.rs2) & 0x1F)));
+                    break;
+                }
+                case Opcode::BEXT: {
+                    setRegister(decoded.rd, (getRegister(decoded.rs1) >> (getRegister(decoded.rs2) & 0x1F)) & 1);
+                    break;
+                }
+                case Opcode::BINV: {
+                    setRegister(decoded.rd, getRegister(decoded.rs1) ^ (1u << (getRegister(decoded.rs2) & 0x1F)));
+                    break;
+                }
+                case Opcode::BSET: {
+                    setRegister(decoded.rd, getRegister(decoded.rs1) | (1u << (getRegister(decoded.rs2) & 0x1F)));
+                    break;
+                }
             }
         }
         break;
         case InstructionType::SYSTEM: {
             bool skip = false;
-            switch(decodeOpcode(instr)) {
+            switch(opcode) {
                 case Opcode::SRET:
                     skip = true;
                     shouldIncrementPC = false;
@@ -455,16 +863,24 @@ void Hart::stepInstruction() {
                     csr.sstatus.spie = 1;
                     csr.sstatus.spp = 0; // set spp to user mode
                     pc = csr.sepc;
+                    updateInterruptPending();
+                    updateExecutionMode();
+
+                    // Linux points sscratch back at the task it returns to
+                    if(syscallTracer != nullptr && !supervisorMode) {
+                        syscallTracer->exit(csr.sscratch, gpr.a0, getInstret(), getCycle());
+                    }
                     break;
                 case Opcode::ECALL: {
                     skip = true;
 
-                    if(supervisorMode) {
+                    if(SUPERVISOR) {
                         // Handle SBI call here
                         switch(gpr.a7) {
                             case 0: // SBI_SET_TIMER
                                 timeCompare = (static_cast<uint64_t>(gpr.a1) << 32) | gpr.a0;
                                 csr.sip.stip = 0;
+                                updateInterruptPending();
                                 break;
                             case 1: // SBI_CONSOLE_PUTCHAR
                                 hartConfig.putCharCallback(static_cast<char>(gpr.a0));
@@ -476,19 +892,83 @@ void Hart::stepInstruction() {
                                 hartConfig.shutdownCallback();
                                 gpr.a0 = 0;
                                 break;
+                            case 0x10: { // SBI base extension
+                                SBIResult result = handleSBIBaseCall();
+                                gpr.a0 = static_cast<uint32_t>(result.error);
+                                gpr.a1 = result.value;
+                                break;
+                            }
+                            case SBI_EXT_PMU: {
+                                const uint32_t args[6] = { gpr.a0, gpr.a1, gpr.a2, gpr.a3, gpr.a4, gpr.a5 };
+                                PMUEventSources sources;
+                                sources.timingModel = timingModel != nullptr;
+                                if(memorySimulator != nullptr) {
+                                    sources.itlb = memorySimulator->getITLB().isEnabled();
+                                    sources.dtlb = memorySimulator->getDTLB().isEnabled();
+                                }
+                                syncTLBMisses();
+                                SBIResult result = pmu.handleSBICall(csr, gpr.a6, args, sources);
+                                gpr.a0 = static_cast<uint32_t>(result.error);
+                                gpr.a1 = result.value;
+                                updateExecutionMode();
+                                break;
+                            }
                             default:
-                                throw EmulatorException("Unknown SBI call " + std::to_string(gpr.a7));
+                                gpr.a0 = static_cast<uint32_t>(-2); // SBI_ERR_NOT_SUPPORTED
+                                break;
                         }
                     } else {
+                        if(syscallTracer != nullptr) {
+                            syscallTracer->enter(SyscallRecord {
+                                .entryInstret = getInstret(),
+                                .exitInstret = 0,
+                                .entryCycle = getCycle(),
+                                .exitCycle = 0,
+                                .satp = csr.satp.bits,
+                                .task = csr.sscratch,
+                                .pc = pc,
+                                .number = gpr.a7,
+                                .args = { gpr.a0, gpr.a1, gpr.a2, gpr.a3, gpr.a4, gpr.a5 },
+                                .result = 0,
+                                .completed = false,
+                            });
+                        }
+
                         handleException(ExceptionCode::U_ECALL_EXC, 0);
+
+                        // A user trap callback completes the call without leaving U-mode
+                        if(syscallTracer != nullptr && !supervisorMode) {
+                            syscallTracer->exit(csr.sscratch, gpr.a0, getInstret(), getCycle());
+                        }
                     }
                     break;
                 }
+                case Opcode::EBREAK:
+                    skip = true;
+                    // A debugger's breakpoint stops the hart before the ebreak retires
+                    if(debugger != nullptr && debugger->hitBreakpoint(instrPC)) {
+                        return;
+                    }
+                    handleException(ExceptionCode::BREAKPOINT, pc);
+                    break;
                 case Opcode::SFENCE_VMA:
+                case Opcode::SINVAL_VMA:
                 case Opcode::SFENCE_INVAL_IR:
                 case Opcode::SFENCE_W_INVAL:
+                    skip = true;
+                    if constexpr(INSTRUMENTED) {
+                        if(memorySimulator != nullptr) {
+                            memorySimulator->record(MemoryAccess { instrPC, 0, 0, MemoryAccess::Kind::TLB_FLUSH, PAGING });
+                        }
+                    }
+                    break;
                 case Opcode::WFI:
                     skip = true;
+                    // Nothing can happen until the timer fires, so go there directly
+                    if(hartConfig.skipIdleLoops && !interruptPending) {
+                        skipTime(UINT64_MAX);
+                    }
+                    break;
                 default:
                     break;
             }
@@ -497,141 +977,912 @@ void Hart::stepInstruction() {
                 break;
             }
 
-            uint32_t rs1Value = getRegister(instr.i.rs1);
-            uint32_t csrField = instr.i.imm_11_0;
+            const CSRDescriptor &descriptor = getCSRDescriptor(decoded.imm);
+            bool isImmediate = opcode == Opcode::CSRRWI || opcode == Opcode::CSRRSI || opcode == Opcode::CSRRCI;
+            bool isSwap = opcode == Opcode::CSRRW || opcode == Opcode::CSRRWI;
 
-            bool readcheck = !supervisorMode && csr.getAccessType(csrField) == CSRAccessType::SRW;
-            bool permissionCheck1 = csr.getAccessType(csrField) == CSRAccessType::URO;
-            bool permissionCheck2 = rs1Value != 0 && permissionCheck1;
+            // CSRRS/CSRRC with x0 (or a zero immediate) do not write, and CSRRW to x0 does not read
+            bool writes = isSwap || decoded.rs1 != 0;
+            bool reads = !isSwap || decoded.rd != 0;
+            uint32_t source = isImmediate ? decoded.rs1 : getRegister(decoded.rs1);
 
-            // SCOUNTEREN determines if U-mode can read cycle, time, instret
-            if(!supervisorMode) {
-                if((csr.scounteren.cy == 0) && (CSRAddress(csrField) == CSRAddress::CYCLE || CSRAddress(csrField) == CSRAddress::CYCLEH)) {
-                    handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
-                    break;   
-                }
-                if((csr.scounteren.tm == 0) && (CSRAddress(csrField) == CSRAddress::TIME || CSRAddress(csrField) == CSRAddress::TIMEH)) {
-                    handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
-                    break;   
-                }
-                if((csr.scounteren.ir == 0) && (CSRAddress(csrField) == CSRAddress::INSTRET || CSRAddress(csrField) == CSRAddress::INSTRETH)) {
-                    handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
-                    break;   
-                }
+            if(!isCSRAccessAllowed(descriptor, writes)) {
+                handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
+                break;
             }
 
-            if(readcheck) {
-                handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
-                break; 
+            if(reads && descriptor.counterEnableBit >= static_cast<int32_t>(PerformanceMonitor::FIRST_COUNTER)) {
+                syncTLBMisses();
             }
+            uint32_t oldValue = reads ? readCSR(descriptor) : 0;
 
-            setRegister(instr.i.rd, csr[csrField]);
+            if(hartConfig.skipIdleLoops) {
+                spinDetector.noteCSRAccess(decoded.imm, decoded.rd, writes);
+            }
 
-            switch(decodeOpcode(instr)) {
-                case Opcode::CSRRW:
-                    if(permissionCheck1){
-                       handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
-                       break; 
-                    }
-                    csr[csrField] = rs1Value;
-                    break;
-                case Opcode::CSRRS:
-                    if(permissionCheck2){
-                       handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
-                       break; 
-                    }
-                    csr[csrField] |= rs1Value;
-                    break;
-                case Opcode::CSRRC:
-                    if(permissionCheck2){
-                       handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
-                       break; 
-                    }
-                    csr[csrField] &= (~rs1Value);
-                    break;
-                case Opcode::CSRRWI:
-                    if(permissionCheck1){
-                       handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
-                       break; 
-                    }
-                    csr[csrField] = instr.i.rs1;
-                    break;
-                case Opcode::CSRRSI:
-                    if(permissionCheck2){
-                       handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
-                       break; 
-                    }
-                    csr[csrField] |= instr.i.rs1;
-                    break;
-                case Opcode::CSRRCI:
-                    if(permissionCheck2){
-                       handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
-                       break; 
-                    }
-                    csr[csrField] &= (~instr.i.rs1);
-                    break;
+            if(writes) {
+                if(isSwap) {
+                    writeCSR(descriptor, source);
+                } else if(opcode == Opcode::CSRRS || opcode == Opcode::CSRRSI) {
+                    writeCSR(descriptor, oldValue | source);
+                } else {
+                    writeCSR(descriptor, oldValue & ~source);
+                }
             }
+
+            setRegister(decoded.rd, oldValue);
             break;
         }
         case InstructionType::OP_UI: {
-            switch(decodeOpcode(instr)) {
+            switch(opcode) {
                 case Opcode::LUI:
-                    setRegister(instr.u.rd, instr.u.immediateValue());
+                    setRegister(decoded.rd, decoded.imm);
                     break;
                 case Opcode::AUIPC:
-                    setRegister(instr.u.rd, pc + instr.u.immediateValue());
+                    setRegister(decoded.rd, pc + decoded.imm);
                     break;
             }
             break;
         }
         case InstructionType::OP_FENCE:
             break;
-        default:
-            throw EmulatorException("Unknown instruction " + std::to_string(instr.bits));
-    }
-
-    if(shouldIncrementPC) {
-        pc += 4;
-    }
+        case InstructionType::LOAD_FP: {
+                if(csr.sstatus.fs == 0) {
+                    handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
+                    break;
+                }
 
-    incrementCounters();
-}
+                uint32_t effectiveAddr = getRegister(decoded.rs1) + decoded.imm;
+                bool isDouble = opcode == Opcode::FLD;
+                uint32_t accessSize = isDouble ? 8 : 4;
 
-void Hart::incrementCounters() {
-    auto currentTime = std::chrono::high_resolution_clock::now();
-    uint64_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(currentTime - lastTime).count();
+                uint32_t low = 0;
+                uint32_t high = 0xFFFFFFFF; // single precision values are NaN-boxed
+                if((effectiveAddr & (accessSize - 1)) != 0) {
+                    // Misaligned doubles are split into two words, either may fault
+                    uint32_t physAddr;
+                    uint32_t highPhysAddr;
+                    if(!hartConfig.emulateMisaligned) {
+                        handleException(ExceptionCode::LOAD_MISALIGNED_EXC, effectiveAddr);
+                        break;
+                    } else if(!loadMisaligned(effectiveAddr, 4, low, physAddr) || (isDouble && !loadMisaligned(effectiveAddr + 4, 4, high, highPhysAddr))) {
+                        break;
+                    }
 
-    if(duration >= timebasePeriod) {
-        uint64_t timerVal = (static_cast<uint64_t>(csr.timeh) << 32) | static_cast<uint64_t>(csr.time);
-        timerVal += (duration / timebasePeriod);
+                    if constexpr(INSTRUMENTED) {
+                        dataPhysAddr = physAddr;
+                        hasDataAccess = true;
+                    }
+                } else {
+                    if(!translateAddress<PAGING, SUPERVISOR>(effectiveAddr, MemoryAccessType::READ)) {
+                        handleException(ExceptionCode::LOAD_PAGE_FAULT_EXC, effectiveAddr);
+                        break;
+                    }
 
-        // csr.sip.stip = (timerVal >= timeCompare) ? 1 : 0;
-        if(timerVal >= timeCompare) {
-            csr.sip.stip = 1;
-        }
+                    if constexpr(INSTRUMENTED) {
+                        dataPhysAddr = effectiveAddr;
+                        hasDataAccess = true;
+                    }
 
-        csr.time = timerVal & 0xFFFFFFFF;
-        csr.timeh = timerVal >> 32;
+                    low = mem.readWord(effectiveAddr);
+                    if(isDouble) {
+                        high = mem.readWord(effectiveAddr + 4);
+                    }
+                }
 
-        lastTime = currentTime;
-    }
+                fpr.f[decoded.rd] = (static_cast<uint64_t>(high) << 32) | low;
+                csr.markFPDirty();
+            }
+            break;
+        case InstructionType::STORE_FP: {
+                if(csr.sstatus.fs == 0) {
+                    handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
+                    break;
+                }
 
-    if(csr.cycle == 0xFFFFFFFF) {
-        csr.cycleh++;
-    }
-    if(csr.instret == 0xFFFFFFFF) {
-        csr.instreth++;
-    }
-    csr.cycle++;
-    csr.instret++;
-}
+                uint32_t effectiveAddr = getRegister(decoded.rs1) + decoded.imm;
+                bool isDouble = opcode == Opcode::FSD;
+                uint32_t accessSize = isDouble ? 8 : 4;
+                uint64_t value = fpr.f[decoded.rs2];
 
-void Hart::handleException(ExceptionCode code, uint32_t stval) {
-    csr.sstatus.spp = supervisorMode;
-    csr.sstatus.spie = csr.sstatus.sie;
-    supervisorMode = true;
+                if((effectiveAddr & (accessSize - 1)) != 0) {
+                    uint32_t physAddr;
+                    uint32_t highPhysAddr;
+                    if(!hartConfig.emulateMisaligned) {
+                        handleException(ExceptionCode::STR_AMO_MISALIGNED_EXC, effectiveAddr);
+                    } else if(storeMisaligned(effectiveAddr, 4, value & 0xFFFFFFFF, physAddr)
+                        && (!isDouble || storeMisaligned(effectiveAddr + 4, 4, value >> 32, highPhysAddr))) {
+                        if constexpr(INSTRUMENTED) {
+                            dataPhysAddr = physAddr;
+                            hasDataAccess = true;
+                        }
+                    }
+                    break;
+                }
 
-    csr.sstatus.sie = 0; // Clear sie
+                if(!translateAddress<PAGING, SUPERVISOR>(effectiveAddr, MemoryAccessType::WRITE)) {
+                    handleException(ExceptionCode::STR_AMO_PAGE_FAULT_EXC, effectiveAddr);
+                    break;
+                }
+
+                if constexpr(INSTRUMENTED) {
+                    dataPhysAddr = effectiveAddr;
+                    hasDataAccess = true;
+                }
+
+                mem.writeWord(effectiveAddr, value & 0xFFFFFFFF);
+                if(isDouble) {
+                    mem.writeWord(effectiveAddr + 4, value >> 32);
+                }
+            }
+            break;
+        case InstructionType::OP_FP: {
+            if(csr.sstatus.fs == 0) {
+                handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
+                break;
+            }
+
+            uint64_t rs1 = readsIntegerRegister(opcode) ? getRegister(decoded.rs1) : fpr.f[decoded.rs1];
+            uint32_t rs3 = decoded.imm & 0x1F; // only set by the fused multiply-add instructions
+
+            FPResult result;
+            if(!executeFloatingPoint(decoded, csr.frm, rs1, fpr.f[decoded.rs2], fpr.f[rs3], result)) {
+                handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
+                break;
+            }
+
+            if(writesIntegerRegister(opcode)) {
+                setRegister(decoded.rd, result.value);
+            } else {
+                fpr.f[decoded.rd] = result.value;
+            }
+            csr.fflags |= result.flags;
+            csr.markFPDirty();
+            break;
+        }
+        case InstructionType::LOAD_V:
+        case InstructionType::STORE_V:
+            executeVectorMemory<PAGING, SUPERVISOR, INSTRUMENTED>(decoded, instrPC);
+            break;
+        case InstructionType::OP_V: {
+            if(csr.sstatus.vs == 0) {
+                handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
+                break;
+            }
+
+            VectorResult result;
+            if(!executeVector(decoded, vr, csr, getRegister(decoded.rs1), getRegister(decoded.rs2), result)) {
+                handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
+                break;
+            }
+
+            if(writesScalarRegister(opcode)) {
+                setRegister(decoded.rd, result.value);
+            }
+            if(result.saturated) {
+                csr.vxsat = 1;
+            }
+            csr.markVectorDirty();
+            break;
+        }
+        case InstructionType::INVALID:
+            handleException(ExceptionCode::INSTR_ILLEGAL_EXC, instr.bits);
+            break;
+    }
+
+    if(shouldIncrementPC) {
+        pc += decoded.length;
+    }
+
+    if(hartConfig.skipIdleLoops) {
+        trackIdleLoop(decoded, instrPC);
+    }
+
+    if constexpr(INSTRUMENTED) {
+        if(traceBuffer != nullptr) {
+            bool hasMemAddr = decoded.type == InstructionType::LOAD || decoded.type == InstructionType::STORE || decoded.type == InstructionType::AMO
+                || decoded.type == InstructionType::LOAD_FP || decoded.type == InstructionType::STORE_FP
+                || decoded.type == InstructionType::LOAD_V || decoded.type == InstructionType::STORE_V;
+            // Only integer results are traced
+            bool writesFloat = decoded.type == InstructionType::LOAD_FP || (decoded.type == InstructionType::OP_FP && !writesIntegerRegister(opcode));
+            bool isVector = decoded.type == InstructionType::LOAD_V || decoded.type == InstructionType::STORE_V
+                || (decoded.type == InstructionType::OP_V && !writesScalarRegister(opcode));
+            uint8_t rd = writesFloat || isVector ? 0 : decoded.rd;
+            traceBuffer->push(TraceRecord { getInstret(), instrPC, instr.bits, getRegister(rd), traceMemAddr, rd, hasMemAddr });
+        }
+
+        bool isLoad = decoded.type == InstructionType::LOAD || decoded.type == InstructionType::LOAD_FP || opcode == Opcode::LR_W;
+        if(memorySimulator != nullptr) {
+            memorySimulator->record(MemoryAccess { instrPC, instrPC, pcPhysicalAddr, MemoryAccess::Kind::FETCH, PAGING });
+            if(hasDataAccess) {
+                MemoryAccess::Kind kind = isLoad ? MemoryAccess::Kind::LOAD : MemoryAccess::Kind::STORE;
+                memorySimulator->record(MemoryAccess { instrPC, traceMemAddr, dataPhysAddr, kind, PAGING });
+            }
+        }
+
+        if(debugger != nullptr && hasDataAccess) {
+            // AMOs other than LR read and write
+            bool reads = isLoad || decoded.type == InstructionType::AMO;
+            debugger->checkWatchpoints(traceMemAddr, getDataAccessSize(decoded), reads, !isLoad);
+        }
+
+        uint32_t cycles = 1;
+        bool mispredicted = false;
+        if(timingModel != nullptr) {
+            uint64_t mispredicts = timingModel->getStats().mispredicts;
+            cycles = timingModel->retire(decoded, instrPC, pc);
+            mispredicted = timingModel->getStats().mispredicts != mispredicts;
+            addCycles(cycles);
+        }
+
+        if(blockProfiler != nullptr) {
+            blockProfiler->retire(instrPC, pc, decoded.length);
+        }
+
+        if(countingEvents && pmu.isActive()) {
+            countPerformanceEvents(decoded, SUPERVISOR, cycles, mispredicted);
+        }
+
+        // Returns to the uninstrumented loop once the last trigger fired
+        if(bootTimeline != nullptr && bootTimeline->watchesPC() && bootTimeline->checkPC(instrPC, getInstret())) {
+            updateExecutionMode();
+        }
+    }
+
+    incrementCounters();
+}
+
+template<bool PAGING, bool SUPERVISOR, bool INSTRUMENTED>
+void Hart::executeVectorMemory(const DecodedInstruction &decoded, uint32_t instrPC) {
+    VectorMemoryAccess access;
+    if(csr.sstatus.vs == 0 || !getVectorMemoryAccess(decoded, csr, getRegister(decoded.rs2), access)) {
+        handleException(ExceptionCode::INSTR_ILLEGAL_EXC, decoded.instr.bits);
+        return;
+    }
+
+    bool isLoad = decoded.type == InstructionType::LOAD_V;
+    MemoryAccessType accessType = isLoad ? MemoryAccessType::READ : MemoryAccessType::WRITE;
+    ExceptionCode misaligned = isLoad ? ExceptionCode::LOAD_MISALIGNED_EXC : ExceptionCode::STR_AMO_MISALIGNED_EXC;
+    ExceptionCode pageFault = isLoad ? ExceptionCode::LOAD_PAGE_FAULT_EXC : ExceptionCode::STR_AMO_PAGE_FAULT_EXC;
+
+    uint8_t *group = vr.get(decoded.rd, csr.vlenb);
+    uint32_t base = getRegister(decoded.rs1);
+    uint32_t size = access.elementSize;
+
+    // Aligned elements never cross a page, so one translation serves all elements on the same page
+    uint32_t cachedPage = 1; // never page aligned
+    uint32_t cachedPhysPage = 0;
+
+    // The elements before a fault stay written, execution resumes at vstart after the trap
+    csr.markVectorDirty();
+    for(uint32_t i = csr.vstart; i < access.count; ++i) {
+        if(access.masked && !vr.isActive(i)) {
+            continue;
+        }
+
+        uint32_t addr = base + i * access.stride;
+        uint8_t *element = group + i * size;
+
+        if((addr & (size - 1)) != 0) {
+            if(!hartConfig.emulateMisaligned) {
+                csr.vstart = i;
+                handleException(misaligned, addr);
+                return;
+            }
+
+            uint32_t firstPhysAddr = 0;
+            for(uint32_t offset = 0; offset < size; offset += 4) {
+                uint32_t chunk = std::min(size - offset, 4u);
+                uint32_t value = 0;
+                uint32_t physAddr;
+                if(isLoad) {
+                    if(!loadMisaligned(addr + offset, chunk, value, physAddr)) {
+                        csr.vstart = i;
+                        return;
+                    }
+                    std::memcpy(element + offset, &value, chunk);
+                } else {
+                    std::memcpy(&value, element + offset, chunk);
+                    if(!storeMisaligned(addr + offset, chunk, value, physAddr)) {
+                        csr.vstart = i;
+                        return;
+                    }
+                }
+                if(offset == 0) {
+                    firstPhysAddr = physAddr;
+                }
+            }
+
+            if constexpr(INSTRUMENTED) {
+                if(memorySimulator != nullptr) {
+                    MemoryAccess::Kind kind = isLoad ? MemoryAccess::Kind::LOAD : MemoryAccess::Kind::STORE;
+                    memorySimulator->record(MemoryAccess { instrPC, addr, firstPhysAddr, kind, PAGING });
+                }
+            }
+            continue;
+        }
+
+        uint32_t page = addr & ~(PAGE_SIZE - 1);
+        if(page != cachedPage) {
+            uint32_t physPage = page;
+            if(!translateAddress<PAGING, SUPERVISOR>(physPage, accessType)) {
+                csr.vstart = i;
+                handleException(pageFault, addr);
+                return;
+            }
+            cachedPage = page;
+            cachedPhysPage = physPage;
+        }
+
+        uint32_t physAddr = cachedPhysPage | (addr & (PAGE_SIZE - 1));
+        if(isLoad) {
+            readElement(mem, physAddr, size, element);
+        } else {
+            writeElement(mem, physAddr, size, element);
+        }
+
+        if constexpr(INSTRUMENTED) {
+            if(memorySimulator != nullptr) {
+                MemoryAccess::Kind kind = isLoad ? MemoryAccess::Kind::LOAD : MemoryAccess::Kind::STORE;
+                memorySimulator->record(MemoryAccess { instrPC, addr, physAddr, kind, PAGING });
+            }
+        }
+    }
+    csr.vstart = 0;
+}
+
+bool Hart::translateSplitAccess(uint32_t addr, uint32_t size, MemoryAccessType accessType, uint32_t (&physAddrs)[4]) {
+    ExceptionCode pageFault = (accessType == MemoryAccessType::WRITE) ? ExceptionCode::STR_AMO_PAGE_FAULT_EXC : ExceptionCode::LOAD_PAGE_FAULT_EXC;
+    uint32_t nextPage = (addr & ~(PAGE_SIZE - 1)) + PAGE_SIZE;
+    bool crossesPage = (addr & (PAGE_SIZE - 1)) + size > PAGE_SIZE;
+
+    // Both pages are probed before any byte or PTE is written so a fault on the second page leaves memory untouched
+    uint32_t firstPhysAddr = addr;
+    if(!translateAddress(firstPhysAddr, accessType, false)) {
+        handleException(pageFault, addr);
+        return false;
+    }
+
+    uint32_t secondPhysAddr = nextPage;
+    if(crossesPage && !translateAddress(secondPhysAddr, accessType, false)) {
+        handleException(pageFault, nextPage);
+        return false;
+    }
+
+    // Walk again to set the A and D bits now that the access can no longer fault
+    firstPhysAddr = addr;
+    secondPhysAddr = nextPage;
+    translateAddress(firstPhysAddr, accessType);
+    if(crossesPage) {
+        translateAddress(secondPhysAddr, accessType);
+    }
+
+    for(uint32_t i = 0; i < size; ++i) {
+        uint32_t byteAddr = addr + i;
+        physAddrs[i] = (crossesPage && byteAddr - nextPage < size) ? secondPhysAddr + (byteAddr - nextPage) : firstPhysAddr + i;
+    }
+    return true;
+}
+
+bool Hart::loadMisaligned(uint32_t addr, uint32_t size, uint32_t &value, uint32_t &physAddr) {
+    uint32_t physAddrs[4];
+    if(!translateSplitAccess(addr, size, MemoryAccessType::READ, physAddrs)) {
+        return false;
+    }
+    physAddr = physAddrs[0];
+
+    value = 0;
+    for(uint32_t i = 0; i < size; ++i) {
+        value |= static_cast<uint32_t>(mem.readByte(physAddrs[i])) << (8 * i);
+    }
+    return true;
+}
+
+bool Hart::storeMisaligned(uint32_t addr, uint32_t size, uint32_t value, uint32_t &physAddr) {
+    uint32_t physAddrs[4];
+    if(!translateSplitAccess(addr, size, MemoryAccessType::WRITE, physAddrs)) {
+        return false;
+    }
+    physAddr = physAddrs[0];
+
+    for(uint32_t i = 0; i < size; ++i) {
+        mem.writeByte(physAddrs[i], (value >> (8 * i)) & 0xFF);
+    }
+    return true;
+}
+
+void Hart::incrementCounters() {
+    // The host clock is only sampled periodically for the timer, reads of time sync it exactly
+    if(hartConfig.timeSource == TimeSource::HOST_CLOCK && (csr.instret & TIME_SYNC_MASK) == 0) {
+        syncTime();
+    } else if(hartConfig.timeSource == TimeSource::INSTRET && --unitsUntilTick == 0) {
+        unitsUntilTick = hartConfig.instructionsPerTick;
+        advanceTime(1);
+    } else if(hartConfig.timeSource == TimeSource::CYCLE && timingModel == nullptr) {
+        countTicks(1);
+    }
+
+    if(csr.instret == 0xFFFFFFFF) {
+        csr.instreth++;
+    }
+    csr.instret++;
+}
+
+void Hart::countPerformanceEvents(const DecodedInstruction &decoded, bool supervisor, uint32_t cycles, bool mispredicted) {
+    // Vector loads and stores count once per instruction, not per element
+    bool isLoad = decoded.type == InstructionType::LOAD || decoded.type == InstructionType::LOAD_FP
+        || decoded.type == InstructionType::LOAD_V || decoded.opcode == Opcode::LR_W;
+    bool isStore = decoded.type == InstructionType::STORE || decoded.type == InstructionType::STORE_FP
+        || decoded.type == InstructionType::STORE_V || (decoded.type == InstructionType::AMO && decoded.opcode != Opcode::LR_W);
+
+    PMUEventCounts events;
+    events[PMUEvent::CYCLES] = cycles;
+    events[PMUEvent::INSTRUCTIONS] = 1;
+    events[PMUEvent::LOADS] = isLoad;
+    events[PMUEvent::STORES] = isStore;
+    events[PMUEvent::BRANCHES] = decoded.type == InstructionType::BRANCH || decoded.type == InstructionType::JUMP;
+    events[PMUEvent::BRANCH_MISSES] = mispredicted;
+    addTLBMisses(events);
+
+    if(pmu.count(csr, events, supervisor)) {
+        csr.sip.lcofip = 1;
+        updateInterruptPending();
+    }
+}
+
+void Hart::addTLBMisses(PMUEventCounts &events) {
+    if(memorySimulator == nullptr) {
+        return;
+    }
+
+    MemoryHierarchySimulator::TLBMisses misses = memorySimulator->getTLBMisses();
+    events[PMUEvent::ITLB_MISSES] = misses.fetches - countedTLBMisses.fetches;
+    events[PMUEvent::DTLB_LOAD_MISSES] = misses.loads - countedTLBMisses.loads;
+    events[PMUEvent::DTLB_STORE_MISSES] = misses.stores - countedTLBMisses.stores;
+    countedTLBMisses = misses;
+}
+
+void Hart::syncTLBMisses() {
+    if(memorySimulator == nullptr) {
+        return;
+    }
+
+    // Misses while no counter runs are dropped
+    memorySimulator->flush();
+    PMUEventCounts events;
+    addTLBMisses(events);
+    if(pmu.isActive() && pmu.count(csr, events, supervisorMode)) {
+        csr.sip.lcofip = 1;
+        updateInterruptPending();
+    }
+}
+
+void Hart::countTrap() {
+    if(!pmu.isActive()) {
+        return;
+    }
+
+    PMUEventCounts events;
+    events[PMUEvent::TRAPS] = 1;
+    if(pmu.count(csr, events, supervisorMode)) {
+        csr.sip.lcofip = 1;
+    }
+}
+
+SBIResult Hart::handleSBIBaseCall() {
+    constexpr uint32_t SPEC_VERSION = 0x3; // v0.3, the first with the PMU extension
+    constexpr uint32_t IMPLEMENTATION_ID = 0x52563332; // unregistered, "RV32"
+
+    switch(gpr.a6) {
+        case 0: // get_spec_version
+            return SBIResult { 0, SPEC_VERSION };
+        case 1: // get_impl_id
+            return SBIResult { 0, IMPLEMENTATION_ID };
+        case 3: // probe_extension
+            switch(gpr.a0) {
+                case 0:
+                case 1:
+                case 2:
+                case 8:
+                case 0x10:
+                case SBI_EXT_PMU:
+                    return SBIResult { 0, 1 };
+                default:
+                    return SBIResult { 0, 0 };
+            }
+        case 2: // get_impl_version
+        case 4: // get_mvendorid
+        case 5: // get_marchid
+        case 6: // get_mimpid
+            return SBIResult { 0, 0 };
+        default:
+            return SBIResult { -2, 0 }; // SBI_ERR_NOT_SUPPORTED
+    }
+}
+
+void Hart::addCycles(uint32_t cycles) {
+    uint64_t cycle = ((static_cast<uint64_t>(csr.cycleh) << 32) | csr.cycle) + cycles;
+    csr.cycle = cycle & 0xFFFFFFFF;
+    csr.cycleh = cycle >> 32;
+
+    if(hartConfig.timeSource == TimeSource::CYCLE) {
+        countTicks(cycles);
+    }
+}
+
+void Hart::countTicks(uint32_t units) {
+    if(units < unitsUntilTick) {
+        unitsUntilTick -= units;
+        return;
+    }
+
+    units -= unitsUntilTick;
+    unitsUntilTick = hartConfig.instructionsPerTick - units % hartConfig.instructionsPerTick;
+    advanceTime(1 + units / hartConfig.instructionsPerTick);
+}
+
+const Hart::DecodeCacheEntry& Hart::lookupDecodeCache(uint32_t pcPhysicalAddr, Instruction instr) {
+    DecodeCacheEntry &entry = decodeCache[(pcPhysicalAddr >> 1) & (DECODE_CACHE_SIZE - 1)];
+    if(entry.physAddr == pcPhysicalAddr && entry.first.instr.bits == instr.bits) {
+        return entry;
+    }
+
+    entry.physAddr = pcPhysicalAddr;
+    entry.first = decode(instr);
+    entry.fusion = FusionKind::NONE;
+
+    // Only pair with an instruction on the same page, so fetching it can never fault
+    uint32_t secondOffset = (pcPhysicalAddr & (PAGE_SIZE - 1)) + entry.first.length;
+    if(secondOffset <= PAGE_SIZE - 4 && isFusionHead(entry.first.opcode)) {
+        entry.second = decode(Instruction { mem.readWord(pcPhysicalAddr + entry.first.length) });
+        entry.fusion = detectFusion(entry.first, entry.second);
+    }
+
+    return entry;
+}
+
+bool Hart::executeFused(const DecodeCacheEntry &entry) {
+    const DecodedInstruction &first = entry.first;
+    const DecodedInstruction &second = entry.second;
+
+    // The second instruction may have been rewritten since the pair was cached
+    uint32_t secondBits = mem.readWord(entry.physAddr + first.length);
+    if(second.length == 2) {
+        secondBits &= 0xFFFF;
+    }
+    if(secondBits != second.instr.bits) {
+        decodeCache[(entry.physAddr >> 1) & (DECODE_CACHE_SIZE - 1)].physAddr = DECODE_CACHE_INVALID;
+        return false;
+    }
+
+    uint32_t secondPC = pc + first.length;
+    uint32_t nextPC = secondPC + second.length;
+
+    switch(entry.fusion) {
+        case FusionKind::LUI_ADDI:
+            setRegister(first.rd, first.imm + second.imm);
+            break;
+        case FusionKind::AUIPC_ADDI:
+            setRegister(first.rd, pc + first.imm + second.imm);
+            break;
+        case FusionKind::AUIPC_JALR: {
+                uint32_t base = pc + first.imm;
+                setRegister(first.rd, base);
+                setRegister(second.rd, nextPC);
+                nextPC = (base + second.imm) & ~1u;
+            }
+            break;
+        case FusionKind::SLLI_SRLI:
+            setRegister(first.rd, (getRegister(first.rs1) << (first.imm & 0x1F)) >> (second.imm & 0x1F));
+            break;
+        case FusionKind::COMPARE_BRANCH: {
+                uint32_t lhs = getRegister(first.rs1);
+                bool isImmediate = first.opcode == Opcode::SLTI || first.opcode == Opcode::SLTIU;
+                uint32_t rhs = isImmediate ? first.imm : getRegister(first.rs2);
+                bool isSigned = first.opcode == Opcode::SLT || first.opcode == Opcode::SLTI;
+                uint32_t result = isSigned ? static_cast<int32_t>(lhs) < static_cast<int32_t>(rhs) : lhs < rhs;
+                setRegister(first.rd, result);
+
+                bool taken = (second.opcode == Opcode::BNE) == (result != 0);
+                if(taken) {
+                    nextPC = secondPC + second.imm;
+                }
+            }
+            break;
+        default:
+            return false;
+    }
+
+    uint32_t firstPC = pc;
+    pc = nextPC;
+    if(hartConfig.skipIdleLoops) {
+        trackIdleLoop(first, firstPC);
+        trackIdleLoop(second, secondPC);
+    }
+    fusionStats.counts[static_cast<size_t>(entry.fusion)]++;
+    return true;
+}
+
+void Hart::trackIdleLoop(const DecodedInstruction &decoded, uint32_t instrPC) {
+    switch(decoded.type) {
+        case InstructionType::LOAD:
+        case InstructionType::OP_IMM:
+        case InstructionType::OP:
+        case InstructionType::OP_UI:
+            spinDetector.noteRegisterWrite(decoded.rd, decoded.rs1, decoded.rs2);
+            break;
+        case InstructionType::LOAD_FP:
+        case InstructionType::OP_FP:
+        case InstructionType::LOAD_V:
+        case InstructionType::OP_V:
+            // Values that pass through the FP or vector registers are not followed
+            spinDetector.noteRegisterWrite(decoded.rd, 0, 0);
+            break;
+        case InstructionType::STORE:
+        case InstructionType::STORE_FP:
+        case InstructionType::STORE_V:
+        case InstructionType::AMO:
+            spinDetector.noteSideEffect();
+            break;
+        case InstructionType::SYSTEM:
+            // CSR accesses are reported separately
+            if(getDescriptor(decoded.opcode).format != InstructionFormat::CSR) {
+                spinDetector.noteSideEffect();
+            }
+            break;
+        case InstructionType::BRANCH:
+        case InstructionType::JUMP:
+            if(decoded.type == InstructionType::JUMP) {
+                spinDetector.noteRegisterWrite(decoded.rd, 0, 0);
+            }
+            if(decoded.opcode == Opcode::JALR || pc >= instrPC) {
+                break;
+            }
+
+            switch(spinDetector.onBackwardBranch(instrPC, pc, gpr.r, getInstret())) {
+                case SpinDetector::LoopKind::MEMORY_POLL:
+                    skipTime(UINT64_MAX);
+                    break;
+                case SpinDetector::LoopKind::TIME_POLL:
+                    skipTime(spinDetector.nextTimeStep());
+                    break;
+                case SpinDetector::LoopKind::NONE:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void Hart::skipTime(uint64_t maxTicks) {
+    uint64_t now = (static_cast<uint64_t>(csr.timeh) << 32) | csr.time;
+    uint64_t ticks = maxTicks;
+
+    // Never skip past the next timer deadline
+    if(timeCompare > now) {
+        ticks = std::min(ticks, timeCompare - now);
+    } else if(maxTicks == UINT64_MAX) {
+        return;
+    }
+
+    advanceTime(ticks);
+}
+
+void Hart::syncTime() {
+    auto currentTime = std::chrono::high_resolution_clock::now();
+    uint64_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(currentTime - lastTime).count();
+
+    if(duration >= timebasePeriod) {
+        advanceTime(duration / timebasePeriod);
+        lastTime += std::chrono::nanoseconds((duration / timebasePeriod) * timebasePeriod);
+    }
+}
+
+void Hart::resetTickCountdown() {
+    if(hartConfig.timeSource != TimeSource::INSTRET && hartConfig.timeSource != TimeSource::CYCLE) {
+        return;
+    }
+
+    // Keep ticks on multiples of instructionsPerTick so the timeline only depends on instret or cycle
+    uint64_t units = hartConfig.timeSource == TimeSource::CYCLE ? getCycle() : getInstret();
+    unitsUntilTick = hartConfig.instructionsPerTick - units % hartConfig.instructionsPerTick;
+}
+
+uint64_t Hart::getTime() {
+    if(hartConfig.timeSource == TimeSource::HOST_CLOCK) {
+        syncTime();
+    }
+    return (static_cast<uint64_t>(csr.timeh) << 32) | csr.time;
+}
+
+bool Hart::isCSRAccessAllowed(const CSRDescriptor &descriptor, bool writes) const {
+    switch(descriptor.accessType) {
+        case CSRAccessType::URW:
+            return true;
+        case CSRAccessType::URO:
+            if(writes) {
+                return false;
+            }
+            // SCOUNTEREN determines if U-mode can read the counters
+            if(!supervisorMode && descriptor.counterEnableBit >= 0) {
+                return ((csr.scounteren.bits >> descriptor.counterEnableBit) & 1) != 0;
+            }
+            return true;
+        case CSRAccessType::SRW:
+            return supervisorMode;
+        case CSRAccessType::SRO:
+            return supervisorMode && !writes;
+        case CSRAccessType::FRW:
+            return csr.sstatus.fs != 0;
+        case CSRAccessType::VRW:
+            return csr.sstatus.vs != 0;
+        case CSRAccessType::VRO:
+            return !writes && csr.sstatus.vs != 0;
+        case CSRAccessType::INVALID:
+            break;
+    }
+    return false;
+}
+
+uint32_t Hart::readCSR(const CSRDescriptor &descriptor) {
+    uint32_t value = descriptor.storage(csr);
+    if(descriptor.readHook != nullptr) {
+        value = descriptor.readHook(*this, value);
+    }
+    return value;
+}
+
+void Hart::writeCSR(const CSRDescriptor &descriptor, uint32_t value) {
+    uint32_t &storage = descriptor.storage(csr);
+    storage = (storage & ~descriptor.writeMask) | (value & descriptor.writeMask);
+    if(descriptor.writeHook != nullptr) {
+        descriptor.writeHook(*this);
+    }
+}
+
+void Hart::advanceTime(uint64_t ticks) {
+    uint64_t timerVal = (static_cast<uint64_t>(csr.timeh) << 32) | static_cast<uint64_t>(csr.time);
+    timerVal += ticks;
+
+    // csr.sip.stip = (timerVal >= timeCompare) ? 1 : 0;
+    if(timerVal >= timeCompare && csr.sip.stip == 0) {
+        csr.sip.stip = 1;
+        updateInterruptPending();
+    }
+
+    csr.time = timerVal & 0xFFFFFFFF;
+    csr.timeh = timerVal >> 32;
+}
+
+RV32::HartState Hart::getState() const {
+    return HartState {
+        .gpr = gpr,
+        .fpr = fpr,
+        .vr = vr,
+        .csr = csr,
+        .pc = pc,
+        .timeCompare = timeCompare,
+        .pmu = pmu,
+        .supervisorMode = supervisorMode,
+        .reservationSetValid = reservationSetValid,
+    };
+}
+
+void Hart::setState(const HartState& state) {
+    gpr = state.gpr;
+    fpr = state.fpr;
+    vr = state.vr;
+    csr = state.csr;
+    pc = state.pc;
+    timeCompare = state.timeCompare;
+    pmu = state.pmu;
+    supervisorMode = state.supervisorMode;
+    reservationSetValid = state.reservationSetValid;
+    updateInterruptPending();
+    updateExecutionMode();
+    resetTickCountdown();
+}
+
+bool Hart::peekInstruction(uint32_t virtualAddr, uint32_t &bits) {
+    uint32_t addr = virtualAddr;
+    if(!translateAddress(addr, MemoryAccessType::EXECUTE, false)) {
+        return false;
+    }
+    bits = mem.readHalfword(addr);
+    if(isCompressed(bits)) {
+        return true;
+    }
+
+    uint32_t upperAddr = addr + 2;
+    if((addr & (PAGE_SIZE - 1)) == PAGE_SIZE - 2) {
+        upperAddr = virtualAddr + 2;
+        if(!translateAddress(upperAddr, MemoryAccessType::EXECUTE, false)) {
+            return false;
+        }
+    }
+    bits |= static_cast<uint32_t>(mem.readHalfword(upperAddr)) << 16;
+    return true;
+}
+
+bool Hart::translateDebugAddress(uint32_t &addr) {
+    if(csr.satp.mode == 0) {
+        return true;
+    }
+
+    // Walk as supervisor mode with SUM and MXR set, which may read every valid page
+    uint32_t sstatus = csr.sstatus.bits;
+    csr.sstatus.sum = 1;
+    csr.sstatus.mxr = 1;
+    bool translated = translateAddress<true, true>(addr, MemoryAccessType::READ, false);
+    csr.sstatus.bits = sstatus;
+    return translated;
+}
+
+bool Hart::readDebugMemory(uint32_t virtualAddr, uint8_t &value) {
+    uint32_t addr = virtualAddr;
+    try {
+        if(!translateDebugAddress(addr)) {
+            return false;
+        }
+        value = mem.readByte(addr);
+    } catch(EmulatorException &ee) {
+        return false;
+    }
+    return true;
+}
+
+bool Hart::writeDebugMemory(uint32_t virtualAddr, uint8_t value) {
+    uint32_t addr = virtualAddr;
+    try {
+        if(!translateDebugAddress(addr)) {
+            return false;
+        }
+        mem.writeByte(addr, value);
+    } catch(EmulatorException &ee) {
+        return false;
+    }
+    return true;
+}
+
+bool Hart::readDebugCSR(uint32_t addr, uint32_t &value) {
+    const CSRDescriptor &descriptor = getCSRDescriptor(addr);
+    if(addr >= NUM_CSRS || descriptor.storage == nullptr) {
+        return false;
+    }
+    value = readCSR(descriptor);
+    return true;
+}
+
+bool Hart::writeDebugCSR(uint32_t addr, uint32_t value) {
+    const CSRDescriptor &descriptor = getCSRDescriptor(addr);
+    if(addr >= NUM_CSRS || descriptor.storage == nullptr) {
+        return false;
+    }
+    writeCSR(descriptor, value);
+    updateInterruptPending();
+    updateExecutionMode();
+    return true;
+}
+
+void Hart::handleException(ExceptionCode code, uint32_t stval) {
+    spinDetector.reset();
+
+    if(timingModel != nullptr) {
+        addCycles(timingModel->getTrapPenalty());
+    }
+
+    if(!supervisorMode && hartConfig.userTrapCallback && hartConfig.userTrapCallback(*this, static_cast<uint32_t>(code), stval)) {
+        return;
+    }
+    countTrap();
+
+    csr.sstatus.spp = supervisorMode;
+    csr.sstatus.spie = csr.sstatus.sie;
+    supervisorMode = true;
+
+    csr.sstatus.sie = 0; // Clear sie
+    interruptPending = false;
 
     // Write to sepc
     csr.sepc = pc;
@@ -648,6 +1899,14 @@ void Hart::handleException(ExceptionCode code, uint32_t stval) {
     // Set the PC
     pc = (csr.stvec.base << 2);
     shouldIncrementPC = false;
+    updateExecutionMode();
+}
+
+void Hart::updateInterruptPending() {
+    constexpr uint32_t SUPERVISOR_INTERRUPTS = 0x2222; // SSIP, STIP, SEIP and LCOFIP
+
+    bool enabled = !supervisorMode || csr.sstatus.sie == 1;
+    interruptPending = enabled && (csr.sip.bits & csr.sie.bits & SUPERVISOR_INTERRUPTS) != 0;
 }
 
 void Hart::handleInterrupts() {
@@ -661,17 +1920,28 @@ void Hart::handleInterrupts() {
         }
         else if((csr.sip.seip & csr.sie.seie) != 0) {
             csr.scause.exceptionCode = 9; // supervisor external interrupt
+        }
+        else if((csr.sip.lcofip & csr.sie.lcofie) != 0) {
+            csr.scause.exceptionCode = 13; // local counter overflow interrupt
         } else {
             // If the interrupt(s) that are pending do not match the 
             // enabled interrupt(s), do not service the interrupt 
             return;
         }
 
+        spinDetector.reset();
+
+        if(timingModel != nullptr) {
+            addCycles(timingModel->getTrapPenalty());
+        }
+        countTrap();
+
         csr.sstatus.spp = supervisorMode;
         csr.sstatus.spie = csr.sstatus.sie;
         supervisorMode = true;
 
         csr.sstatus.sie = 0; // Clear sie
+        interruptPending = false;
 
         // Write to sepc
         csr.sepc = pc;
@@ -688,22 +1958,32 @@ void Hart::handleInterrupts() {
         if(csr.stvec.mode == 1) {
             pc += 4 * csr.scause.exceptionCode;
         }
+        updateExecutionMode();
     }
 }
 
-bool Hart::translateAddress(uint32_t &addr, MemoryAccessType accessType) {
-    // Check if Sv32 paging is enabled
+bool Hart::translateAddress(uint32_t &addr, MemoryAccessType accessType, bool updatePTE) {
     if(csr.satp.mode == 0) {
         return true;
     }
-    
+    return supervisorMode ? translateAddress<true, true>(addr, accessType, updatePTE) : translateAddress<true, false>(addr, accessType, updatePTE);
+}
+
+template<bool PAGING, bool SUPERVISOR>
+bool Hart::translateAddress(uint32_t &addr, MemoryAccessType accessType, bool updatePTE) {
+    // Without Sv32 paging virtual addresses are physical addresses
+    if constexpr(!PAGING) {
+        return true;
+    }
+
     Sv32PTE pte {};
     Sv32VirtualAddr vAddr = {addr};
     Sv32PhysAddr result {};
     uint64_t base = csr.satp.ppn * PAGE_SIZE;
 
-    for(uint32_t i = 1; i >= 0; --i) {
-        pte.bits = mem.readWord(base + (i == 0 ? vAddr.vpn0 : vAddr.vpn1) * PTE_SIZE);
+    for(int32_t i = 1; i >= 0; --i) {
+        uint32_t pteAddr = base + (i == 0 ? vAddr.vpn0 : vAddr.vpn1) * PTE_SIZE;
+        pte.bits = mem.readWord(pteAddr);
 
         if(pte.v == 0 || (pte.r == 0 && pte.w == 1)) {
             return false;
@@ -711,7 +1991,7 @@ bool Hart::translateAddress(uint32_t &addr, MemoryAccessType accessType) {
 
         if(pte.r == 1 || pte.x == 1) {
             // U bit must be set for user mode software
-            if(!supervisorMode && pte.u == 0) {
+            if(!SUPERVISOR && pte.u == 0) {
                 return false;
             }
             // Check write and execute permissions
@@ -723,20 +2003,24 @@ bool Hart::translateAddress(uint32_t &addr, MemoryAccessType accessType) {
                 return false;
             }
             // Supervisor mode may not execute user pages
-            if(accessType == MemoryAccessType::EXECUTE && supervisorMode && pte.u == 1) {
+            if(accessType == MemoryAccessType::EXECUTE && SUPERVISOR && pte.u == 1) {
                 return false;
             }
             // Check SUM bit to determine if supervisor mode can read/write user pages
-            if((accessType != MemoryAccessType::EXECUTE) && supervisorMode && pte.u == 1 && csr.sstatus.sum == 0) {
+            if((accessType != MemoryAccessType::EXECUTE) && SUPERVISOR && pte.u == 1 && csr.sstatus.sum == 0) {
                 return false;
             }
             // Check for misaligned superpage
             if(i == 1 && pte.ppn0 != 0) {
                 return false;
             }
-            // Signal page fault to hardware for A and D bits
-            if(pte.a == 0 || (accessType == MemoryAccessType::WRITE && pte.d == 0)) {
-                return false;
+            // Svadu: set the A and D bits in the PTE instead of raising a page fault
+            if(updatePTE && (pte.a == 0 || (accessType == MemoryAccessType::WRITE && pte.d == 0))) {
+                pte.a = 1;
+                if(accessType == MemoryAccessType::WRITE) {
+                    pte.d = 1;
+                }
+                mem.writeWord(pteAddr, pte.bits);
             }
             
             result.pageOffset = vAddr.pageOffset;
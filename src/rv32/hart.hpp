@@ -3,7 +3,21 @@
 
 #include "mem_map_manager.hpp"
 #include "csr.hpp"
+#include "decoder.hpp"
+#include "fpu.hpp"
+#include "vector.hpp"
+#include "fusion.hpp"
+#include "spin_detector.hpp"
+#include "trace.hpp"
+#include "cache_sim.hpp"
+#include "timing_model.hpp"
+#include "bbv.hpp"
+#include "pmu.hpp"
+#include "syscall_trace.hpp"
+#include "boot_timeline.hpp"
 #include <chrono>
+#include <functional>
+#include <memory>
 
 namespace RV32 {
     union Registers {
@@ -53,15 +67,57 @@ namespace RV32 {
         }
     };
 
+    enum class TimeSource: uint32_t {
+        HOST_CLOCK,     // time advances with the host wall-clock
+        EXTERNAL,       // time only advances through Hart::advanceTime
+        INSTRET,        // time advances one tick every HartConfig::instructionsPerTick instructions
+        CYCLE           // like INSTRET, but counts the cycles of the timing model when one is attached
+    };
+
+    class Hart;
+    class GDBStub;
+
     struct HartConfig {
-        using ShutdownCallback = void (*)(void);
-        using PutCharCallback =  void (*)(char);
-        using GetCharCallback =  char (*)(void);
+        using ShutdownCallback = std::function<void(void)>;
+        using PutCharCallback =  std::function<void(char)>;
+        using GetCharCallback =  std::function<char(void)>;
+        using UserTrapCallback = std::function<bool(Hart&, uint32_t cause, uint32_t tval)>;
 
         uint32_t timebaseFreq;
         ShutdownCallback shutdownCallback;
         PutCharCallback putCharCallback;
         GetCharCallback getCharCallback;
+        TimeSource timeSource = TimeSource::HOST_CLOCK;
+        uint32_t instructionsPerTick = 1; // instructions or cycles, depending on the time source
+
+        // Perform misaligned loads and stores in the emulator instead of trapping to the guest
+        bool emulateMisaligned = false;
+
+        // Cache decoded instructions and execute common instruction pairs as one operation
+        bool enableFusion = false;
+
+        // Skip time forward through WFI and loops that only poll time or unchanged memory
+        bool skipIdleLoops = false;
+
+        // Vector register width in bits, a power of two from 128 to 1024
+        uint32_t vlen = 128;
+
+        // Called for traps taken from user mode before they are delivered to supervisor mode. Returning true
+        // marks the trap as handled and the instruction completes as if it had not trapped.
+        UserTrapCallback userTrapCallback = {};
+    };
+
+    // Architectural state of a hart, used to clone one hart into another
+    struct HartState {
+        Registers gpr;
+        FloatRegisters fpr;
+        VectorRegisters vr;
+        CSRs csr;
+        uint32_t pc;
+        uint64_t timeCompare;
+        PerformanceMonitor pmu;
+        bool supervisorMode;
+        bool reservationSetValid;
     };
 
     class Hart {
@@ -69,17 +125,81 @@ namespace RV32 {
             Hart(uint32_t pc, MemoryMapManager &mem, const HartConfig& config);
             virtual ~Hart() = default;
 
-            void reset() { gpr.reset(); }
+            void reset() { gpr.reset(); fpr.reset(); vr.reset(); }
             void stepInstruction();
 
             void setPC(uint32_t addr) { pc = addr; }
             uint32_t getPC() const { return pc; }
 
             Registers& getRegisters() { return gpr; }
+            FloatRegisters& getFloatRegisters() { return fpr; }
+            VectorRegisters& getVectorRegisters() { return vr; }
             CSRs& getCSRs() { return csr; }
             MemoryMapManager& getMemoryMapManager() { return mem; }
+            bool isSupervisorMode() const { return supervisorMode; }
+            bool isReservationSetValid() const { return reservationSetValid; }
+            uint64_t getTimeCompare() const { return timeCompare; }
+
+            HartState getState() const;
+            void setState(const HartState& state);
+
+            // Must be called after sip, sie, sstatus or the privilege mode are changed externally
+            void updateInterruptPending();
+
+            // Must be called after satp, the privilege mode or the instrumentation are changed, selects the matching execution loop
+            void updateExecutionMode();
+
+            uint64_t getInstret() const { return (static_cast<uint64_t>(csr.instreth) << 32) | csr.instret; }
+            uint64_t getCycle() const;
+            uint64_t getTime();
+            void advanceTime(uint64_t ticks);
+
+            // Reads the instruction at a virtual address without side effects, for debugging tools.
+            // Compressed instructions are returned in the low halfword.
+            bool peekInstruction(uint32_t virtualAddr, uint32_t &bits);
+
+            // Memory and CSR accesses for debuggers, which see every mapped page regardless of its permissions.
+            // Return false if the address is not mapped or the CSR does not exist.
+            bool readDebugMemory(uint32_t virtualAddr, uint8_t &value);
+            bool writeDebugMemory(uint32_t virtualAddr, uint8_t value);
+            bool readDebugCSR(uint32_t addr, uint32_t &value);
+            bool writeDebugCSR(uint32_t addr, uint32_t value);
+
+            const FusionStats& getFusionStats() const { return fusionStats; }
+
+            // Records every retired instruction into the buffer, nullptr disables tracing
+            void setTraceBuffer(TraceRingBuffer *buffer);
+
+            // Feeds every fetch, load and store into the simulator, nullptr disables it
+            void setMemorySimulator(MemoryHierarchySimulator *simulator);
+
+            // Derives cycle from the model instead of instret, nullptr returns to one cycle per instruction
+            void setTimingModel(TimingModel *model);
+
+            // Collects basic block vectors of the executed instructions, nullptr disables it
+            void setBlockProfiler(BasicBlockProfiler *profiler);
+
+            // Records every ecall from U-mode and its result, nullptr disables it
+            void setSyscallTracer(SyscallTracer *tracer) { syscallTracer = tracer; }
+
+            // Records paging, the first user instruction and the PC triggers of the timeline, nullptr disables it
+            void setBootTimeline(BootTimeline *timeline);
+
+            // Stops at the debugger's breakpoints and watchpoints, nullptr detaches it
+            void setDebugger(GDBStub *stub);
         private:
             const uint64_t SECONDS_TO_NANSECONDS = 1000000000;
+            static constexpr uint32_t TIME_SYNC_MASK = 0x3FF; // sample the host clock every 1024 instructions
+            static constexpr uint32_t DECODE_CACHE_SIZE = 4096;
+            static constexpr uint32_t DECODE_CACHE_INVALID = 0xFFFFFFFF; // never halfword aligned
+
+            // Entries are keyed by physical address and validated against the fetched bits
+            struct DecodeCacheEntry {
+                uint32_t physAddr = DECODE_CACHE_INVALID;
+                DecodedInstruction first;
+                DecodedInstruction second;
+                FusionKind fusion = FusionKind::NONE;
+            };
 
             enum class MemoryAccessType: uint32_t {
                 READ, WRITE, EXECUTE
@@ -108,26 +228,94 @@ namespace RV32 {
             const HartConfig hartConfig;
             MemoryMapManager &mem;
             Registers gpr;
+            FloatRegisters fpr;
+            VectorRegisters vr;
             CSRs csr;
             uint32_t pc;
 
             std::chrono::time_point<std::chrono::high_resolution_clock> lastTime;
+            uint32_t unitsUntilTick = 0; // instructions or cycles until the next tick
 
             const uint64_t timebasePeriod;
             uint64_t timeCompare = 0;
 
+            PerformanceMonitor pmu;
+
             bool supervisorMode = true;
             bool shouldIncrementPC = false;
             bool reservationSetValid = false;
 
+            // Cached result of whether an enabled interrupt is pending and deliverable
+            bool interruptPending = false;
+
+            // Execution loop specialized for the current paging and privilege mode
+            using ExecuteFunction = void (Hart::*)();
+            ExecuteFunction executeFunction = nullptr;
+
+            TraceRingBuffer *traceBuffer = nullptr;
+            MemoryHierarchySimulator *memorySimulator = nullptr;
+            MemoryHierarchySimulator::TLBMisses countedTLBMisses; // already counted into the hpmcounters
+            TimingModel *timingModel = nullptr;
+            BasicBlockProfiler *blockProfiler = nullptr;
+            SyscallTracer *syscallTracer = nullptr;
+            GDBStub *debugger = nullptr;
+            BootTimeline *bootTimeline = nullptr;
+
+            SpinDetector spinDetector;
+
+            std::unique_ptr<DecodeCacheEntry[]> decodeCache;
+            FusionStats fusionStats;
+
+            template<bool PAGING, bool SUPERVISOR, bool INSTRUMENTED>
+            void executeInstruction();
+
+            // Returns false if fetching raised a page fault, the non-template version uses the current translation mode
+            template<bool PAGING, bool SUPERVISOR>
+            bool fetchInstruction(uint32_t &pcPhysicalAddr, Instruction &instr);
+            bool fetchInstruction(uint32_t &pcPhysicalAddr, Instruction &instr);
+
+            // Vector loads and stores, element by element from vstart
+            template<bool PAGING, bool SUPERVISOR, bool INSTRUMENTED>
+            void executeVectorMemory(const DecodedInstruction &decoded, uint32_t instrPC);
+
             void handleInterrupts();
             void incrementCounters();
+            void addCycles(uint32_t cycles);
+            void countTicks(uint32_t units);
+            void syncTime();
+            void resetTickCountdown();
+
+            // Counts the events of a retired instruction into the started hpmcounters
+            void countPerformanceEvents(const DecodedInstruction &decoded, bool supervisor, uint32_t cycles, bool mispredicted);
+            // TLB misses come from the memory hierarchy simulator one batch of accesses at a time,
+            // syncTLBMisses counts every access so far in before a counter is read or reprogrammed
+            void addTLBMisses(PMUEventCounts &events);
+            void syncTLBMisses();
+            void countTrap();
+            SBIResult handleSBIBaseCall();
+
+            void trackIdleLoop(const DecodedInstruction &decoded, uint32_t instrPC);
+            void skipTime(uint64_t maxTicks);
+
+            const DecodeCacheEntry& lookupDecodeCache(uint32_t pcPhysicalAddr, Instruction instr);
+            bool executeFused(const DecodeCacheEntry &entry);
+
+            bool isCSRAccessAllowed(const CSRDescriptor &descriptor, bool writes) const;
+            uint32_t readCSR(const CSRDescriptor &descriptor);
+            void writeCSR(const CSRDescriptor &descriptor, uint32_t value);
 
             void setRegister(uint32_t index, uint32_t value);
             uint32_t getRegister(uint32_t index) const;
 
             void handleException(ExceptionCode code, uint32_t stval);
-            bool translateAddress(uint32_t &addr, MemoryAccessType accessType);
+            bool translateAddress(uint32_t &addr, MemoryAccessType accessType, bool updatePTE = true);
+            template<bool PAGING, bool SUPERVISOR>
+            bool translateAddress(uint32_t &addr, MemoryAccessType accessType, bool updatePTE = true);
+            bool translateDebugAddress(uint32_t &addr);
+            bool translateSplitAccess(uint32_t addr, uint32_t size, MemoryAccessType accessType, uint32_t (&physAddrs)[4]);
+            // physAddr receives the physical address of the first byte
+            bool loadMisaligned(uint32_t addr, uint32_t size, uint32_t &value, uint32_t &physAddr);
+            bool storeMisaligned(uint32_t addr, uint32_t size, uint32_t value, uint32_t &physAddr);
     };
 };
 
@@ -77,7 +77,22 @@ namespace RV32 {
                 return SIGN_EXTEND((imm_20 << 20) | (imm_19_12 << 12) | (imm_11 << 11) | (imm_10_1 << 1), 21);
             }
         } j;
+
+        Instruction() = default;
+        constexpr explicit Instruction(uint32_t bits) : bits(bits) {}
+        Instruction(const Instruction&) = default;
+
+        // The bit fields are not assignable, so copy the raw encoding
+        Instruction& operator=(const Instruction& other) {
+            bits = other.bits;
+            return *this;
+        }
     };
+
+    // 16-bit C extension instructions are the ones whose two lowest bits are not 0b11
+    constexpr bool isCompressed(uint32_t bits) {
+        return (bits & 0b11) != 0b11;
+    }
 };
 
 #endif /* __INSTRUCTION_HPP__ */
\ No newline at end of file
@@ -0,0 +1,417 @@
+#ifndef __INSTRUCTION_TABLE_HPP__
+#define __INSTRUCTION_TABLE_HPP__
+
+#include "decoder.hpp"
+
+namespace RV32 {
+    constexpr uint32_t MASK_OPCODE       = 0x0000007F;
+    constexpr uint32_t MASK_F3           = 0x0000707F;
+    constexpr uint32_t MASK_F3_F7        = 0xFE00707F;
+    constexpr uint32_t MASK_F3_F7_RD     = 0xFE007FFF;
+    constexpr uint32_t MASK_F3_F12       = 0xFFF0707F; // funct7 and rs2 together select the operation
+    constexpr uint32_t MASK_F7           = 0xFE00007F; // funct3 holds the rounding mode
+    constexpr uint32_t MASK_F7_RS2       = 0xFFF0007F;
+    constexpr uint32_t MASK_FMT          = 0x0600007F; // fused multiply-add, rs3 in funct7
+    constexpr uint32_t MASK_V            = 0xFC00707F; // funct6, vm selects masking
+    constexpr uint32_t MASK_V_VS1        = 0xFC0FF07F; // the vs1 field selects the operation
+    constexpr uint32_t MASK_V_VS1_VM     = 0xFE0FF07F;
+    constexpr uint32_t MASK_VID          = 0xFDFFF07F;
+    constexpr uint32_t MASK_VMEM         = 0xFDF0707F; // nf, mew, mop and lumop select the access
+    constexpr uint32_t MASK_VSETVLI      = 0x8000707F;
+    constexpr uint32_t MASK_VSETIVLI     = 0xC000707F;
+    constexpr uint32_t MASK_AMO          = 0xF800707F; // aq and rl are ignored
+    constexpr uint32_t MASK_AMO_RS2      = 0xF9F0707F;
+    constexpr uint32_t MASK_ALL          = 0xFFFFFFFF;
+
+    constexpr uint32_t encode(uint32_t opcode, uint32_t funct3 = 0, uint32_t funct7 = 0) {
+        return opcode | (funct3 << 12) | (funct7 << 25);
+    }
+
+    constexpr uint32_t encodeAMO(uint32_t funct5) {
+        return encode(0b0101111, 0b010, funct5 << 2);
+    }
+
+    constexpr uint32_t encodeF12(uint32_t opcode, uint32_t funct3, uint32_t funct12) {
+        return opcode | (funct3 << 12) | (funct12 << 20);
+    }
+
+    // funct3 of OP-V selects the operand kinds
+    constexpr uint32_t OPIVV = 0b000;
+    constexpr uint32_t OPMVV = 0b010;
+    constexpr uint32_t OPIVI = 0b011;
+    constexpr uint32_t OPIVX = 0b100;
+    constexpr uint32_t OPMVX = 0b110;
+    constexpr uint32_t OPCFG = 0b111;
+
+    // funct7 holds funct6 and vm
+    constexpr uint32_t encodeV(uint32_t funct3, uint32_t funct7, uint32_t vs1 = 0) {
+        return encode(0b1010111, funct3, funct7) | (vs1 << 15);
+    }
+
+    // Adding an instruction only requires a new entry here and its semantics in the hart
+    constexpr InstructionDescriptor INSTRUCTION_TABLE[] = {
+        // RV32I Base //
+        { MASK_OPCODE,   encode(0b0110111),                   InstructionType::OP_UI,    Opcode::LUI,             InstructionFormat::U,     "lui" },
+        { MASK_OPCODE,   encode(0b0010111),                   InstructionType::OP_UI,    Opcode::AUIPC,           InstructionFormat::U,     "auipc" },
+        { MASK_OPCODE,   encode(0b1101111),                   InstructionType::JUMP,     Opcode::JAL,             InstructionFormat::J,     "jal" },
+        { MASK_F3,       encode(0b1100111, 0b000),            InstructionType::JUMP,     Opcode::JALR,            InstructionFormat::I,     "jalr" },
+        { MASK_F3,       encode(0b1100011, 0b000),            InstructionType::BRANCH,   Opcode::BEQ,             InstructionFormat::B,     "beq" },
+        { MASK_F3,       encode(0b1100011, 0b001),            InstructionType::BRANCH,   Opcode::BNE,             InstructionFormat::B,     "bne" },
+        { MASK_F3,       encode(0b1100011, 0b100),            InstructionType::BRANCH,   Opcode::BLT,             InstructionFormat::B,     "blt" },
+        { MASK_F3,       encode(0b1100011, 0b101),            InstructionType::BRANCH,   Opcode::BGE,             InstructionFormat::B,     "bge" },
+        { MASK_F3,       encode(0b1100011, 0b110),            InstructionType::BRANCH,   Opcode::BLTU,            InstructionFormat::B,     "bltu" },
+        { MASK_F3,       encode(0b1100011, 0b111),            InstructionType::BRANCH,   Opcode::BGEU,            InstructionFormat::B,     "bgeu" },
+        { MASK_F3,       encode(0b0000011, 0b000),            InstructionType::LOAD,     Opcode::LB,              InstructionFormat::I,     "lb" },
+        { MASK_F3,       encode(0b0000011, 0b001),            InstructionType::LOAD,     Opcode::LH,              InstructionFormat::I,     "lh" },
+        { MASK_F3,       encode(0b0000011, 0b010),            InstructionType::LOAD,     Opcode::LW,              InstructionFormat::I,     "lw" },
+        { MASK_F3,       encode(0b0000011, 0b100),            InstructionType::LOAD,     Opcode::LBU,             InstructionFormat::I,     "lbu" },
+        { MASK_F3,       encode(0b0000011, 0b101),            InstructionType::LOAD,     Opcode::LHU,             InstructionFormat::I,     "lhu" },
+        { MASK_F3,       encode(0b0100011, 0b000),            InstructionType::STORE,    Opcode::SB,              InstructionFormat::S,     "sb" },
+        { MASK_F3,       encode(0b0100011, 0b001),            InstructionType::STORE,    Opcode::SH,              InstructionFormat::S,     "sh" },
+        { MASK_F3,       encode(0b0100011, 0b010),            InstructionType::STORE,    Opcode::SW,              InstructionFormat::S,     "sw" },
+        { MASK_F3,       encode(0b0010011, 0b000),            InstructionType::OP_IMM,   Opcode::ADDI,            InstructionFormat::I,     "addi" },
+        { MASK_F3,       encode(0b0010011, 0b010),            InstructionType::OP_IMM,   Opcode::SLTI,            InstructionFormat::I,     "slti" },
+        { MASK_F3,       encode(0b0010011, 0b011),            InstructionType::OP_IMM,   Opcode::SLTIU,           InstructionFormat::I,     "sltiu" },
+        { MASK_F3,       encode(0b0010011, 0b100),            InstructionType::OP_IMM,   Opcode::XORI,            InstructionFormat::I,     "xori" },
+        { MASK_F3,       encode(0b0010011, 0b110),            InstructionType::OP_IMM,   Opcode::ORI,             InstructionFormat::I,     "ori" },
+        { MASK_F3,       encode(0b0010011, 0b111),            InstructionType::OP_IMM,   Opcode::ANDI,            InstructionFormat::I,     "andi" },
+        { MASK_F3_F7,    encode(0b0010011, 0b001, 0b0000000), InstructionType::OP_IMM,   Opcode::SLLI,            InstructionFormat::SHIFT, "slli" },
+        { MASK_F3_F7,    encode(0b0010011, 0b101, 0b0000000), InstructionType::OP_IMM,   Opcode::SRLI,            InstructionFormat::SHIFT, "srli" },
+        { MASK_F3_F7,    encode(0b0010011, 0b101, 0b0100000), InstructionType::OP_IMM,   Opcode::SRAI,            InstructionFormat::SHIFT, "srai" },
+        { MASK_F3_F7,    encode(0b0110011, 0b000, 0b0000000), InstructionType::OP,       Opcode::ADD,             InstructionFormat::R,     "add" },
+        { MASK_F3_F7,    encode(0b0110011, 0b000, 0b0100000), InstructionType::OP,       Opcode::SUB,             InstructionFormat::R,     "sub" },
+        { MASK_F3_F7,    encode(0b0110011, 0b001, 0b0000000), InstructionType::OP,       Opcode::SLL,             InstructionFormat::R,     "sll" },
+        { MASK_F3_F7,    encode(0b0110011, 0b010, 0b0000000), InstructionType::OP,       Opcode::SLT,             InstructionFormat::R,     "slt" },
+        { MASK_F3_F7,    encode(0b0110011, 0b011, 0b0000000), InstructionType::OP,       Opcode::SLTU,            InstructionFormat::R,     "sltu" },
+        { MASK_F3_F7,    encode(0b0110011, 0b100, 0b0000000), InstructionType::OP,       Opcode::XOR,             InstructionFormat::R,     "xor" },
+        { MASK_F3_F7,    encode(0b0110011, 0b101, 0b0000000), InstructionType::OP,       Opcode::SRL,             InstructionFormat::R,     "srl" },
+        { MASK_F3_F7,    encode(0b0110011, 0b101, 0b0100000), InstructionType::OP,       Opcode::SRA,             InstructionFormat::R,     "sra" },
+        { MASK_F3_F7,    encode(0b0110011, 0b110, 0b0000000), InstructionType::OP,       Opcode::OR,              InstructionFormat::R,     "or" },
+        { MASK_F3_F7,    encode(0b0110011, 0b111, 0b0000000), InstructionType::OP,       Opcode::AND,             InstructionFormat::R,     "and" },
+        { MASK_F3,       encode(0b0001111, 0b000),            InstructionType::OP_FENCE, Opcode::FENCE,           InstructionFormat::NONE,  "fence" },
+        { MASK_ALL,      0x00000073,                          InstructionType::SYSTEM,   Opcode::ECALL,           InstructionFormat::NONE,  "ecall" },
+        { MASK_ALL,      0x00100073,                          InstructionType::SYSTEM,   Opcode::EBREAK,          InstructionFormat::NONE,  "ebreak" },
+        { MASK_ALL,      0x10200073,                          InstructionType::SYSTEM,   Opcode::SRET,            InstructionFormat::NONE,  "sret" },
+        { MASK_ALL,      0x10500073,                          InstructionType::SYSTEM,   Opcode::WFI,             InstructionFormat::NONE,  "wfi" },
+        { MASK_F3_F7_RD, encode(0b1110011, 0b000, 0b0001001), InstructionType::SYSTEM,   Opcode::SFENCE_VMA,      InstructionFormat::R,     "sfence.vma" },
+        { MASK_F3_F7_RD, encode(0b1110011, 0b000, 0b0001011), InstructionType::SYSTEM,   Opcode::SINVAL_VMA,      InstructionFormat::R,     "sinval.vma" },
+        { MASK_ALL,      0x18000073,                          InstructionType::SYSTEM,   Opcode::SFENCE_W_INVAL,  InstructionFormat::NONE,  "sfence.w.inval" },
+        { MASK_ALL,      0x18100073,                          InstructionType::SYSTEM,   Opcode::SFENCE_INVAL_IR, InstructionFormat::NONE,  "sfence.inval.ir" },
+
+        // Zicsr Extension //
+        { MASK_F3,       encode(0b1110011, 0b001),            InstructionType::SYSTEM,   Opcode::CSRRW,           InstructionFormat::CSR,   "csrrw" },
+        { MASK_F3,       encode(0b1110011, 0b010),            InstructionType::SYSTEM,   Opcode::CSRRS,           InstructionFormat::CSR,   "csrrs" },
+        { MASK_F3,       encode(0b1110011, 0b011),            InstructionType::SYSTEM,   Opcode::CSRRC,           InstructionFormat::CSR,   "csrrc" },
+        { MASK_F3,       encode(0b1110011, 0b101),            InstructionType::SYSTEM,   Opcode::CSRRWI,          InstructionFormat::CSR,   "csrrwi" },
+        { MASK_F3,       encode(0b1110011, 0b110),            InstructionType::SYSTEM,   Opcode::CSRRSI,          InstructionFormat::CSR,   "csrrsi" },
+        { MASK_F3,       encode(0b1110011, 0b111),            InstructionType::SYSTEM,   Opcode::CSRRCI,          InstructionFormat::CSR,   "csrrci" },
+
+        // Zifencei Extension //
+        { MASK_F3,       encode(0b0001111, 0b001),            InstructionType::OP_FENCE, Opcode::FENCE_I,         InstructionFormat::NONE,  "fence.i" },
+
+        // M Extension //
+        { MASK_F3_F7,    encode(0b0110011, 0b000, 0b0000001), InstructionType::OP,       Opcode::MUL,             InstructionFormat::R,     "mul" },
+        { MASK_F3_F7,    encode(0b0110011, 0b001, 0b0000001), InstructionType::OP,       Opcode::MULH,            InstructionFormat::R,     "mulh" },
+        { MASK_F3_F7,    encode(0b0110011, 0b010, 0b0000001), InstructionType::OP,       Opcode::MULHSU,          InstructionFormat::R,     "mulhsu" },
+        { MASK_F3_F7,    encode(0b0110011, 0b011, 0b0000001), InstructionType::OP,       Opcode::MULHU,           InstructionFormat::R,     "mulhu" },
+        { MASK_F3_F7,    encode(0b0110011, 0b100, 0b0000001), InstructionType::OP,       Opcode::DIV,             InstructionFormat::R,     "div" },
+        { MASK_F3_F7,    encode(0b0110011, 0b101, 0b0000001), InstructionType::OP,       Opcode::DIVU,            InstructionFormat::R,     "divu" },
+        { MASK_F3_F7,    encode(0b0110011, 0b110, 0b0000001), InstructionType::OP,       Opcode::REM,             InstructionFormat::R,     "rem" },
+        { MASK_F3_F7,    encode(0b0110011, 0b111, 0b0000001), InstructionType::OP,       Opcode::REMU,            InstructionFormat::R,     "remu" },
+
+        // A Extension //
+        { MASK_AMO_RS2,  encodeAMO(0b00010),                  InstructionType::AMO,      Opcode::LR_W,            InstructionFormat::R,     "lr.w" },
+        { MASK_AMO,      encodeAMO(0b00011),                  InstructionType::AMO,      Opcode::SC_W,            InstructionFormat::R,     "sc.w" },
+        { MASK_AMO,      encodeAMO(0b00001),                  InstructionType::AMO,      Opcode::AMOSWAP_W,       InstructionFormat::R,     "amoswap.w" },
+        { MASK_AMO,      encodeAMO(0b00000),                  InstructionType::AMO,      Opcode::AMOADD_W,        InstructionFormat::R,     "amoadd.w" },
+        { MASK_AMO,      encodeAMO(0b00100),                  InstructionType::AMO,      Opcode::AMOXOR_W,        InstructionFormat::R,     "amoxor.w" },
+        { MASK_AMO,      encodeAMO(0b01100),                  InstructionType::AMO,      Opcode::AMOAND_W,        InstructionFormat::R,     "amoand.w" },
+        { MASK_AMO,      encodeAMO(0b01000),                  InstructionType::AMO,      Opcode::AMOOR_W,         InstructionFormat::R,     "amoor.w" },
+        { MASK_AMO,      encodeAMO(0b10000),                  InstructionType::AMO,      Opcode::AMOMIN_W,        InstructionFormat::R,     "amomin.w" },
+        { MASK_AMO,      encodeAMO(0b10100),                  InstructionType::AMO,      Opcode::AMOMAX_W,        InstructionFormat::R,     "amomax.w" },
+        { MASK_AMO,      encodeAMO(0b11000),                  InstructionType::AMO,      Opcode::AMOMINU_W,       InstructionFormat::R,     "amominu.w" },
+        { MASK_AMO,      encodeAMO(0b11100),                  InstructionType::AMO,      Opcode::AMOMAXU_W,       InstructionFormat::R,     "amomaxu.w" },
+
+        // Zba Extension //
+        { MASK_F3_F7,    encode(0b0110011, 0b010, 0b0010000), InstructionType::OP,       Opcode::SH1ADD,          InstructionFormat::R,     "sh1add" },
+        { MASK_F3_F7,    encode(0b0110011, 0b100, 0b0010000), InstructionType::OP,       Opcode::SH2ADD,          InstructionFormat::R,     "sh2add" },
+        { MASK_F3_F7,    encode(0b0110011, 0b110, 0b0010000), InstructionType::OP,       Opcode::SH3ADD,          InstructionFormat::R,     "sh3add" },
+
+        // Zbb Extension //
+        { MASK_F3_F7,    encode(0b0110011, 0b111, 0b0100000), InstructionType::OP,       Opcode::ANDN,            InstructionFormat::R,     "andn" },
+        { MASK_F3_F7,    encode(0b0110011, 0b110, 0b0100000), InstructionType::OP,       Opcode::ORN,             InstructionFormat::R,     "orn" },
+        { MASK_F3_F7,    encode(0b0110011, 0b100, 0b0100000), InstructionType::OP,       Opcode::XNOR,            InstructionFormat::R,     "xnor" },
+        { MASK_F3_F12,   encodeF12(0b0010011, 0b001, 0x600),  InstructionType::OP_IMM,   Opcode::CLZ,             InstructionFormat::UNARY, "clz" },
+        { MASK_F3_F12,   encodeF12(0b0010011, 0b001, 0x601),  InstructionType::OP_IMM,   Opcode::CTZ,             InstructionFormat::UNARY, "ctz" },
+        { MASK_F3_F12,   encodeF12(0b0010011, 0b001, 0x602),  InstructionType::OP_IMM,   Opcode::CPOP,            InstructionFormat::UNARY, "cpop" },
+        { MASK_F3_F7,    encode(0b0110011, 0b110, 0b0000101), InstructionType::OP,       Opcode::MAX,             InstructionFormat::R,     "max" },
+        { MASK_F3_F7,    encode(0b0110011, 0b111, 0b0000101), InstructionType::OP,       Opcode::MAXU,            InstructionFormat::R,     "maxu" },
+        { MASK_F3_F7,    encode(0b0110011, 0b100, 0b0000101), InstructionType::OP,       Opcode::MIN,             InstructionFormat::R,     "min" },
+        { MASK_F3_F7,    encode(0b0110011, 0b101, 0b0000101), InstructionType::OP,       Opcode::MINU,            InstructionFormat::R,     "minu" },
+        { MASK_F3_F12,   encodeF12(0b0010011, 0b001, 0x604),  InstructionType::OP_IMM,   Opcode::SEXT_B,          InstructionFormat::UNARY, "sext.b" },
+        { MASK_F3_F12,   encodeF12(0b0010011, 0b001, 0x605),  InstructionType::OP_IMM,   Opcode::SEXT_H,          InstructionFormat::UNARY, "sext.h" },
+        { MASK_F3_F12,   encodeF12(0b0110011, 0b100, 0x080),  InstructionType::OP,       Opcode::ZEXT_H,          InstructionFormat::UNARY, "zext.h" },
+        { MASK_F3_F7,    encode(0b0110011, 0b001, 0b0110000), InstructionType::OP,       Opcode::ROL,             InstructionFormat::R,     "rol" },
+        { MASK_F3_F7,    encode(0b0110011, 0b101, 0b0110000), InstructionType::OP,       Opcode::ROR,             InstructionFormat::R,     "ror" },
+        { MASK_F3_F7,    encode(0b0010011, 0b101, 0b0110000), InstructionType::OP_IMM,   Opcode::RORI,            InstructionFormat::SHIFT, "rori" },
+        { MASK_F3_F12,   encodeF12(0b0010011, 0b101, 0x287),  InstructionType::OP_IMM,   Opcode::ORC_B,           InstructionFormat::UNARY, "orc.b" },
+        { MASK_F3_F12,   encodeF12(0b0010011, 0b101, 0x698),  InstructionType::OP_IMM,   Opcode::REV8,            InstructionFormat::UNARY, "rev8" },
+
+        // Zbs Extension //
+        { MASK_F3_F7,    encode(0b0110011, 0b001, 0b0100100), InstructionType::OP,       Opcode::BCLR,            InstructionFormat::R,     "bclr" },
+        { MASK_F3_F7,    encode(0b0010011, 0b001, 0b0100100), InstructionType::OP_IMM,   Opcode::BCLRI,           InstructionFormat::SHIFT, "bclri" },
+        { MASK_F3_F7,    encode(0b0110011, 0b101, 0b0100100), InstructionType::OP,       Opcode::BEXT,            InstructionFormat::R,     "bext" },
+        { MASK_F3_F7,    encode(0b0010011, 0b101, 0b0100100), InstructionType::OP_IMM,   Opcode::BEXTI,           InstructionFormat::SHIFT, "bexti" },
+        { MASK_F3_F7,    encode(0b0110011, 0b001, 0b0110100), InstructionType::OP,       Opcode::BINV,            InstructionFormat::R,     "binv" },
+        { MASK_F3_F7,    encode(0b0010011, 0b001, 0b0110100), InstructionType::OP_IMM,   Opcode::BINVI,           InstructionFormat::SHIFT, "binvi" },
+        { MASK_F3_F7,    encode(0b0110011, 0b001, 0b0010100), InstructionType::OP,       Opcode::BSET,            InstructionFormat::R,     "bset" },
+        { MASK_F3_F7,    encode(0b0010011, 0b001, 0b0010100), InstructionType::OP_IMM,   Opcode::BSETI,           InstructionFormat::SHIFT, "bseti" },
+
+        // F Extension //
+        { MASK_F3,       encode(0b0000111, 0b010),            InstructionType::LOAD_FP,  Opcode::FLW,             InstructionFormat::I,     "flw" },
+        { MASK_F3,       encode(0b0100111, 0b010),            InstructionType::STORE_FP, Opcode::FSW,             InstructionFormat::S,     "fsw" },
+        { MASK_FMT,      encode(0b1000011, 0b000, 0b0000000), InstructionType::OP_FP,    Opcode::FMADD_S,         InstructionFormat::R4,    "fmadd.s" },
+        { MASK_FMT,      encode(0b1000111, 0b000, 0b0000000), InstructionType::OP_FP,    Opcode::FMSUB_S,         InstructionFormat::R4,    "fmsub.s" },
+        { MASK_FMT,      encode(0b1001011, 0b000, 0b0000000), InstructionType::OP_FP,    Opcode::FNMSUB_S,        InstructionFormat::R4,    "fnmsub.s" },
+        { MASK_FMT,      encode(0b1001111, 0b000, 0b0000000), InstructionType::OP_FP,    Opcode::FNMADD_S,        InstructionFormat::R4,    "fnmadd.s" },
+        { MASK_F7,       encode(0b1010011, 0b000, 0b0000000), InstructionType::OP_FP,    Opcode::FADD_S,          InstructionFormat::R,     "fadd.s" },
+        { MASK_F7,       encode(0b1010011, 0b000, 0b0000100), InstructionType::OP_FP,    Opcode::FSUB_S,          InstructionFormat::R,     "fsub.s" },
+        { MASK_F7,       encode(0b1010011, 0b000, 0b0001000), InstructionType::OP_FP,    Opcode::FMUL_S,          InstructionFormat::R,     "fmul.s" },
+        { MASK_F7,       encode(0b1010011, 0b000, 0b0001100), InstructionType::OP_FP,    Opcode::FDIV_S,          InstructionFormat::R,     "fdiv.s" },
+        { MASK_F7_RS2,   encodeF12(0b1010011, 0b000, 0x580),  InstructionType::OP_FP,    Opcode::FSQRT_S,         InstructionFormat::UNARY, "fsqrt.s" },
+        { MASK_F3_F7,    encode(0b1010011, 0b000, 0b0010000), InstructionType::OP_FP,    Opcode::FSGNJ_S,         InstructionFormat::R,     "fsgnj.s" },
+        { MASK_F3_F7,    encode(0b1010011, 0b001, 0b0010000), InstructionType::OP_FP,    Opcode::FSGNJN_S,        InstructionFormat::R,     "fsgnjn.s" },
+        { MASK_F3_F7,    encode(0b1010011, 0b010, 0b0010000), InstructionType::OP_FP,    Opcode::FSGNJX_S,        InstructionFormat::R,     "fsgnjx.s" },
+        { MASK_F3_F7,    encode(0b1010011, 0b000, 0b0010100), InstructionType::OP_FP,    Opcode::FMIN_S,          InstructionFormat::R,     "fmin.s" },
+        { MASK_F3_F7,    encode(0b1010011, 0b001, 0b0010100), InstructionType::OP_FP,    Opcode::FMAX_S,          InstructionFormat::R,     "fmax.s" },
+        { MASK_F3_F7,    encode(0b1010011, 0b010, 0b1010000), InstructionType::OP_FP,    Opcode::FEQ_S,           InstructionFormat::R,     "feq.s" },
+        { MASK_F3_F7,    encode(0b1010011, 0b001, 0b1010000), InstructionType::OP_FP,    Opcode::FLT_S,           InstructionFormat::R,     "flt.s" },
+        { MASK_F3_F7,    encode(0b1010011, 0b000, 0b1010000), InstructionType::OP_FP,    Opcode::FLE_S,           InstructionFormat::R,     "fle.s" },
+        { MASK_F7_RS2,   encodeF12(0b1010011, 0b000, 0xC00),  InstructionType::OP_FP,    Opcode::FCVT_W_S,        InstructionFormat::UNARY, "fcvt.w.s" },
+        { MASK_F7_RS2,   encodeF12(0b1010011, 0b000, 0xC01),  InstructionType::OP_FP,    Opcode::FCVT_WU_S,       InstructionFormat::UNARY, "fcvt.wu.s" },
+        { MASK_F3_F12,   encodeF12(0b1010011, 0b000, 0xE00),  InstructionType::OP_FP,    Opcode::FMV_X_W,         InstructionFormat::UNARY, "fmv.x.w" },
+        { MASK_F3_F12,   encodeF12(0b1010011, 0b001, 0xE00),  InstructionType::OP_FP,    Opcode::FCLASS_S,        InstructionFormat::UNARY, "fclass.s" },
+        { MASK_F7_RS2,   encodeF12(0b1010011, 0b000, 0xD00),  InstructionType::OP_FP,    Opcode::FCVT_S_W,        InstructionFormat::UNARY, "fcvt.s.w" },
+        { MASK_F7_RS2,   encodeF12(0b1010011, 0b000, 0xD01),  InstructionType::OP_FP,    Opcode::FCVT_S_WU,       InstructionFormat::UNARY, "fcvt.s.wu" },
+        { MASK_F3_F12,   encodeF12(0b1010011, 0b000, 0xF00),  InstructionType::OP_FP,    Opcode::FMV_W_X,         InstructionFormat::UNARY, "fmv.w.x" },
+
+        // D Extension //
+        { MASK_F3,       encode(0b0000111, 0b011),            InstructionType::LOAD_FP,  Opcode::FLD,             InstructionFormat::I,     "fld" },
+        { MASK_F3,       encode(0b0100111, 0b011),            InstructionType::STORE_FP, Opcode::FSD,             InstructionFormat::S,     "fsd" },
+        { MASK_FMT,      encode(0b1000011, 0b000, 0b0000001), InstructionType::OP_FP,    Opcode::FMADD_D,         InstructionFormat::R4,    "fmadd.d" },
+        { MASK_FMT,      encode(0b1000111, 0b000, 0b0000001), InstructionType::OP_FP,    Opcode::FMSUB_D,         InstructionFormat::R4,    "fmsub.d" },
+        { MASK_FMT,      encode(0b1001011, 0b000, 0b0000001), InstructionType::OP_FP,    Opcode::FNMSUB_D,        InstructionFormat::R4,    "fnmsub.d" },
+        { MASK_FMT,      encode(0b1001111, 0b000, 0b0000001), InstructionType::OP_FP,    Opcode::FNMADD_D,        InstructionFormat::R4,    "fnmadd.d" },
+        { MASK_F7,       encode(0b1010011, 0b000, 0b0000001), InstructionType::OP_FP,    Opcode::FADD_D,          InstructionFormat::R,     "fadd.d" },
+        { MASK_F7,       encode(0b1010011, 0b000, 0b0000101), InstructionType::OP_FP,    Opcode::FSUB_D,          InstructionFormat::R,     "fsub.d" },
+        { MASK_F7,       encode(0b1010011, 0b000, 0b0001001), InstructionType::OP_FP,    Opcode::FMUL_D,          InstructionFormat::R,     "fmul.d" },
+        { MASK_F7,       encode(0b1010011, 0b000, 0b0001101), InstructionType::OP_FP,    Opcode::FDIV_D,          InstructionFormat::R,     "fdiv.d" },
+        { MASK_F7_RS2,   encodeF12(0b1010011, 0b000, 0x5A0),  InstructionType::OP_FP,    Opcode::FSQRT_D,         InstructionFormat::UNARY, "fsqrt.d" },
+        { MASK_F3_F7,    encode(0b1010011, 0b000, 0b0010001), InstructionType::OP_FP,    Opcode::FSGNJ_D,         InstructionFormat::R,     "fsgnj.d" },
+        { MASK_F3_F7,    encode(0b1010011, 0b001, 0b0010001), InstructionType::OP_FP,    Opcode::FSGNJN_D,        InstructionFormat::R,     "fsgnjn.d" },
+        { MASK_F3_F7,    encode(0b1010011, 0b010, 0b0010001), InstructionType::OP_FP,    Opcode::FSGNJX_D,        InstructionFormat::R,     "fsgnjx.d" },
+        { MASK_F3_F7,    encode(0b1010011, 0b000, 0b0010101), InstructionType::OP_FP,    Opcode::FMIN_D,          InstructionFormat::R,     "fmin.d" },
+        { MASK_F3_F7,    encode(0b1010011, 0b001, 0b0010101), InstructionType::OP_FP,    Opcode::FMAX_D,          InstructionFormat::R,     "fmax.d" },
+        { MASK_F7_RS2,   encodeF12(0b1010011, 0b000, 0x401),  InstructionType::OP_FP,    Opcode::FCVT_S_D,        InstructionFormat::UNARY, "fcvt.s.d" },
+        { MASK_F7_RS2,   encodeF12(0b1010011, 0b000, 0x420),  InstructionType::OP_FP,    Opcode::FCVT_D_S,        InstructionFormat::UNARY, "fcvt.d.s" },
+        { MASK_F3_F7,    encode(0b1010011, 0b010, 0b1010001), InstructionType::OP_FP,    Opcode::FEQ_D,           InstructionFormat::R,     "feq.d" },
+        { MASK_F3_F7,    encode(0b1010011, 0b001, 0b1010001), InstructionType::OP_FP,    Opcode::FLT_D,           InstructionFormat::R,     "flt.d" },
+        { MASK_F3_F7,    encode(0b1010011, 0b000, 0b1010001), InstructionType::OP_FP,    Opcode::FLE_D,           InstructionFormat::R,     "fle.d" },
+        { MASK_F3_F12,   encodeF12(0b1010011, 0b001, 0xE20),  InstructionType::OP_FP,    Opcode::FCLASS_D,        InstructionFormat::UNARY, "fclass.d" },
+        { MASK_F7_RS2,   encodeF12(0b1010011, 0b000, 0xC20),  InstructionType::OP_FP,    Opcode::FCVT_W_D,        InstructionFormat::UNARY, "fcvt.w.d" },
+        { MASK_F7_RS2,   encodeF12(0b1010011, 0b000, 0xC21),  InstructionType::OP_FP,    Opcode::FCVT_WU_D,       InstructionFormat::UNARY, "fcvt.wu.d" },
+        { MASK_F7_RS2,   encodeF12(0b1010011, 0b000, 0xD20),  InstructionType::OP_FP,    Opcode::FCVT_D_W,        InstructionFormat::UNARY, "fcvt.d.w" },
+        { MASK_F7_RS2,   encodeF12(0b1010011, 0b000, 0xD21),  InstructionType::OP_FP,    Opcode::FCVT_D_WU,       InstructionFormat::UNARY, "fcvt.d.wu" },
+
+        // V Extension //
+        { MASK_VSETVLI,  encodeV(OPCFG, 0b0000000),           InstructionType::OP_V,     Opcode::VSETVLI,         InstructionFormat::I,     "vsetvli" },
+        { MASK_VSETIVLI, encodeV(OPCFG, 0b1100000),           InstructionType::OP_V,     Opcode::VSETIVLI,        InstructionFormat::I,     "vsetivli" },
+        { MASK_F3_F7,    encodeV(OPCFG, 0b1000000),           InstructionType::OP_V,     Opcode::VSETVL,          InstructionFormat::R,     "vsetvl" },
+        { MASK_VMEM,     encode(0b0000111, 0b000, 0b0000000), InstructionType::LOAD_V,   Opcode::VLE8_V,          InstructionFormat::V,     "vle8.v" },
+        { MASK_VMEM,     encode(0b0000111, 0b101, 0b0000000), InstructionType::LOAD_V,   Opcode::VLE16_V,         InstructionFormat::V,     "vle16.v" },
+        { MASK_VMEM,     encode(0b0000111, 0b110, 0b0000000), InstructionType::LOAD_V,   Opcode::VLE32_V,         InstructionFormat::V,     "vle32.v" },
+        { MASK_VMEM,     encode(0b0000111, 0b111, 0b0000000), InstructionType::LOAD_V,   Opcode::VLE64_V,         InstructionFormat::V,     "vle64.v" },
+        { MASK_V,        encode(0b0000111, 0b000, 0b0000100), InstructionType::LOAD_V,   Opcode::VLSE8_V,         InstructionFormat::V,     "vlse8.v" },
+        { MASK_V,        encode(0b0000111, 0b101, 0b0000100), InstructionType::LOAD_V,   Opcode::VLSE16_V,        InstructionFormat::V,     "vlse16.v" },
+        { MASK_V,        encode(0b0000111, 0b110, 0b0000100), InstructionType::LOAD_V,   Opcode::VLSE32_V,        InstructionFormat::V,     "vlse32.v" },
+        { MASK_V,        encode(0b0000111, 0b111, 0b0000100), InstructionType::LOAD_V,   Opcode::VLSE64_V,        InstructionFormat::V,     "vlse64.v" },
+        { MASK_F3_F12,   encodeF12(0b0000111, 0b000, 0x02B),  InstructionType::LOAD_V,   Opcode::VLM_V,           InstructionFormat::V,     "vlm.v" },
+        { MASK_F3_F12,   encodeF12(0b0000111, 0b000, 0x028),  InstructionType::LOAD_V,   Opcode::VL1RE8_V,        InstructionFormat::V,     "vl1re8.v" },
+        { MASK_F3_F12,   encodeF12(0b0000111, 0b101, 0x028),  InstructionType::LOAD_V,   Opcode::VL1RE16_V,       InstructionFormat::V,     "vl1re16.v" },
+        { MASK_F3_F12,   encodeF12(0b0000111, 0b110, 0x028),  InstructionType::LOAD_V,   Opcode::VL1RE32_V,       InstructionFormat::V,     "vl1re32.v" },
+        { MASK_F3_F12,   encodeF12(0b0000111, 0b111, 0x028),  InstructionType::LOAD_V,   Opcode::VL1RE64_V,       InstructionFormat::V,     "vl1re64.v" },
+        { MASK_F3_F12,   encodeF12(0b0000111, 0b000, 0x228),  InstructionType::LOAD_V,   Opcode::VL2RE8_V,        InstructionFormat::V,     "vl2re8.v" },
+        { MASK_F3_F12,   encodeF12(0b0000111, 0b101, 0x228),  InstructionType::LOAD_V,   Opcode::VL2RE16_V,       InstructionFormat::V,     "vl2re16.v" },
+        { MASK_F3_F12,   encodeF12(0b0000111, 0b110, 0x228),  InstructionType::LOAD_V,   Opcode::VL2RE32_V,       InstructionFormat::V,     "vl2re32.v" },
+        { MASK_F3_F12,   encodeF12(0b0000111, 0b111, 0x228),  InstructionType::LOAD_V,   Opcode::VL2RE64_V,       InstructionFormat::V,     "vl2re64.v" },
+        { MASK_F3_F12,   encodeF12(0b0000111, 0b000, 0x628),  InstructionType::LOAD_V,   Opcode::VL4RE8_V,        InstructionFormat::V,     "vl4re8.v" },
+        { MASK_F3_F12,   encodeF12(0b0000111, 0b101, 0x628),  InstructionType::LOAD_V,   Opcode::VL4RE16_V,       InstructionFormat::V,     "vl4re16.v" },
+        { MASK_F3_F12,   encodeF12(0b0000111, 0b110, 0x628),  InstructionType::LOAD_V,   Opcode::VL4RE32_V,       InstructionFormat::V,     "vl4re32.v" },
+        { MASK_F3_F12,   encodeF12(0b0000111, 0b111, 0x628),  InstructionType::LOAD_V,   Opcode::VL4RE64_V,       InstructionFormat::V,     "vl4re64.v" },
+        { MASK_F3_F12,   encodeF12(0b0000111, 0b000, 0xE28),  InstructionType::LOAD_V,   Opcode::VL8RE8_V,        InstructionFormat::V,     "vl8re8.v" },
+        { MASK_F3_F12,   encodeF12(0b0000111, 0b101, 0xE28),  InstructionType::LOAD_V,   Opcode::VL8RE16_V,       InstructionFormat::V,     "vl8re16.v" },
+        { MASK_F3_F12,   encodeF12(0b0000111, 0b110, 0xE28),  InstructionType::LOAD_V,   Opcode::VL8RE32_V,       InstructionFormat::V,     "vl8re32.v" },
+        { MASK_F3_F12,   encodeF12(0b0000111, 0b111, 0xE28),  InstructionType::LOAD_V,   Opcode::VL8RE64_V,       InstructionFormat::V,     "vl8re64.v" },
+        { MASK_VMEM,     encode(0b0100111, 0b000, 0b0000000), InstructionType::STORE_V,  Opcode::VSE8_V,          InstructionFormat::V,     "vse8.v" },
+        { MASK_VMEM,     encode(0b0100111, 0b101, 0b0000000), InstructionType::STORE_V,  Opcode::VSE16_V,         InstructionFormat::V,     "vse16.v" },
+        { MASK_VMEM,     encode(0b0100111, 0b110, 0b0000000), InstructionType::STORE_V,  Opcode::VSE32_V,         InstructionFormat::V,     "vse32.v" },
+        { MASK_VMEM,     encode(0b0100111, 0b111, 0b0000000), InstructionType::STORE_V,  Opcode::VSE64_V,         InstructionFormat::V,     "vse64.v" },
+        { MASK_V,        encode(0b0100111, 0b000, 0b0000100), InstructionType::STORE_V,  Opcode::VSSE8_V,         InstructionFormat::V,     "vsse8.v" },
+        { MASK_V,        encode(0b0100111, 0b101, 0b0000100), InstructionType::STORE_V,  Opcode::VSSE16_V,        InstructionFormat::V,     "vsse16.v" },
+        { MASK_V,        encode(0b0100111, 0b110, 0b0000100), InstructionType::STORE_V,  Opcode::VSSE32_V,        InstructionFormat::V,     "vsse32.v" },
+        { MASK_V,        encode(0b0100111, 0b111, 0b0000100), InstructionType::STORE_V,  Opcode::VSSE64_V,        InstructionFormat::V,     "vsse64.v" },
+        { MASK_F3_F12,   encodeF12(0b0100111, 0b000, 0x02B),  InstructionType::STORE_V,  Opcode::VSM_V,           InstructionFormat::V,     "vsm.v" },
+        { MASK_F3_F12,   encodeF12(0b0100111, 0b000, 0x028),  InstructionType::STORE_V,  Opcode::VS1R_V,          InstructionFormat::V,     "vs1r.v" },
+        { MASK_F3_F12,   encodeF12(0b0100111, 0b000, 0x228),  InstructionType::STORE_V,  Opcode::VS2R_V,          InstructionFormat::V,     "vs2r.v" },
+        { MASK_F3_F12,   encodeF12(0b0100111, 0b000, 0x628),  InstructionType::STORE_V,  Opcode::VS4R_V,          InstructionFormat::V,     "vs4r.v" },
+        { MASK_F3_F12,   encodeF12(0b0100111, 0b000, 0xE28),  InstructionType::STORE_V,  Opcode::VS8R_V,          InstructionFormat::V,     "vs8r.v" },
+        { MASK_V,        encodeV(OPIVV, 0b0000000),           InstructionType::OP_V,     Opcode::VADD_VV,         InstructionFormat::V,     "vadd.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b0000000),           InstructionType::OP_V,     Opcode::VADD_VX,         InstructionFormat::V,     "vadd.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b0000000),           InstructionType::OP_V,     Opcode::VADD_VI,         InstructionFormat::V,     "vadd.vi" },
+        { MASK_V,        encodeV(OPIVV, 0b0000100),           InstructionType::OP_V,     Opcode::VSUB_VV,         InstructionFormat::V,     "vsub.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b0000100),           InstructionType::OP_V,     Opcode::VSUB_VX,         InstructionFormat::V,     "vsub.vx" },
+        { MASK_V,        encodeV(OPIVX, 0b0000110),           InstructionType::OP_V,     Opcode::VRSUB_VX,        InstructionFormat::V,     "vrsub.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b0000110),           InstructionType::OP_V,     Opcode::VRSUB_VI,        InstructionFormat::V,     "vrsub.vi" },
+        { MASK_V,        encodeV(OPIVV, 0b0001000),           InstructionType::OP_V,     Opcode::VMINU_VV,        InstructionFormat::V,     "vminu.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b0001000),           InstructionType::OP_V,     Opcode::VMINU_VX,        InstructionFormat::V,     "vminu.vx" },
+        { MASK_V,        encodeV(OPIVV, 0b0001010),           InstructionType::OP_V,     Opcode::VMIN_VV,         InstructionFormat::V,     "vmin.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b0001010),           InstructionType::OP_V,     Opcode::VMIN_VX,         InstructionFormat::V,     "vmin.vx" },
+        { MASK_V,        encodeV(OPIVV, 0b0001100),           InstructionType::OP_V,     Opcode::VMAXU_VV,        InstructionFormat::V,     "vmaxu.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b0001100),           InstructionType::OP_V,     Opcode::VMAXU_VX,        InstructionFormat::V,     "vmaxu.vx" },
+        { MASK_V,        encodeV(OPIVV, 0b0001110),           InstructionType::OP_V,     Opcode::VMAX_VV,         InstructionFormat::V,     "vmax.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b0001110),           InstructionType::OP_V,     Opcode::VMAX_VX,         InstructionFormat::V,     "vmax.vx" },
+        { MASK_V,        encodeV(OPIVV, 0b0010010),           InstructionType::OP_V,     Opcode::VAND_VV,         InstructionFormat::V,     "vand.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b0010010),           InstructionType::OP_V,     Opcode::VAND_VX,         InstructionFormat::V,     "vand.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b0010010),           InstructionType::OP_V,     Opcode::VAND_VI,         InstructionFormat::V,     "vand.vi" },
+        { MASK_V,        encodeV(OPIVV, 0b0010100),           InstructionType::OP_V,     Opcode::VOR_VV,          InstructionFormat::V,     "vor.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b0010100),           InstructionType::OP_V,     Opcode::VOR_VX,          InstructionFormat::V,     "vor.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b0010100),           InstructionType::OP_V,     Opcode::VOR_VI,          InstructionFormat::V,     "vor.vi" },
+        { MASK_V,        encodeV(OPIVV, 0b0010110),           InstructionType::OP_V,     Opcode::VXOR_VV,         InstructionFormat::V,     "vxor.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b0010110),           InstructionType::OP_V,     Opcode::VXOR_VX,         InstructionFormat::V,     "vxor.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b0010110),           InstructionType::OP_V,     Opcode::VXOR_VI,         InstructionFormat::V,     "vxor.vi" },
+        { MASK_V,        encodeV(OPIVX, 0b0011100),           InstructionType::OP_V,     Opcode::VSLIDEUP_VX,     InstructionFormat::V,     "vslideup.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b0011100),           InstructionType::OP_V,     Opcode::VSLIDEUP_VI,     InstructionFormat::V,     "vslideup.vi" },
+        { MASK_V,        encodeV(OPIVX, 0b0011110),           InstructionType::OP_V,     Opcode::VSLIDEDOWN_VX,   InstructionFormat::V,     "vslidedown.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b0011110),           InstructionType::OP_V,     Opcode::VSLIDEDOWN_VI,   InstructionFormat::V,     "vslidedown.vi" },
+        { MASK_F3_F7,    encodeV(OPIVV, 0b0101110),           InstructionType::OP_V,     Opcode::VMERGE_VVM,      InstructionFormat::V,     "vmerge.vvm" },
+        { MASK_F3_F7,    encodeV(OPIVX, 0b0101110),           InstructionType::OP_V,     Opcode::VMERGE_VXM,      InstructionFormat::V,     "vmerge.vxm" },
+        { MASK_F3_F7,    encodeV(OPIVI, 0b0101110),           InstructionType::OP_V,     Opcode::VMERGE_VIM,      InstructionFormat::V,     "vmerge.vim" },
+        { MASK_F3_F12,   encodeV(OPIVV, 0b0101111),           InstructionType::OP_V,     Opcode::VMV_V_V,         InstructionFormat::V,     "vmv.v.v" },
+        { MASK_F3_F12,   encodeV(OPIVX, 0b0101111),           InstructionType::OP_V,     Opcode::VMV_V_X,         InstructionFormat::V,     "vmv.v.x" },
+        { MASK_F3_F12,   encodeV(OPIVI, 0b0101111),           InstructionType::OP_V,     Opcode::VMV_V_I,         InstructionFormat::V,     "vmv.v.i" },
+        { MASK_V,        encodeV(OPIVV, 0b0110000),           InstructionType::OP_V,     Opcode::VMSEQ_VV,        InstructionFormat::V,     "vmseq.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b0110000),           InstructionType::OP_V,     Opcode::VMSEQ_VX,        InstructionFormat::V,     "vmseq.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b0110000),           InstructionType::OP_V,     Opcode::VMSEQ_VI,        InstructionFormat::V,     "vmseq.vi" },
+        { MASK_V,        encodeV(OPIVV, 0b0110010),           InstructionType::OP_V,     Opcode::VMSNE_VV,        InstructionFormat::V,     "vmsne.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b0110010),           InstructionType::OP_V,     Opcode::VMSNE_VX,        InstructionFormat::V,     "vmsne.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b0110010),           InstructionType::OP_V,     Opcode::VMSNE_VI,        InstructionFormat::V,     "vmsne.vi" },
+        { MASK_V,        encodeV(OPIVV, 0b0110100),           InstructionType::OP_V,     Opcode::VMSLTU_VV,       InstructionFormat::V,     "vmsltu.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b0110100),           InstructionType::OP_V,     Opcode::VMSLTU_VX,       InstructionFormat::V,     "vmsltu.vx" },
+        { MASK_V,        encodeV(OPIVV, 0b0110110),           InstructionType::OP_V,     Opcode::VMSLT_VV,        InstructionFormat::V,     "vmslt.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b0110110),           InstructionType::OP_V,     Opcode::VMSLT_VX,        InstructionFormat::V,     "vmslt.vx" },
+        { MASK_V,        encodeV(OPIVV, 0b0111000),           InstructionType::OP_V,     Opcode::VMSLEU_VV,       InstructionFormat::V,     "vmsleu.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b0111000),           InstructionType::OP_V,     Opcode::VMSLEU_VX,       InstructionFormat::V,     "vmsleu.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b0111000),           InstructionType::OP_V,     Opcode::VMSLEU_VI,       InstructionFormat::V,     "vmsleu.vi" },
+        { MASK_V,        encodeV(OPIVV, 0b0111010),           InstructionType::OP_V,     Opcode::VMSLE_VV,        InstructionFormat::V,     "vmsle.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b0111010),           InstructionType::OP_V,     Opcode::VMSLE_VX,        InstructionFormat::V,     "vmsle.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b0111010),           InstructionType::OP_V,     Opcode::VMSLE_VI,        InstructionFormat::V,     "vmsle.vi" },
+        { MASK_V,        encodeV(OPIVX, 0b0111100),           InstructionType::OP_V,     Opcode::VMSGTU_VX,       InstructionFormat::V,     "vmsgtu.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b0111100),           InstructionType::OP_V,     Opcode::VMSGTU_VI,       InstructionFormat::V,     "vmsgtu.vi" },
+        { MASK_V,        encodeV(OPIVX, 0b0111110),           InstructionType::OP_V,     Opcode::VMSGT_VX,        InstructionFormat::V,     "vmsgt.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b0111110),           InstructionType::OP_V,     Opcode::VMSGT_VI,        InstructionFormat::V,     "vmsgt.vi" },
+        { MASK_V,        encodeV(OPIVV, 0b1000000),           InstructionType::OP_V,     Opcode::VSADDU_VV,       InstructionFormat::V,     "vsaddu.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b1000000),           InstructionType::OP_V,     Opcode::VSADDU_VX,       InstructionFormat::V,     "vsaddu.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b1000000),           InstructionType::OP_V,     Opcode::VSADDU_VI,       InstructionFormat::V,     "vsaddu.vi" },
+        { MASK_V,        encodeV(OPIVV, 0b1000010),           InstructionType::OP_V,     Opcode::VSADD_VV,        InstructionFormat::V,     "vsadd.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b1000010),           InstructionType::OP_V,     Opcode::VSADD_VX,        InstructionFormat::V,     "vsadd.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b1000010),           InstructionType::OP_V,     Opcode::VSADD_VI,        InstructionFormat::V,     "vsadd.vi" },
+        { MASK_V,        encodeV(OPIVV, 0b1000100),           InstructionType::OP_V,     Opcode::VSSUBU_VV,       InstructionFormat::V,     "vssubu.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b1000100),           InstructionType::OP_V,     Opcode::VSSUBU_VX,       InstructionFormat::V,     "vssubu.vx" },
+        { MASK_V,        encodeV(OPIVV, 0b1000110),           InstructionType::OP_V,     Opcode::VSSUB_VV,        InstructionFormat::V,     "vssub.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b1000110),           InstructionType::OP_V,     Opcode::VSSUB_VX,        InstructionFormat::V,     "vssub.vx" },
+        { MASK_V,        encodeV(OPIVV, 0b1001010),           InstructionType::OP_V,     Opcode::VSLL_VV,         InstructionFormat::V,     "vsll.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b1001010),           InstructionType::OP_V,     Opcode::VSLL_VX,         InstructionFormat::V,     "vsll.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b1001010),           InstructionType::OP_V,     Opcode::VSLL_VI,         InstructionFormat::V,     "vsll.vi" },
+        { MASK_V_VS1_VM, encodeV(OPIVI, 0b1001111, 0b00000),  InstructionType::OP_V,     Opcode::VMV1R_V,         InstructionFormat::V,     "vmv1r.v" },
+        { MASK_V_VS1_VM, encodeV(OPIVI, 0b1001111, 0b00001),  InstructionType::OP_V,     Opcode::VMV2R_V,         InstructionFormat::V,     "vmv2r.v" },
+        { MASK_V_VS1_VM, encodeV(OPIVI, 0b1001111, 0b00011),  InstructionType::OP_V,     Opcode::VMV4R_V,         InstructionFormat::V,     "vmv4r.v" },
+        { MASK_V_VS1_VM, encodeV(OPIVI, 0b1001111, 0b00111),  InstructionType::OP_V,     Opcode::VMV8R_V,         InstructionFormat::V,     "vmv8r.v" },
+        { MASK_V,        encodeV(OPIVV, 0b1010000),           InstructionType::OP_V,     Opcode::VSRL_VV,         InstructionFormat::V,     "vsrl.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b1010000),           InstructionType::OP_V,     Opcode::VSRL_VX,         InstructionFormat::V,     "vsrl.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b1010000),           InstructionType::OP_V,     Opcode::VSRL_VI,         InstructionFormat::V,     "vsrl.vi" },
+        { MASK_V,        encodeV(OPIVV, 0b1010010),           InstructionType::OP_V,     Opcode::VSRA_VV,         InstructionFormat::V,     "vsra.vv" },
+        { MASK_V,        encodeV(OPIVX, 0b1010010),           InstructionType::OP_V,     Opcode::VSRA_VX,         InstructionFormat::V,     "vsra.vx" },
+        { MASK_V,        encodeV(OPIVI, 0b1010010),           InstructionType::OP_V,     Opcode::VSRA_VI,         InstructionFormat::V,     "vsra.vi" },
+        { MASK_V,        encodeV(OPIVV, 0b1100000),           InstructionType::OP_V,     Opcode::VWREDSUMU_VS,    InstructionFormat::V,     "vwredsumu.vs" },
+        { MASK_V,        encodeV(OPIVV, 0b1100010),           InstructionType::OP_V,     Opcode::VWREDSUM_VS,     InstructionFormat::V,     "vwredsum.vs" },
+        { MASK_V,        encodeV(OPMVV, 0b0000000),           InstructionType::OP_V,     Opcode::VREDSUM_VS,      InstructionFormat::V,     "vredsum.vs" },
+        { MASK_V,        encodeV(OPMVV, 0b0000010),           InstructionType::OP_V,     Opcode::VREDAND_VS,      InstructionFormat::V,     "vredand.vs" },
+        { MASK_V,        encodeV(OPMVV, 0b0000100),           InstructionType::OP_V,     Opcode::VREDOR_VS,       InstructionFormat::V,     "vredor.vs" },
+        { MASK_V,        encodeV(OPMVV, 0b0000110),           InstructionType::OP_V,     Opcode::VREDXOR_VS,      InstructionFormat::V,     "vredxor.vs" },
+        { MASK_V,        encodeV(OPMVV, 0b0001000),           InstructionType::OP_V,     Opcode::VREDMINU_VS,     InstructionFormat::V,     "vredminu.vs" },
+        { MASK_V,        encodeV(OPMVV, 0b0001010),           InstructionType::OP_V,     Opcode::VREDMIN_VS,      InstructionFormat::V,     "vredmin.vs" },
+        { MASK_V,        encodeV(OPMVV, 0b0001100),           InstructionType::OP_V,     Opcode::VREDMAXU_VS,     InstructionFormat::V,     "vredmaxu.vs" },
+        { MASK_V,        encodeV(OPMVV, 0b0001110),           InstructionType::OP_V,     Opcode::VREDMAX_VS,      InstructionFormat::V,     "vredmax.vs" },
+        { MASK_V_VS1_VM, encodeV(OPMVV, 0b0100001, 0b00000),  InstructionType::OP_V,     Opcode::VMV_X_S,         InstructionFormat::V,     "vmv.x.s" },
+        { MASK_V_VS1,    encodeV(OPMVV, 0b0100000, 0b10000),  InstructionType::OP_V,     Opcode::VCPOP_M,         InstructionFormat::V,     "vcpop.m" },
+        { MASK_V_VS1,    encodeV(OPMVV, 0b0100000, 0b10001),  InstructionType::OP_V,     Opcode::VFIRST_M,        InstructionFormat::V,     "vfirst.m" },
+        { MASK_F3_F12,   encodeV(OPMVX, 0b0100001),           InstructionType::OP_V,     Opcode::VMV_S_X,         InstructionFormat::V,     "vmv.s.x" },
+        { MASK_V_VS1,    encodeV(OPMVV, 0b0100100, 0b00010),  InstructionType::OP_V,     Opcode::VZEXT_VF8,       InstructionFormat::V,     "vzext.vf8" },
+        { MASK_V_VS1,    encodeV(OPMVV, 0b0100100, 0b00011),  InstructionType::OP_V,     Opcode::VSEXT_VF8,       InstructionFormat::V,     "vsext.vf8" },
+        { MASK_V_VS1,    encodeV(OPMVV, 0b0100100, 0b00100),  InstructionType::OP_V,     Opcode::VZEXT_VF4,       InstructionFormat::V,     "vzext.vf4" },
+        { MASK_V_VS1,    encodeV(OPMVV, 0b0100100, 0b00101),  InstructionType::OP_V,     Opcode::VSEXT_VF4,       InstructionFormat::V,     "vsext.vf4" },
+        { MASK_V_VS1,    encodeV(OPMVV, 0b0100100, 0b00110),  InstructionType::OP_V,     Opcode::VZEXT_VF2,       InstructionFormat::V,     "vzext.vf2" },
+        { MASK_V_VS1,    encodeV(OPMVV, 0b0100100, 0b00111),  InstructionType::OP_V,     Opcode::VSEXT_VF2,       InstructionFormat::V,     "vsext.vf2" },
+        { MASK_VID,      encodeV(OPMVV, 0b0101000, 0b10001),  InstructionType::OP_V,     Opcode::VID_V,           InstructionFormat::V,     "vid.v" },
+        { MASK_F3_F7,    encodeV(OPMVV, 0b0110001),           InstructionType::OP_V,     Opcode::VMANDN_MM,       InstructionFormat::V,     "vmandn.mm" },
+        { MASK_F3_F7,    encodeV(OPMVV, 0b0110011),           InstructionType::OP_V,     Opcode::VMAND_MM,        InstructionFormat::V,     "vmand.mm" },
+        { MASK_F3_F7,    encodeV(OPMVV, 0b0110101),           InstructionType::OP_V,     Opcode::VMOR_MM,         InstructionFormat::V,     "vmor.mm" },
+        { MASK_F3_F7,    encodeV(OPMVV, 0b0110111),           InstructionType::OP_V,     Opcode::VMXOR_MM,        InstructionFormat::V,     "vmxor.mm" },
+        { MASK_F3_F7,    encodeV(OPMVV, 0b0111001),           InstructionType::OP_V,     Opcode::VMORN_MM,        InstructionFormat::V,     "vmorn.mm" },
+        { MASK_F3_F7,    encodeV(OPMVV, 0b0111011),           InstructionType::OP_V,     Opcode::VMNAND_MM,       InstructionFormat::V,     "vmnand.mm" },
+        { MASK_F3_F7,    encodeV(OPMVV, 0b0111101),           InstructionType::OP_V,     Opcode::VMNOR_MM,        InstructionFormat::V,     "vmnor.mm" },
+        { MASK_F3_F7,    encodeV(OPMVV, 0b0111111),           InstructionType::OP_V,     Opcode::VMXNOR_MM,       InstructionFormat::V,     "vmxnor.mm" },
+        { MASK_V,        encodeV(OPMVV, 0b1000000),           InstructionType::OP_V,     Opcode::VDIVU_VV,        InstructionFormat::V,     "vdivu.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1000000),           InstructionType::OP_V,     Opcode::VDIVU_VX,        InstructionFormat::V,     "vdivu.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1000010),           InstructionType::OP_V,     Opcode::VDIV_VV,         InstructionFormat::V,     "vdiv.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1000010),           InstructionType::OP_V,     Opcode::VDIV_VX,         InstructionFormat::V,     "vdiv.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1000100),           InstructionType::OP_V,     Opcode::VREMU_VV,        InstructionFormat::V,     "vremu.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1000100),           InstructionType::OP_V,     Opcode::VREMU_VX,        InstructionFormat::V,     "vremu.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1000110),           InstructionType::OP_V,     Opcode::VREM_VV,         InstructionFormat::V,     "vrem.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1000110),           InstructionType::OP_V,     Opcode::VREM_VX,         InstructionFormat::V,     "vrem.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1001000),           InstructionType::OP_V,     Opcode::VMULHU_VV,       InstructionFormat::V,     "vmulhu.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1001000),           InstructionType::OP_V,     Opcode::VMULHU_VX,       InstructionFormat::V,     "vmulhu.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1001010),           InstructionType::OP_V,     Opcode::VMUL_VV,         InstructionFormat::V,     "vmul.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1001010),           InstructionType::OP_V,     Opcode::VMUL_VX,         InstructionFormat::V,     "vmul.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1001100),           InstructionType::OP_V,     Opcode::VMULHSU_VV,      InstructionFormat::V,     "vmulhsu.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1001100),           InstructionType::OP_V,     Opcode::VMULHSU_VX,      InstructionFormat::V,     "vmulhsu.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1001110),           InstructionType::OP_V,     Opcode::VMULH_VV,        InstructionFormat::V,     "vmulh.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1001110),           InstructionType::OP_V,     Opcode::VMULH_VX,        InstructionFormat::V,     "vmulh.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1010010),           InstructionType::OP_V,     Opcode::VMADD_VV,        InstructionFormat::V,     "vmadd.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1010010),           InstructionType::OP_V,     Opcode::VMADD_VX,        InstructionFormat::V,     "vmadd.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1010110),           InstructionType::OP_V,     Opcode::VNMSUB_VV,       InstructionFormat::V,     "vnmsub.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1010110),           InstructionType::OP_V,     Opcode::VNMSUB_VX,       InstructionFormat::V,     "vnmsub.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1011010),           InstructionType::OP_V,     Opcode::VMACC_VV,        InstructionFormat::V,     "vmacc.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1011010),           InstructionType::OP_V,     Opcode::VMACC_VX,        InstructionFormat::V,     "vmacc.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1011110),           InstructionType::OP_V,     Opcode::VNMSAC_VV,       InstructionFormat::V,     "vnmsac.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1011110),           InstructionType::OP_V,     Opcode::VNMSAC_VX,       InstructionFormat::V,     "vnmsac.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1100000),           InstructionType::OP_V,     Opcode::VWADDU_VV,       InstructionFormat::V,     "vwaddu.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1100000),           InstructionType::OP_V,     Opcode::VWADDU_VX,       InstructionFormat::V,     "vwaddu.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1100010),           InstructionType::OP_V,     Opcode::VWADD_VV,        InstructionFormat::V,     "vwadd.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1100010),           InstructionType::OP_V,     Opcode::VWADD_VX,        InstructionFormat::V,     "vwadd.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1100100),           InstructionType::OP_V,     Opcode::VWSUBU_VV,       InstructionFormat::V,     "vwsubu.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1100100),           InstructionType::OP_V,     Opcode::VWSUBU_VX,       InstructionFormat::V,     "vwsubu.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1100110),           InstructionType::OP_V,     Opcode::VWSUB_VV,        InstructionFormat::V,     "vwsub.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1100110),           InstructionType::OP_V,     Opcode::VWSUB_VX,        InstructionFormat::V,     "vwsub.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1110000),           InstructionType::OP_V,     Opcode::VWMULU_VV,       InstructionFormat::V,     "vwmulu.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1110000),           InstructionType::OP_V,     Opcode::VWMULU_VX,       InstructionFormat::V,     "vwmulu.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1110110),           InstructionType::OP_V,     Opcode::VWMUL_VV,        InstructionFormat::V,     "vwmul.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1110110),           InstructionType::OP_V,     Opcode::VWMUL_VX,        InstructionFormat::V,     "vwmul.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1111000),           InstructionType::OP_V,     Opcode::VWMACCU_VV,      InstructionFormat::V,     "vwmaccu.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1111000),           InstructionType::OP_V,     Opcode::VWMACCU_VX,      InstructionFormat::V,     "vwmaccu.vx" },
+        { MASK_V,        encodeV(OPMVV, 0b1111010),           InstructionType::OP_V,     Opcode::VWMACC_VV,       InstructionFormat::V,     "vwmacc.vv" },
+        { MASK_V,        encodeV(OPMVX, 0b1111010),           InstructionType::OP_V,     Opcode::VWMACC_VX,       InstructionFormat::V,     "vwmacc.vx" },
+    };
+};
+
+#endif /* __INSTRUCTION_TABLE_HPP__ */
@@ -0,0 +1,277 @@
+#include "lockstep.hpp"
+#include "disassembler.hpp"
+#include "emulator_exception.hpp"
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+
+using RV32::LockstepChecker;
+using RV32::HartConfig;
+
+static std::string hex(uint64_t val, int width = 8) {
+    std::ostringstream out;
+    out << "0x" << std::hex << std::setw(width) << std::setfill('0') << val;
+    return out.str();
+}
+
+// Most significant byte first, like a scalar register
+static std::string hex(const uint8_t *bytes, uint32_t size) {
+    std::ostringstream out;
+    out << "0x" << std::hex << std::setfill('0');
+    for(uint32_t i = size; i > 0; --i) {
+        out << std::setw(2) << static_cast<uint32_t>(bytes[i - 1]);
+    }
+    return out.str();
+}
+
+// The CSR table is fixed, so the implemented addresses are collected once instead of on every compare
+static const std::vector<uint32_t>& getImplementedCSRs() {
+    static const std::vector<uint32_t> addresses = []() {
+        std::vector<uint32_t> implemented;
+        for(uint32_t addr = 0; addr < RV32::NUM_CSRS; ++addr) {
+            if(RV32::getCSRDescriptor(addr).accessType != RV32::CSRAccessType::INVALID) {
+                implemented.push_back(addr);
+            }
+        }
+        return implemented;
+    }();
+    return addresses;
+}
+
+LockstepChecker::LockstepChecker(uint32_t pc, MemoryMapManager &engineMem, MemoryMapManager &referenceMem,
+                                 const HartConfig& config, Granularity granularity):
+    engine(pc, engineMem, makeEngineConfig(config)), reference(pc, referenceMem, makeReferenceConfig(config)),
+    engineMem(engineMem), referenceMem(referenceMem), granularity(granularity),
+    timeSource(config.timeSource), instructionsPerTick(config.instructionsPerTick),
+    lastTime(std::chrono::high_resolution_clock::now()), timebasePeriod(SECONDS_TO_NANSECONDS * (1.0 / config.timebaseFreq)) {
+    engineMem.setWriteObserver([this](uint32_t addr, uint32_t size, uint32_t val) {
+        engineWrites.push_back({addr, size, val});
+    });
+    referenceMem.setWriteObserver([this](uint32_t addr, uint32_t size, uint32_t val) {
+        referenceWrites.push_back({addr, size, val});
+    });
+}
+
+HartConfig LockstepChecker::makeEngineConfig(const HartConfig& config) {
+    HartConfig engineConfig = config;
+    engineConfig.timeSource = TimeSource::EXTERNAL;
+
+    // Console input is nondeterministic, so whatever the engine reads is replayed to the reference
+    engineConfig.getCharCallback = [this, getChar = config.getCharCallback]() {
+        char c = getChar();
+        inputQueue.push_back(c);
+        return c;
+    };
+    return engineConfig;
+}
+
+HartConfig LockstepChecker::makeReferenceConfig(const HartConfig& config) {
+    HartConfig referenceConfig = config;
+    referenceConfig.timeSource = TimeSource::EXTERNAL;
+    referenceConfig.enableFusion = false;
+    // skipIdleLoops is kept, the skipped time is visible to the guest
+
+    referenceConfig.shutdownCallback = []() {};
+    referenceConfig.putCharCallback = [](char) {};
+    referenceConfig.getCharCallback = [this]() {
+        if(inputQueue.empty()) {
+            return static_cast<char>(-1);
+        }
+        char c = inputQueue.front();
+        inputQueue.pop_front();
+        return c;
+    };
+    return referenceConfig;
+}
+
+void LockstepChecker::syncReference() {
+    reference.setState(engine.getState());
+    engineWrites.clear();
+    referenceWrites.clear();
+    inputQueue.clear();
+    history.clear();
+
+    if(timeSource == TimeSource::INSTRET || timeSource == TimeSource::CYCLE) {
+        lastTick = getTickUnits() / instructionsPerTick;
+    }
+}
+
+void LockstepChecker::enableTimingModel(const TimingConfig &config) {
+    engineTiming = std::make_unique<TimingModel>(config);
+    referenceTiming = std::make_unique<TimingModel>(config);
+    engine.setTimingModel(engineTiming.get());
+    reference.setTimingModel(referenceTiming.get());
+}
+
+uint64_t LockstepChecker::getTickUnits() const {
+    return timeSource == TimeSource::CYCLE ? engine.getCycle() : engine.getInstret();
+}
+
+bool LockstepChecker::step() {
+    if(diverged) {
+        return false;
+    }
+
+    advanceTime();
+
+    engine.stepInstruction();
+
+    // The engine may retire several instructions per step, which ran straight-line if the engine
+    // ends up right after the last of them. A step that only takes a fetch fault retires none,
+    // so the reference always steps at least once.
+    uint32_t fallThroughPC = reference.getPC();
+    bool straightLine = true;
+    do {
+        recordHistory();
+        const RetiredInstruction &retired = history.back();
+        straightLine &= retired.fetched && retired.pc == fallThroughPC;
+        fallThroughPC = retired.pc + (isCompressed(retired.bits) ? 2 : 4);
+        reference.stepInstruction();
+    } while(reference.getInstret() < engine.getInstret());
+
+    if(granularity == Granularity::BLOCK && straightLine && engine.getPC() == fallThroughPC) {
+        return true;
+    }
+
+    return compare();
+}
+
+void LockstepChecker::advanceTime() {
+    if(timeSource == TimeSource::INSTRET || timeSource == TimeSource::CYCLE) {
+        // Ticks are applied before each engine step, so both harts see them at the same point
+        uint64_t tick = getTickUnits() / instructionsPerTick;
+        engine.advanceTime(tick - lastTick);
+        reference.advanceTime(tick - lastTick);
+        lastTick = tick;
+        return;
+    }
+
+    auto currentTime = std::chrono::high_resolution_clock::now();
+    uint64_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(currentTime - lastTime).count();
+
+    if(duration >= timebasePeriod) {
+        engine.advanceTime(duration / timebasePeriod);
+        reference.advanceTime(duration / timebasePeriod);
+        lastTime = currentTime;
+    }
+}
+
+void LockstepChecker::recordHistory() {
+    RetiredInstruction retired { reference.getPC(), 0, false };
+
+    try {
+        retired.fetched = reference.peekInstruction(retired.pc, retired.bits);
+    } catch(EmulatorException &ee) {
+        retired.fetched = false;
+    }
+
+    history.push_back(retired);
+    if(history.size() > CONTEXT_WINDOW) {
+        history.pop_front();
+    }
+}
+
+bool LockstepChecker::compare() {
+    std::ostringstream out;
+
+    if(engine.getPC() != reference.getPC()) {
+        out << "  pc: engine " << hex(engine.getPC()) << " reference " << hex(reference.getPC()) << "\n";
+    }
+
+    if(engine.isSupervisorMode() != reference.isSupervisorMode()) {
+        out << "  mode: engine " << (engine.isSupervisorMode() ? "S" : "U")
+            << " reference " << (reference.isSupervisorMode() ? "S" : "U") << "\n";
+    }
+
+    if(engine.isReservationSetValid() != reference.isReservationSetValid()) {
+        out << "  reservation: engine " << engine.isReservationSetValid()
+            << " reference " << reference.isReservationSetValid() << "\n";
+    }
+
+    if(engine.getTimeCompare() != reference.getTimeCompare()) {
+        out << "  timecmp: engine " << engine.getTimeCompare() << " reference " << reference.getTimeCompare() << "\n";
+    }
+
+    const Registers &engineGPR = engine.getRegisters();
+    const Registers &referenceGPR = reference.getRegisters();
+    for(uint32_t i = 0; i < Registers::NUM_GPR; ++i) {
+        if(engineGPR.r[i] != referenceGPR.r[i]) {
+            out << "  " << getRegisterName(i) << ": engine " << hex(engineGPR.r[i])
+                << " reference " << hex(referenceGPR.r[i]) << "\n";
+        }
+    }
+
+    const FloatRegisters &engineFPR = engine.getFloatRegisters();
+    const FloatRegisters &referenceFPR = reference.getFloatRegisters();
+    for(uint32_t i = 0; i < FloatRegisters::NUM_FPR; ++i) {
+        if(engineFPR.f[i] != referenceFPR.f[i]) {
+            out << "  " << getFloatRegisterName(i) << ": engine " << hex(engineFPR.f[i], 16)
+                << " reference " << hex(referenceFPR.f[i], 16) << "\n";
+        }
+    }
+
+    CSRs &engineCSR = engine.getCSRs();
+    CSRs &referenceCSR = reference.getCSRs();
+    uint32_t vlenb = engineCSR.vlenb;
+    for(uint32_t i = 0; i < VectorRegisters::NUM_VR; ++i) {
+        const uint8_t *engineReg = engine.getVectorRegisters().get(i, vlenb);
+        const uint8_t *referenceReg = reference.getVectorRegisters().get(i, vlenb);
+        if(std::memcmp(engineReg, referenceReg, vlenb) != 0) {
+            out << "  " << getVectorRegisterName(i) << ": engine " << hex(engineReg, vlenb)
+                << " reference " << hex(referenceReg, vlenb) << "\n";
+        }
+    }
+
+    for(uint32_t addr : getImplementedCSRs()) {
+        uint32_t engineVal = engineCSR[addr];
+        uint32_t referenceVal = referenceCSR[addr];
+        if(engineVal != referenceVal) {
+            out << "  csr " << hex(addr) << ": engine " << hex(engineVal)
+                << " reference " << hex(referenceVal) << "\n";
+        }
+    }
+
+    if(engineWrites != referenceWrites) {
+        out << "  memory writes:\n";
+        for(size_t i = 0; i < std::max(engineWrites.size(), referenceWrites.size()); ++i) {
+            out << "    engine ";
+            if(i < engineWrites.size()) {
+                out << engineWrites[i].size << "@" << hex(engineWrites[i].addr) << "=" << hex(engineWrites[i].val);
+            } else {
+                out << "-";
+            }
+            out << "  reference ";
+            if(i < referenceWrites.size()) {
+                out << referenceWrites[i].size << "@" << hex(referenceWrites[i].addr) << "=" << hex(referenceWrites[i].val);
+            } else {
+                out << "-";
+            }
+            out << "\n";
+        }
+    }
+
+    engineWrites.clear();
+    referenceWrites.clear();
+
+    if(out.tellp() == 0) {
+        return true;
+    }
+
+    std::ostringstream header;
+    header << "Lockstep divergence after " << reference.getInstret() << " instructions\n";
+    header << out.str();
+    header << "Last instructions retired by the reference:\n";
+    for(const auto& retired : history) {
+        header << "  " << hex(retired.pc) << ": ";
+        if(retired.fetched) {
+            header << hex(retired.bits) << "  " << disassemble(Instruction { retired.bits }, retired.pc);
+        } else {
+            header << "<unmapped>";
+        }
+        header << "\n";
+    }
+
+    report = header.str();
+    diverged = true;
+    return false;
+}
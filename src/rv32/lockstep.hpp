@@ -0,0 +1,92 @@
+#ifndef __LOCKSTEP_HPP__
+#define __LOCKSTEP_HPP__
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include "hart.hpp"
+
+namespace RV32 {
+    // Runs an engine hart and a reference interpreter hart side by side on cloned
+    // state and reports the first point at which their architectural state differs.
+    class LockstepChecker {
+        public:
+            enum class Granularity: uint32_t {
+                INSTRUCTION,    // compare after every engine step
+                BLOCK           // compare only when the engine leaves straight-line code
+            };
+
+            LockstepChecker(uint32_t pc, MemoryMapManager &engineMem, MemoryMapManager &referenceMem,
+                            const HartConfig& config, Granularity granularity = Granularity::INSTRUCTION);
+
+            Hart& getEngine() { return engine; }
+            Hart& getReference() { return reference; }
+
+            // Clones the engine's architectural state into the reference hart.
+            // Memory contents must be cloned by the caller.
+            void syncReference();
+
+            // Attaches a timing model with the same configuration to both harts, so cycle is compared too
+            void enableTimingModel(const TimingConfig &config);
+
+            // Steps both harts, returns false once they have diverged
+            bool step();
+
+            const std::string& getDivergenceReport() const { return report; }
+        private:
+            static constexpr size_t CONTEXT_WINDOW = 16;
+            const uint64_t SECONDS_TO_NANSECONDS = 1000000000;
+
+            struct MemoryWrite {
+                uint32_t addr;
+                uint32_t size;
+                uint32_t val;
+
+                bool operator==(const MemoryWrite& other) const {
+                    return addr == other.addr && size == other.size && val == other.val;
+                }
+            };
+
+            struct RetiredInstruction {
+                uint32_t pc;
+                uint32_t bits;
+                bool fetched;
+            };
+
+            std::deque<char> inputQueue;
+            Hart engine;
+            Hart reference;
+            MemoryMapManager &engineMem;
+            MemoryMapManager &referenceMem;
+            const Granularity granularity;
+
+            std::vector<MemoryWrite> engineWrites;
+            std::vector<MemoryWrite> referenceWrites;
+            std::deque<RetiredInstruction> history;
+
+            std::unique_ptr<TimingModel> engineTiming;
+            std::unique_ptr<TimingModel> referenceTiming;
+
+            // Both harts run with external time, fed from the host clock or from the engine's instret or cycle
+            const TimeSource timeSource;
+            const uint32_t instructionsPerTick;
+            uint64_t lastTick = 0;
+
+            std::chrono::time_point<std::chrono::high_resolution_clock> lastTime;
+            const uint64_t timebasePeriod;
+
+            bool diverged = false;
+            std::string report;
+
+            HartConfig makeEngineConfig(const HartConfig& config);
+            HartConfig makeReferenceConfig(const HartConfig& config);
+
+            void advanceTime();
+            uint64_t getTickUnits() const;
+            void recordHistory();
+            bool compare();
+    };
+};
+
+#endif /* __LOCKSTEP_HPP__ */
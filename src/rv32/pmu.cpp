@@ -0,0 +1,229 @@
+#include "pmu.hpp"
+
+using RV32::PerformanceMonitor;
+using RV32::PMUEvent;
+using RV32::PMUEventSources;
+using RV32::SBIResult;
+using RV32::CSRs;
+
+namespace {
+    constexpr int32_t SBI_SUCCESS = 0;
+    constexpr int32_t SBI_ERR_NOT_SUPPORTED = -2;
+    constexpr int32_t SBI_ERR_INVALID_PARAM = -3;
+    constexpr int32_t SBI_ERR_ALREADY_STARTED = -7;
+    constexpr int32_t SBI_ERR_ALREADY_STOPPED = -8;
+
+    constexpr uint32_t FID_NUM_COUNTERS = 0;
+    constexpr uint32_t FID_COUNTER_GET_INFO = 1;
+    constexpr uint32_t FID_COUNTER_CONFIG_MATCHING = 2;
+    constexpr uint32_t FID_COUNTER_START = 3;
+    constexpr uint32_t FID_COUNTER_STOP = 4;
+
+    constexpr uint32_t CFG_FLAG_SKIP_MATCH = 1 << 0;
+    constexpr uint32_t CFG_FLAG_CLEAR_VALUE = 1 << 1;
+    constexpr uint32_t CFG_FLAG_AUTO_START = 1 << 2;
+    constexpr uint32_t CFG_FLAG_SET_UINH = 1 << 5;
+    constexpr uint32_t CFG_FLAG_SET_SINH = 1 << 6;
+    constexpr uint32_t START_FLAG_SET_INIT_VALUE = 1 << 0;
+    constexpr uint32_t STOP_FLAG_RESET = 1 << 0;
+
+    constexpr uint32_t TOTAL_COUNTERS = 32; // cycle, time and instret come first
+    constexpr uint32_t COUNTER_WIDTH = 64;
+
+    constexpr uint32_t EVENT_TYPE_HARDWARE = 0;
+    constexpr uint32_t EVENT_TYPE_CACHE = 1;
+    constexpr uint32_t EVENT_TYPE_RAW = 2;
+
+    // Cache event codes are cache_id << 3 | op_id << 1 | result_id
+    constexpr uint32_t cacheEvent(uint32_t cache, uint32_t op, uint32_t result) {
+        return (cache << 3) | (op << 1) | result;
+    }
+
+    constexpr uint32_t CACHE_L1D = 0;
+    constexpr uint32_t CACHE_DTLB = 3;
+    constexpr uint32_t CACHE_ITLB = 4;
+    constexpr uint32_t CACHE_BPU = 5;
+    constexpr uint32_t OP_READ = 0;
+    constexpr uint32_t OP_WRITE = 1;
+    constexpr uint32_t RESULT_ACCESS = 0;
+    constexpr uint32_t RESULT_MISS = 1;
+
+    PMUEvent decodeEvent(uint32_t eventIdx, uint32_t eventData) {
+        uint32_t type = (eventIdx >> 16) & 0xF;
+        uint32_t code = eventIdx & 0xFFFF;
+
+        switch(type) {
+            case EVENT_TYPE_HARDWARE:
+                switch(code) {
+                    case 1: return PMUEvent::CYCLES;
+                    case 2: return PMUEvent::INSTRUCTIONS;
+                    case 5: return PMUEvent::BRANCHES;
+                    case 6: return PMUEvent::BRANCH_MISSES;
+                    default: return PMUEvent::NONE;
+                }
+            case EVENT_TYPE_CACHE:
+                switch(code) {
+                    case cacheEvent(CACHE_L1D, OP_READ, RESULT_ACCESS): return PMUEvent::LOADS;
+                    case cacheEvent(CACHE_L1D, OP_WRITE, RESULT_ACCESS): return PMUEvent::STORES;
+                    case cacheEvent(CACHE_DTLB, OP_READ, RESULT_MISS): return PMUEvent::DTLB_LOAD_MISSES;
+                    case cacheEvent(CACHE_DTLB, OP_WRITE, RESULT_MISS): return PMUEvent::DTLB_STORE_MISSES;
+                    case cacheEvent(CACHE_ITLB, OP_READ, RESULT_MISS): return PMUEvent::ITLB_MISSES;
+                    case cacheEvent(CACHE_BPU, OP_READ, RESULT_ACCESS): return PMUEvent::BRANCHES;
+                    case cacheEvent(CACHE_BPU, OP_READ, RESULT_MISS): return PMUEvent::BRANCH_MISSES;
+                    default: return PMUEvent::NONE;
+                }
+            case EVENT_TYPE_RAW:
+                if(code == 0 && eventData < static_cast<uint32_t>(PMUEvent::COUNT)) {
+                    return static_cast<PMUEvent>(eventData);
+                }
+                return PMUEvent::NONE;
+            default:
+                return PMUEvent::NONE;
+        }
+    }
+
+    bool isEventAvailable(PMUEvent event, const PMUEventSources &sources) {
+        switch(event) {
+            case PMUEvent::BRANCH_MISSES:
+                return sources.timingModel;
+            case PMUEvent::ITLB_MISSES:
+                return sources.itlb;
+            case PMUEvent::DTLB_LOAD_MISSES:
+            case PMUEvent::DTLB_STORE_MISSES:
+                return sources.dtlb;
+            default:
+                return true;
+        }
+    }
+
+    uint64_t readCounter(const CSRs &csr, uint32_t index) {
+        uint32_t i = index - PerformanceMonitor::FIRST_COUNTER;
+        return (static_cast<uint64_t>(csr.hpmcounterh[i]) << 32) | csr.hpmcounter[i];
+    }
+
+    void writeCounter(CSRs &csr, uint32_t index, uint64_t value) {
+        uint32_t i = index - PerformanceMonitor::FIRST_COUNTER;
+        csr.hpmcounter[i] = value & 0xFFFFFFFF;
+        csr.hpmcounterh[i] = value >> 32;
+    }
+
+    // Counters named by counter_idx_base and counter_idx_mask, zero if one is out of range
+    uint32_t selectCounters(uint32_t base, uint32_t mask) {
+        if(base >= TOTAL_COUNTERS || (static_cast<uint64_t>(mask) << base) >> TOTAL_COUNTERS != 0) {
+            return 0;
+        }
+        return mask << base;
+    }
+}
+
+bool PerformanceMonitor::count(CSRs &csr, const PMUEventCounts &events, bool supervisor) {
+    bool raiseInterrupt = false;
+
+    for(uint32_t started = startedCounters; started != 0; started &= started - 1) {
+        uint32_t index = __builtin_ctz(started);
+        const Counter &counter = counters[index - FIRST_COUNTER];
+        uint32_t amount = events[counter.event];
+        if(amount == 0 || (supervisor ? counter.inhibitSupervisor : counter.inhibitUser)) {
+            continue;
+        }
+
+        uint64_t value = readCounter(csr, index) + amount;
+        writeCounter(csr, index, value);
+
+        // Only the first overflow interrupts, until starting the counter clears OF again
+        if(value < amount && (csr.scountovf & (1u << index)) == 0) {
+            csr.scountovf |= 1u << index;
+            raiseInterrupt = true;
+        }
+    }
+    return raiseInterrupt;
+}
+
+SBIResult PerformanceMonitor::handleSBICall(CSRs &csr, uint32_t fid, const uint32_t (&args)[6], const PMUEventSources &sources) {
+    switch(fid) {
+        case FID_NUM_COUNTERS:
+            return SBIResult { SBI_SUCCESS, TOTAL_COUNTERS };
+        case FID_COUNTER_GET_INFO:
+            // Hardware counters, read through the CSR in bits 11:0
+            if(args[0] >= TOTAL_COUNTERS) {
+                return SBIResult { SBI_ERR_INVALID_PARAM, 0 };
+            }
+            return SBIResult { SBI_SUCCESS, (static_cast<uint32_t>(CSRAddress::CYCLE) + args[0]) | ((COUNTER_WIDTH - 1) << 12) };
+        case FID_COUNTER_CONFIG_MATCHING:
+            return configureMatching(csr, args, sources);
+        case FID_COUNTER_START: {
+            uint64_t initialValue = (static_cast<uint64_t>(args[4]) << 32) | args[3];
+            return start(csr, args[0], args[1], args[2], initialValue);
+        }
+        case FID_COUNTER_STOP:
+            return stop(args[0], args[1], args[2]);
+        default:
+            return SBIResult { SBI_ERR_NOT_SUPPORTED, 0 };
+    }
+}
+
+SBIResult PerformanceMonitor::configureMatching(CSRs &csr, const uint32_t (&args)[6], const PMUEventSources &sources) {
+    uint32_t candidates = selectCounters(args[0], args[1]);
+    uint32_t flags = args[2];
+
+    // event_data is 64 bits wide, only its low half selects raw events
+    PMUEvent event = decodeEvent(args[3], args[4]);
+    if(event == PMUEvent::NONE || !isEventAvailable(event, sources)) {
+        return SBIResult { SBI_ERR_NOT_SUPPORTED, 0 };
+    }
+
+    // cycle and instret are not programmable, every event is counted by one of the hpmcounters
+    uint32_t programmable = ~((1u << FIRST_COUNTER) - 1);
+    uint32_t available = (flags & CFG_FLAG_SKIP_MATCH) != 0 ? candidates & configuredCounters : candidates & ~configuredCounters;
+    available &= programmable;
+    if(available == 0) {
+        return SBIResult { SBI_ERR_NOT_SUPPORTED, 0 };
+    }
+
+    uint32_t index = __builtin_ctz(available);
+    counters[index - FIRST_COUNTER] = Counter { event, (flags & CFG_FLAG_SET_UINH) != 0, (flags & CFG_FLAG_SET_SINH) != 0 };
+    configuredCounters |= 1u << index;
+
+    if((flags & CFG_FLAG_CLEAR_VALUE) != 0) {
+        writeCounter(csr, index, 0);
+    }
+    if((flags & CFG_FLAG_AUTO_START) != 0) {
+        startedCounters |= 1u << index;
+        csr.scountovf &= ~(1u << index);
+    }
+    return SBIResult { SBI_SUCCESS, index };
+}
+
+SBIResult PerformanceMonitor::start(CSRs &csr, uint32_t base, uint32_t mask, uint32_t flags, uint64_t initialValue) {
+    uint32_t selected = selectCounters(base, mask);
+    if(selected == 0 || (selected & ~configuredCounters) != 0) {
+        return SBIResult { SBI_ERR_INVALID_PARAM, 0 };
+    }
+
+    int32_t error = (selected & startedCounters) != 0 ? SBI_ERR_ALREADY_STARTED : SBI_SUCCESS;
+    for(uint32_t pending = selected & ~startedCounters; pending != 0; pending &= pending - 1) {
+        uint32_t index = __builtin_ctz(pending);
+        if((flags & START_FLAG_SET_INIT_VALUE) != 0) {
+            writeCounter(csr, index, initialValue);
+        }
+        csr.scountovf &= ~(1u << index);
+    }
+    startedCounters |= selected;
+    return SBIResult { error, 0 };
+}
+
+SBIResult PerformanceMonitor::stop(uint32_t base, uint32_t mask, uint32_t flags) {
+    uint32_t selected = selectCounters(base, mask);
+    if(selected == 0 || (selected & ~configuredCounters) != 0) {
+        return SBIResult { SBI_ERR_INVALID_PARAM, 0 };
+    }
+
+    int32_t error = (selected & ~startedCounters) != 0 ? SBI_ERR_ALREADY_STOPPED : SBI_SUCCESS;
+    startedCounters &= ~selected;
+
+    // Resetting releases the counters for the next counter_config_matching
+    if((flags & STOP_FLAG_RESET) != 0) {
+        configuredCounters &= ~selected;
+    }
+    return SBIResult { error, 0 };
+}
@@ -0,0 +1,77 @@
+#ifndef __PMU_HPP__
+#define __PMU_HPP__
+
+#include <cstdint>
+#include "csr.hpp"
+
+namespace RV32 {
+    constexpr uint32_t SBI_EXT_PMU = 0x504D55;
+
+    struct SBIResult {
+        int32_t error;
+        uint32_t value;
+    };
+
+    // Events of the programmable counters, also the raw event codes of the SBI PMU extension
+    enum class PMUEvent: uint32_t {
+        NONE,
+        CYCLES,
+        INSTRUCTIONS,
+        LOADS,
+        STORES,
+        BRANCHES,
+        BRANCH_MISSES,      // only with a timing model
+        TRAPS,
+        ITLB_MISSES,        // the TLB misses only with the TLBs of a memory hierarchy simulator
+        DTLB_LOAD_MISSES,
+        DTLB_STORE_MISSES,
+        COUNT
+    };
+
+    // Models some events are taken from, events of a missing model can not be configured
+    struct PMUEventSources {
+        bool timingModel = false;
+        bool itlb = false;
+        bool dtlb = false;
+    };
+
+    struct PMUEventCounts {
+        uint32_t counts[static_cast<uint32_t>(PMUEvent::COUNT)] = {};
+
+        uint32_t& operator[](PMUEvent event) { return counts[static_cast<uint32_t>(event)]; }
+        uint32_t operator[](PMUEvent event) const { return counts[static_cast<uint32_t>(event)]; }
+    };
+
+    // Event selection and start/stop control of hpmcounter3 to hpmcounter31, which the SBI implementation does
+    // through mhpmevent and mcountinhibit on real hardware. The counter values and OF bits live in the CSRs.
+    class PerformanceMonitor {
+        public:
+            static constexpr uint32_t FIRST_COUNTER = 3;
+            static constexpr uint32_t NUM_COUNTERS = NUM_HPM_COUNTERS;
+
+            // The hart only counts events while a counter is started
+            bool isActive() const { return startedCounters != 0; }
+
+            // Returns true if a counter overflowed with its OF bit clear, which raises LCOFIP
+            bool count(CSRs &csr, const PMUEventCounts &events, bool supervisor);
+
+            // Functions of the SBI PMU extension, args holds a0 to a5
+            SBIResult handleSBICall(CSRs &csr, uint32_t fid, const uint32_t (&args)[6], const PMUEventSources &sources);
+        private:
+            struct Counter {
+                PMUEvent event;
+                bool inhibitUser;
+                bool inhibitSupervisor;
+            };
+
+            Counter counters[NUM_COUNTERS] {};
+            uint32_t configuredCounters = 0;    // bit per counter index, like the CSR numbers
+            uint32_t startedCounters = 0;
+
+            SBIResult configureMatching(CSRs &csr, const uint32_t (&args)[6], const PMUEventSources &sources);
+            SBIResult start(CSRs &csr, uint32_t base, uint32_t mask, uint32_t flags, uint64_t initialValue);
+            SBIResult stop(uint32_t base, uint32_t mask, uint32_t flags);
+    };
+};
+
+#endif /* __PMU_HPP__ */
@@ -0,0 +1,50 @@
+#ifndef __RING_BUFFER_HPP__
+#define __RING_BUFFER_HPP__
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include "emulator_exception.hpp"
+
+namespace RV32 {
+    // Single producer, single consumer ring. The hart pushes, a writer thread pops.
+    template<typename T>
+    class RingBuffer {
+        public:
+            explicit RingBuffer(size_t capacity): records(std::make_unique<T[]>(capacity)), mask(capacity - 1) {
+                if(capacity == 0 || (capacity & mask) != 0) {
+                    throw EmulatorException("Ring buffer capacity must be a power of two");
+                }
+            }
+
+            // Waits for the consumer when the ring is full, so no records are dropped
+            void push(const T &record) {
+                size_t currentHead = head.load(std::memory_order_relaxed);
+                while(currentHead - tail.load(std::memory_order_acquire) > mask) {
+                    std::this_thread::yield();
+                }
+                records[currentHead & mask] = record;
+                head.store(currentHead + 1, std::memory_order_release);
+            }
+
+            bool pop(T &record) {
+                size_t currentTail = tail.load(std::memory_order_relaxed);
+                if(currentTail == head.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                record = records[currentTail & mask];
+                tail.store(currentTail + 1, std::memory_order_release);
+                return true;
+            }
+        private:
+            std::unique_ptr<T[]> records;
+            const size_t mask;
+
+            // Kept on separate cache lines so producer and consumer do not contend
+            alignas(64) std::atomic<size_t> head {0};
+            alignas(64) std::atomic<size_t> tail {0};
+    };
+};
+
+#endif /* __RING_BUFFER_HPP__ */
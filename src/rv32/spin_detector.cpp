@@ -0,0 +1,79 @@
+#include "spin_detector.hpp"
+#include "csr.hpp"
+#include <algorithm>
+#include <cstring>
+
+using RV32::SpinDetector;
+
+void SpinDetector::noteCSRAccess(uint32_t addr, uint32_t rd, bool writes) {
+    CSRAddress csrAddr = static_cast<CSRAddress>(addr);
+    if(!writes && (csrAddr == CSRAddress::TIME || csrAddr == CSRAddress::TIMEH)) {
+        timeRead = true;
+        timeDerived |= (1u << rd) & ~1u;
+        return;
+    }
+    timeDerived &= ~(1u << rd);
+
+    // cycle and instret change on every iteration but are not advanced by skipping time
+    bool isCounter = csrAddr == CSRAddress::CYCLE || csrAddr == CSRAddress::CYCLEH ||
+                     csrAddr == CSRAddress::INSTRET || csrAddr == CSRAddress::INSTRETH;
+    if(writes || isCounter) {
+        sideEffect = true;
+    }
+}
+
+void SpinDetector::noteRegisterWrite(uint32_t rd, uint32_t rs1, uint32_t rs2) {
+    if(timeDerived & ((1u << rs1) | (1u << rs2))) {
+        timeDerived |= (1u << rd) & ~1u;
+    } else {
+        timeDerived &= ~(1u << rd);
+    }
+}
+
+SpinDetector::LoopKind SpinDetector::onBackwardBranch(uint32_t branchPC, uint32_t targetPC, const uint32_t (&gpr)[NUM_GPR], uint64_t instret) {
+    bool sameLoop = branchPC == lastBranchPC && targetPC == lastTargetPC;
+    bool idle = sameLoop && !sideEffect && instret - lastInstret <= MAX_LOOP_INSTRUCTIONS;
+
+    uint32_t changed = 0;
+    for(size_t i = 0; i < NUM_GPR; ++i) {
+        if(gpr[i] != lastGpr[i]) {
+            changed |= 1u << i;
+        }
+    }
+
+    // A loop that changes any other register may be counting down or making progress
+    LoopKind kind = LoopKind::NONE;
+    if(idle && timeRead && (changed & ~timeDerived) == 0) {
+        if(++idleIterations >= TIME_POLL_THRESHOLD) {
+            kind = LoopKind::TIME_POLL;
+        }
+    } else if(idle && changed == 0) {
+        kind = LoopKind::MEMORY_POLL;
+    } else {
+        idleIterations = 0;
+        timeStep = INITIAL_TIME_STEP;
+    }
+
+    lastBranchPC = branchPC;
+    lastTargetPC = targetPC;
+    lastInstret = instret;
+    std::memcpy(lastGpr, gpr, sizeof(lastGpr));
+    sideEffect = false;
+    timeRead = false;
+
+    return kind;
+}
+
+uint64_t SpinDetector::nextTimeStep() {
+    uint64_t step = timeStep;
+    timeStep = std::min(timeStep * 2, MAX_TIME_STEP);
+    return step;
+}
+
+void SpinDetector::reset() {
+    sideEffect = true;
+    timeRead = false;
+    timeDerived = 0;
+    idleIterations = 0;
+    timeStep = INITIAL_TIME_STEP;
+}
@@ -0,0 +1,52 @@
+#ifndef __SPIN_DETECTOR_HPP__
+#define __SPIN_DETECTOR_HPP__
+
+#include <cstdint>
+#include <cstddef>
+
+namespace RV32 {
+    // Recognizes tight backward-branch loops that can make no progress until time advances:
+    // loops that only poll the time CSRs, and loops that poll memory no other agent writes.
+    class SpinDetector {
+        public:
+            enum class LoopKind: uint32_t {
+                NONE,
+                MEMORY_POLL,    // an iteration left the registers unchanged, only an interrupt can end the loop
+                TIME_POLL       // an iteration read time, had no other side effects and only changed registers derived from time
+            };
+
+            static constexpr size_t NUM_GPR = 32;
+
+            void noteSideEffect() { sideEffect = true; }
+            void noteCSRAccess(uint32_t addr, uint32_t rd, bool writes);
+
+            // Called for every other instruction that writes rd, the value is derived from time if a source register is
+            void noteRegisterWrite(uint32_t rd, uint32_t rs1, uint32_t rs2);
+
+            // Called on every taken backward branch with the register file after the branch
+            LoopKind onBackwardBranch(uint32_t branchPC, uint32_t targetPC, const uint32_t (&gpr)[NUM_GPR], uint64_t instret);
+
+            // Ticks to skip for the current time polling loop, doubling on every call
+            uint64_t nextTimeStep();
+
+            void reset();
+        private:
+            static constexpr uint64_t MAX_LOOP_INSTRUCTIONS = 64;
+            static constexpr uint32_t TIME_POLL_THRESHOLD = 2; // iterations before time is skipped
+            static constexpr uint64_t INITIAL_TIME_STEP = 64;
+            static constexpr uint64_t MAX_TIME_STEP = 1 << 20;
+
+            uint32_t lastBranchPC = 0;
+            uint32_t lastTargetPC = 0;
+            uint64_t lastInstret = 0;
+            uint32_t lastGpr[NUM_GPR] = {};
+
+            bool sideEffect = true;
+            bool timeRead = false;
+            uint32_t timeDerived = 0; // registers holding values read from time or computed from them
+            uint32_t idleIterations = 0;
+            uint64_t timeStep = INITIAL_TIME_STEP;
+    };
+};
+
+#endif /* __SPIN_DETECTOR_HPP__ */
@@ -0,0 +1,149 @@
+#include "syscall_trace.hpp"
+#include <chrono>
+#include <cstring>
+
+using RV32::SyscallTracer;
+using RV32::SyscallTraceReader;
+using RV32::SyscallRecord;
+
+namespace {
+    constexpr char FILE_MAGIC[8] = {'R', 'V', '3', '2', 'S', 'Y', 'S', '1'};
+
+    void putLittleEndian(uint8_t *&out, uint64_t val, size_t size) {
+        for(size_t i = 0; i < size; ++i) {
+            *out++ = static_cast<uint8_t>(val >> (8 * i));
+        }
+    }
+
+    uint64_t getLittleEndian(const uint8_t *&in, size_t size) {
+        uint64_t val = 0;
+        for(size_t i = 0; i < size; ++i) {
+            val |= static_cast<uint64_t>(*in++) << (8 * i);
+        }
+        return val;
+    }
+}
+
+SyscallTracer::SyscallTracer(): buffer(BUFFER_CAPACITY) {
+}
+
+SyscallTracer::~SyscallTracer() {
+    if(!worker.joinable()) {
+        return;
+    }
+
+    // The hart is done, calls still waiting for a return are logged as incomplete
+    for(const auto &[task, record] : pending) {
+        buffer.push(record);
+    }
+    stopping.store(true, std::memory_order_release);
+    worker.join();
+}
+
+bool SyscallTracer::open(const std::string &fileName) {
+    output.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!output) {
+        return false;
+    }
+
+    output.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+    worker = std::thread(&SyscallTracer::run, this);
+    return true;
+}
+
+void SyscallTracer::enter(const SyscallRecord &entry) {
+    // A task only has one call in flight, an older one never returned
+    auto [it, inserted] = pending.try_emplace(entry.task, entry);
+    if(!inserted) {
+        buffer.push(it->second);
+        it->second = entry;
+    }
+}
+
+void SyscallTracer::exit(uint32_t task, uint32_t result, uint64_t instret, uint64_t cycle) {
+    auto it = pending.find(task);
+    if(it == pending.end()) {
+        return;
+    }
+
+    SyscallRecord &record = it->second;
+    record.exitInstret = instret;
+    record.exitCycle = cycle;
+    record.result = result;
+    record.completed = true;
+    buffer.push(record);
+    pending.erase(it);
+}
+
+void SyscallTracer::run() {
+    SyscallRecord record;
+
+    while(true) {
+        // Read the flag before draining so records pushed before a stop request are not lost
+        bool stop = stopping.load(std::memory_order_acquire);
+
+        bool drained = true;
+        while(buffer.pop(record)) {
+            uint8_t bytes[SYSCALL_RECORD_SIZE];
+            uint8_t *out = bytes;
+            putLittleEndian(out, record.entryInstret, 8);
+            putLittleEndian(out, record.exitInstret, 8);
+            putLittleEndian(out, record.entryCycle, 8);
+            putLittleEndian(out, record.exitCycle, 8);
+            putLittleEndian(out, record.satp, 4);
+            putLittleEndian(out, record.task, 4);
+            putLittleEndian(out, record.pc, 4);
+            putLittleEndian(out, record.number, 4);
+            for(uint32_t arg : record.args) {
+                putLittleEndian(out, arg, 4);
+            }
+            putLittleEndian(out, record.result, 4);
+            putLittleEndian(out, record.completed, 4);
+            output.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+            drained = false;
+        }
+
+        if(stop) {
+            break;
+        }
+        if(drained) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    output.flush();
+}
+
+bool SyscallTraceReader::open(const std::string &fileName) {
+    input.open(fileName, std::ios::in | std::ios::binary);
+    if(!input) {
+        return false;
+    }
+
+    char magic[sizeof(FILE_MAGIC)];
+    input.read(magic, sizeof(magic));
+    return input && std::memcmp(magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0;
+}
+
+bool SyscallTraceReader::next(SyscallRecord &record) {
+    uint8_t bytes[SYSCALL_RECORD_SIZE];
+    if(!input.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) {
+        return false;
+    }
+
+    const uint8_t *in = bytes;
+    record.entryInstret = getLittleEndian(in, 8);
+    record.exitInstret = getLittleEndian(in, 8);
+    record.entryCycle = getLittleEndian(in, 8);
+    record.exitCycle = getLittleEndian(in, 8);
+    record.satp = getLittleEndian(in, 4);
+    record.task = getLittleEndian(in, 4);
+    record.pc = getLittleEndian(in, 4);
+    record.number = getLittleEndian(in, 4);
+    for(uint32_t &arg : record.args) {
+        arg = getLittleEndian(in, 4);
+    }
+    record.result = getLittleEndian(in, 4);
+    record.completed = getLittleEndian(in, 4) != 0;
+    return true;
+}
@@ -0,0 +1,66 @@
+#ifndef __SYSCALL_TRACE_HPP__
+#define __SYSCALL_TRACE_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include "ring_buffer.hpp"
+
+namespace RV32 {
+    // A U-mode ecall and, once the kernel returns to the calling task, its result. The task is sscratch at the
+    // ecall, which Linux keeps pointing at the current task_struct while in U-mode; satp identifies the process.
+    struct SyscallRecord {
+        uint64_t entryInstret;
+        uint64_t exitInstret;
+        uint64_t entryCycle;
+        uint64_t exitCycle;
+        uint32_t satp;
+        uint32_t task;
+        uint32_t pc;
+        uint32_t number;    // a7
+        uint32_t args[6];   // a0 to a5
+        uint32_t result;    // a0 after returning
+        bool completed;     // false if the task never returned, e.g. after exit or at shutdown
+    };
+
+    // Log layout: an 8 byte magic followed by fixed size little endian records in order of completion
+    constexpr size_t SYSCALL_RECORD_SIZE = 4 * 8 + 4 * 4 + 6 * 4 + 4 + 4;
+
+    // Pairs system calls with their returns on the hart's thread and writes them to a log on a background thread
+    class SyscallTracer {
+        public:
+            SyscallTracer();
+            ~SyscallTracer();
+
+            bool open(const std::string &fileName);
+
+            // Called by the hart on every ecall from U-mode and on every return to U-mode
+            void enter(const SyscallRecord &entry);
+            void exit(uint32_t task, uint32_t result, uint64_t instret, uint64_t cycle);
+        private:
+            static constexpr size_t BUFFER_CAPACITY = 1 << 12;
+
+            RingBuffer<SyscallRecord> buffer;
+            std::ofstream output;
+            std::thread worker;
+            std::atomic<bool> stopping {false};
+
+            // Calls waiting for their return, by task
+            std::unordered_map<uint32_t, SyscallRecord> pending;
+
+            void run();
+    };
+
+    class SyscallTraceReader {
+        public:
+            bool open(const std::string &fileName);
+            bool next(SyscallRecord &record);
+        private:
+            std::ifstream input;
+    };
+};
+
+#endif /* __SYSCALL_TRACE_HPP__ */
@@ -0,0 +1,92 @@
+#include "timing_model.hpp"
+#include "emulator_exception.hpp"
+
+using RV32::TimingModel;
+using RV32::TimingConfig;
+using RV32::DecodedInstruction;
+using RV32::InstructionType;
+using RV32::Opcode;
+
+TimingModel::TimingModel(const TimingConfig &config):
+    config(config), predictorMask(config.predictorEntries - 1),
+    counters(config.predictorEntries, 1), targets(config.predictorEntries, 0) {
+    if(config.predictorEntries == 0 || (config.predictorEntries & predictorMask) != 0) {
+        throw EmulatorException("Branch predictor size must be a power of two");
+    }
+    if(config.mulLatency == 0 || config.divLatency == 0 || config.loadLatency == 0 || config.amoLatency == 0) {
+        throw EmulatorException("Instruction latencies must be at least one cycle");
+    }
+}
+
+uint32_t TimingModel::retire(const DecodedInstruction &decoded, uint32_t pc, uint32_t nextPC) {
+    uint32_t cycles = 1;
+
+    // Using a load result right away waits for the load to complete
+    if(pendingLoadRd != 0 && (decoded.rs1 == pendingLoadRd || decoded.rs2 == pendingLoadRd)) {
+        cycles += config.loadLatency - 1;
+        ++stats.loadUseStalls;
+    }
+    pendingLoadRd = 0;
+
+    uint32_t index = (pc >> 1) & predictorMask;
+
+    switch(decoded.type) {
+        case InstructionType::LOAD:
+            pendingLoadRd = decoded.rd;
+            break;
+        case InstructionType::AMO:
+            cycles = config.amoLatency;
+            break;
+        case InstructionType::BRANCH: {
+            uint8_t &counter = counters[index];
+            bool taken = nextPC != pc + decoded.length;
+            bool predictedTaken = counter >= 2;
+
+            ++stats.branches;
+            if(taken != predictedTaken) {
+                cycles += config.mispredictPenalty;
+                ++stats.mispredicts;
+            }
+
+            if(taken && counter < 3) {
+                ++counter;
+            } else if(!taken && counter > 0) {
+                --counter;
+            }
+            break;
+        }
+        case InstructionType::JUMP:
+            // jal targets are known at decode, jalr relies on the last target seen at this pc
+            if(decoded.opcode == Opcode::JALR) {
+                ++stats.branches;
+                if(targets[index] != nextPC) {
+                    cycles += config.mispredictPenalty;
+                    ++stats.mispredicts;
+                    targets[index] = nextPC;
+                }
+            }
+            break;
+        case InstructionType::OP:
+            switch(decoded.opcode) {
+                case Opcode::MUL:
+                case Opcode::MULH:
+                case Opcode::MULHSU:
+                case Opcode::MULHU:
+                    cycles += config.mulLatency - 1;
+                    break;
+                case Opcode::DIV:
+                case Opcode::DIVU:
+                case Opcode::REM:
+                case Opcode::REMU:
+                    cycles += config.divLatency - 1;
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return cycles;
+}
@@ -0,0 +1,48 @@
+#ifndef __TIMING_MODEL_HPP__
+#define __TIMING_MODEL_HPP__
+
+#include "decoder.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace RV32 {
+    // Latencies in cycles, every instruction takes at least one
+    struct TimingConfig {
+        uint32_t mulLatency = 3;
+        uint32_t divLatency = 34;
+        uint32_t loadLatency = 3;       // until the loaded value can be used by the next instruction
+        uint32_t amoLatency = 12;
+        uint32_t mispredictPenalty = 3;
+        uint32_t trapPenalty = 6;
+        uint32_t predictorEntries = 1024;
+    };
+
+    struct TimingStats {
+        uint64_t branches = 0;
+        uint64_t mispredicts = 0;
+        uint64_t loadUseStalls = 0;
+    };
+
+    // In-order single issue pipeline with a bimodal branch predictor and a target buffer for indirect jumps
+    class TimingModel {
+        public:
+            explicit TimingModel(const TimingConfig &config);
+
+            // Cycles taken by the instruction at pc, nextPC is where execution continued
+            uint32_t retire(const DecodedInstruction &decoded, uint32_t pc, uint32_t nextPC);
+            uint32_t getTrapPenalty() const { return config.trapPenalty; }
+
+            const TimingStats& getStats() const { return stats; }
+        private:
+            const TimingConfig config;
+            const uint32_t predictorMask;
+
+            std::vector<uint8_t> counters;     // 2 bit saturating, taken when >= 2
+            std::vector<uint32_t> targets;
+
+            uint8_t pendingLoadRd = 0;
+            TimingStats stats;
+    };
+};
+
+#endif /* __TIMING_MODEL_HPP__ */
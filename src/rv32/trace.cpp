@@ -0,0 +1,324 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <zlib.h>
+
+using RV32::TraceWriter;
+using RV32::TraceReader;
+using RV32::TraceRecord;
+
+namespace {
+    constexpr char FILE_MAGIC[8] = {'R', 'V', '3', '2', 'T', 'R', 'C', '1'};
+    constexpr char CHUNK_MAGIC[4] = {'R', 'V', 'T', 'C'};
+    constexpr size_t CHUNK_HEADER_SIZE = sizeof(CHUNK_MAGIC) + 8 + 4 + 4 + 4;
+
+    void putVarint(std::vector<uint8_t> &out, uint64_t val) {
+        while(val >= 0x80) {
+            out.push_back(static_cast<uint8_t>(val | 0x80));
+            val >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(val));
+    }
+
+    // Zigzag encoding keeps small negative deltas small
+    void putSignedVarint(std::vector<uint8_t> &out, int32_t val) {
+        putVarint(out, (static_cast<uint32_t>(val) << 1) ^ static_cast<uint32_t>(val >> 31));
+    }
+
+    bool getVarint(const std::vector<uint8_t> &in, size_t &pos, uint64_t &val) {
+        val = 0;
+        for(uint32_t shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+            uint8_t byte = in[pos++];
+            val |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool getSignedVarint(const std::vector<uint8_t> &in, size_t &pos, int32_t &val) {
+        uint64_t raw;
+        if(!getVarint(in, pos, raw)) {
+            return false;
+        }
+        uint32_t zigzag = static_cast<uint32_t>(raw);
+        val = static_cast<int32_t>((zigzag >> 1) ^ -(zigzag & 1));
+        return true;
+    }
+
+    void putLittleEndian(uint8_t *out, uint64_t val, size_t size) {
+        for(size_t i = 0; i < size; ++i) {
+            out[i] = static_cast<uint8_t>(val >> (8 * i));
+        }
+    }
+
+    uint64_t getLittleEndian(const uint8_t *in, size_t size) {
+        uint64_t val = 0;
+        for(size_t i = 0; i < size; ++i) {
+            val |= static_cast<uint64_t>(in[i]) << (8 * i);
+        }
+        return val;
+    }
+}
+
+TraceWriter::TraceWriter(): buffer(BUFFER_CAPACITY) {
+}
+
+TraceWriter::~TraceWriter() {
+    close();
+}
+
+bool TraceWriter::open(const std::string &fileName) {
+    output.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!output) {
+        return false;
+    }
+
+    output.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+    worker = std::thread(&TraceWriter::run, this);
+    return true;
+}
+
+bool TraceWriter::close() {
+    if(worker.joinable()) {
+        stopping.store(true, std::memory_order_release);
+        worker.join();
+    }
+    return !hasFailed();
+}
+
+void TraceWriter::run() {
+    TraceRecord record;
+
+    while(true) {
+        // Read the flag before draining so records pushed before a stop request are not lost
+        bool stop = stopping.load(std::memory_order_acquire);
+
+        bool drained = true;
+        while(buffer.pop(record)) {
+            if(!failed.load(std::memory_order_relaxed)) {
+                encode(record);
+            }
+            drained = false;
+        }
+
+        if(stop) {
+            break;
+        }
+        if(drained) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    flushChunk();
+    output.flush();
+    if(!output) {
+        failed.store(true, std::memory_order_release);
+    }
+}
+
+void TraceWriter::encode(const TraceRecord &record) {
+    if(chunkRecords == 0) {
+        chunkFirstInstret = record.instret;
+        previous = TraceRecord {};
+        previous.instret = record.instret;
+    }
+
+    putVarint(chunk, record.instret - previous.instret);
+    putSignedVarint(chunk, static_cast<int32_t>(record.pc - (previous.pc + 4)));
+
+    uint8_t bits[4];
+    putLittleEndian(bits, record.bits, sizeof(bits));
+    chunk.insert(chunk.end(), bits, bits + sizeof(bits));
+
+    chunk.push_back(record.rd | (record.hasMemAddr ? 0x80 : 0));
+    if(record.rd != 0) {
+        putVarint(chunk, record.rdValue);
+    }
+    if(record.hasMemAddr) {
+        putSignedVarint(chunk, static_cast<int32_t>(record.memAddr - previous.memAddr));
+        previous.memAddr = record.memAddr;
+    }
+
+    previous.instret = record.instret;
+    previous.pc = record.pc;
+
+    if(++chunkRecords == TRACE_CHUNK_RECORDS) {
+        flushChunk();
+    }
+}
+
+// Runs on the worker thread, so failures are flagged for the owner instead of thrown
+void TraceWriter::flushChunk() {
+    if(chunkRecords == 0 || failed.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    uLongf compressedSize = compressBound(chunk.size());
+    std::vector<uint8_t> compressed(CHUNK_HEADER_SIZE + compressedSize);
+    if(compress2(compressed.data() + CHUNK_HEADER_SIZE, &compressedSize, chunk.data(), chunk.size(), Z_BEST_SPEED) != Z_OK) {
+        failed.store(true, std::memory_order_release);
+        return;
+    }
+
+    uint8_t *header = compressed.data();
+    std::memcpy(header, CHUNK_MAGIC, sizeof(CHUNK_MAGIC));
+    putLittleEndian(header + 4, chunkFirstInstret, 8);
+    putLittleEndian(header + 12, chunkRecords, 4);
+    putLittleEndian(header + 16, chunk.size(), 4);
+    putLittleEndian(header + 20, compressedSize, 4);
+
+    output.write(reinterpret_cast<const char*>(compressed.data()), CHUNK_HEADER_SIZE + compressedSize);
+    if(!output) {
+        failed.store(true, std::memory_order_release);
+    }
+
+    chunk.clear();
+    chunkRecords = 0;
+}
+
+bool TraceReader::open(const std::string &fileName) {
+    input.open(fileName, std::ios::in | std::ios::binary);
+    if(!input) {
+        return false;
+    }
+
+    char magic[sizeof(FILE_MAGIC)];
+    input.read(magic, sizeof(magic));
+    if(!input || std::memcmp(magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        return false;
+    }
+
+    input.seekg(0, std::ios::end);
+    std::streamoff fileSize = input.tellg();
+    input.seekg(sizeof(FILE_MAGIC));
+
+    // Build the index by hopping over chunk headers, a truncated final chunk is ignored
+    uint8_t header[CHUNK_HEADER_SIZE];
+    while(input.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        if(std::memcmp(header, CHUNK_MAGIC, sizeof(CHUNK_MAGIC)) != 0) {
+            return false;
+        }
+
+        ChunkIndex entry {
+            .firstInstret = getLittleEndian(header + 4, 8),
+            .records = static_cast<uint32_t>(getLittleEndian(header + 12, 4)),
+            .rawSize = static_cast<uint32_t>(getLittleEndian(header + 16, 4)),
+            .compressedSize = static_cast<uint32_t>(getLittleEndian(header + 20, 4)),
+            .offset = input.tellg(),
+        };
+
+        if(entry.offset + entry.compressedSize > fileSize) {
+            break;
+        }
+        index.push_back(entry);
+        input.seekg(entry.offset + entry.compressedSize);
+    }
+
+    input.clear();
+    return true;
+}
+
+bool TraceReader::loadChunk(size_t chunkIndex) {
+    if(chunkIndex >= index.size()) {
+        return false;
+    }
+
+    const ChunkIndex &entry = index[chunkIndex];
+    std::vector<uint8_t> compressed(entry.compressedSize);
+    input.seekg(entry.offset);
+    input.read(reinterpret_cast<char*>(compressed.data()), compressed.size());
+    if(!input) {
+        return false;
+    }
+
+    chunk.resize(entry.rawSize);
+    uLongf rawSize = entry.rawSize;
+    if(uncompress(chunk.data(), &rawSize, compressed.data(), compressed.size()) != Z_OK || rawSize != entry.rawSize) {
+        return false;
+    }
+
+    nextChunk = chunkIndex + 1;
+    hasPending = false;
+    chunkPos = 0;
+    chunkRecordsLeft = entry.records;
+    previous = TraceRecord {};
+    previous.instret = entry.firstInstret;
+    return true;
+}
+
+bool TraceReader::seek(uint64_t instret) {
+    // Last chunk starting at or before the requested instruction
+    auto it = std::upper_bound(index.begin(), index.end(), instret, [](uint64_t value, const ChunkIndex &entry) {
+        return value < entry.firstInstret;
+    });
+    size_t chunkIndex = (it == index.begin()) ? 0 : (it - index.begin()) - 1;
+
+    if(!loadChunk(chunkIndex)) {
+        return false;
+    }
+
+    // Decode forward until the requested record and hold it back for the next call to next()
+    while(decodeNext(pending)) {
+        if(pending.instret >= instret) {
+            hasPending = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TraceReader::next(TraceRecord &record) {
+    if(hasPending) {
+        record = pending;
+        hasPending = false;
+        return true;
+    }
+    return decodeNext(record);
+}
+
+bool TraceReader::decodeNext(TraceRecord &record) {
+    while(chunkRecordsLeft == 0) {
+        if(!loadChunk(nextChunk)) {
+            return false;
+        }
+    }
+
+    uint64_t instretDelta, rdValue;
+    int32_t pcDelta, memDelta;
+
+    if(!getVarint(chunk, chunkPos, instretDelta) || !getSignedVarint(chunk, chunkPos, pcDelta) || chunkPos + 5 > chunk.size()) {
+        return false;
+    }
+
+    record.instret = previous.instret + instretDelta;
+    record.pc = previous.pc + 4 + pcDelta;
+    record.bits = static_cast<uint32_t>(getLittleEndian(&chunk[chunkPos], 4));
+    record.rd = chunk[chunkPos + 4] & 0x1F;
+    record.hasMemAddr = (chunk[chunkPos + 4] & 0x80) != 0;
+    chunkPos += 5;
+
+    record.rdValue = 0;
+    if(record.rd != 0) {
+        if(!getVarint(chunk, chunkPos, rdValue)) {
+            return false;
+        }
+        record.rdValue = static_cast<uint32_t>(rdValue);
+    }
+
+    record.memAddr = 0;
+    if(record.hasMemAddr) {
+        if(!getSignedVarint(chunk, chunkPos, memDelta)) {
+            return false;
+        }
+        record.memAddr = previous.memAddr + memDelta;
+        previous.memAddr = record.memAddr;
+    }
+
+    previous.instret = record.instret;
+    previous.pc = record.pc;
+    chunkRecordsLeft--;
+    return true;
+}
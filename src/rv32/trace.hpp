@@ -0,0 +1,97 @@
+#ifndef __TRACE_HPP__
+#define __TRACE_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ring_buffer.hpp"
+
+namespace RV32 {
+    struct TraceRecord {
+        uint64_t instret;
+        uint32_t pc;
+        uint32_t bits;
+        uint32_t rdValue;
+        uint32_t memAddr;
+        uint8_t rd;
+        bool hasMemAddr;
+    };
+
+    // The hart pushes, the trace writer pops
+    using TraceRingBuffer = RingBuffer<TraceRecord>;
+
+    // Trace file layout: an 8 byte magic followed by independently compressed chunks. Each chunk
+    // has a header (magic, first instret, record count, raw and compressed size) and a zlib
+    // stream of delta encoded records, so readers can skip from header to header to seek.
+    constexpr uint32_t TRACE_CHUNK_RECORDS = 1 << 16;
+
+    // Drains a ring buffer on a background thread, encoding and compressing it into a trace file
+    class TraceWriter {
+        public:
+            TraceWriter();
+            ~TraceWriter();
+
+            bool open(const std::string &fileName);
+            TraceRingBuffer& getBuffer() { return buffer; }
+
+            // Drains the buffer and finishes the file, returns false if compressing or writing failed
+            bool close();
+            bool hasFailed() const { return failed.load(std::memory_order_acquire); }
+        private:
+            static constexpr size_t BUFFER_CAPACITY = 1 << 16;
+
+            TraceRingBuffer buffer;
+            std::ofstream output;
+            std::thread worker;
+            std::atomic<bool> stopping {false};
+
+            // Set by the worker, records are then drained and dropped so the hart never waits on a dead writer
+            std::atomic<bool> failed {false};
+
+            std::vector<uint8_t> chunk;
+            uint32_t chunkRecords = 0;
+            uint64_t chunkFirstInstret = 0;
+            TraceRecord previous {};
+
+            void run();
+            void encode(const TraceRecord &record);
+            void flushChunk();
+    };
+
+    class TraceReader {
+        public:
+            bool open(const std::string &fileName);
+
+            // Positions the reader at the first record with an instret of at least the given value
+            bool seek(uint64_t instret);
+            bool next(TraceRecord &record);
+        private:
+            struct ChunkIndex {
+                uint64_t firstInstret;
+                uint32_t records;
+                uint32_t rawSize;
+                uint32_t compressedSize;
+                std::streamoff offset;
+            };
+
+            std::ifstream input;
+            std::vector<ChunkIndex> index;
+
+            size_t nextChunk = 0;
+            std::vector<uint8_t> chunk;
+            size_t chunkPos = 0;
+            uint32_t chunkRecordsLeft = 0;
+            TraceRecord previous {};
+
+            bool hasPending = false;
+            TraceRecord pending {};
+
+            bool loadChunk(size_t chunkIndex);
+            bool decodeNext(TraceRecord &record);
+    };
+};
+
+#endif /* __TRACE_HPP__ */
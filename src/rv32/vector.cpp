@@ -0,0 +1,826 @@
+#include "vector.hpp"
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+namespace {
+    using namespace RV32;
+
+    // funct3 of OP-V
+    enum Category: uint32_t {
+        OPIVV = 0b000, OPMVV = 0b010, OPIVI = 0b011, OPIVX = 0b100, OPMVX = 0b110
+    };
+
+    // Register bytes are accessed as elements of every width, may_alias keeps that well defined. The kernels
+    // below are plain loops over these arrays, which the compiler turns into host SIMD code.
+    template<typename T> struct Aliased { typedef T __attribute__((may_alias)) type; };
+    template<typename T> using Element = typename Aliased<T>::type;
+
+    template<size_t BYTES> struct IntegerOfSize;
+    template<> struct IntegerOfSize<1> { using type = uint8_t; using signedType = int8_t; };
+    template<> struct IntegerOfSize<2> { using type = uint16_t; using signedType = int16_t; };
+    template<> struct IntegerOfSize<4> { using type = uint32_t; using signedType = int32_t; };
+    template<> struct IntegerOfSize<8> { using type = uint64_t; using signedType = int64_t; };
+    template<> struct IntegerOfSize<16> { using type = unsigned __int128; using signedType = __int128; };
+
+    template<typename T> using Signed = typename IntegerOfSize<sizeof(T)>::signedType;
+    template<typename T> using Widened = typename IntegerOfSize<2 * sizeof(T)>::type;
+
+    struct Operands {
+        VectorRegisters &vr;
+        uint32_t vlenb;
+        uint32_t vl;
+        uint32_t vlmax;
+        int32_t lmulShift;
+        uint32_t category;
+        uint32_t vd;
+        uint32_t vs1;
+        uint32_t vs2;
+        uint32_t scalar;        // x[rs1], or the sign extended immediate
+        const uint8_t *mask;    // v0 if the instruction is masked
+
+        template<typename T>
+        Element<T>* reg(uint32_t index) const {
+            return reinterpret_cast<Element<T>*>(vr.get(index, vlenb));
+        }
+
+        bool isVectorForm() const {
+            return category == OPIVV || category == OPMVV;
+        }
+
+        // Scalars are sign extended from XLEN and truncated to SEW
+        template<typename T>
+        T scalarAs() const {
+            return static_cast<T>(static_cast<int64_t>(static_cast<int32_t>(scalar)));
+        }
+
+        // Shifts and slides take an unsigned immediate
+        Operands withUnsignedImmediate() const {
+            Operands ops = *this;
+            if(category == OPIVI) {
+                ops.scalar = vs1;
+            }
+            return ops;
+        }
+    };
+
+    constexpr uint32_t getGroupSize(int32_t emulShift) {
+        return emulShift > 0 ? 1u << emulShift : 1;
+    }
+
+    bool isAligned(uint32_t reg, uint32_t groupSize) {
+        return reg % groupSize == 0 && reg + groupSize <= VectorRegisters::NUM_VR;
+    }
+
+    bool isActive(const uint8_t *mask, uint32_t index) {
+        return ((mask[index >> 3] >> (index & 7)) & 1) != 0;
+    }
+
+    bool overlaps(uint32_t first, uint32_t firstSize, uint32_t second, uint32_t secondSize) {
+        return first < second + secondSize && second < first + firstSize;
+    }
+
+    // Destination and sources are groups of the given sizes, a masked destination may not overlap v0
+    bool checkGroups(const Operands &ops, uint32_t destSize, uint32_t sourceSize) {
+        if(ops.mask != nullptr && overlaps(ops.vd, destSize, 0, 1)) {
+            return false;
+        }
+        return isAligned(ops.vd, destSize) && isAligned(ops.vs2, sourceSize) && (!ops.isVectorForm() || isAligned(ops.vs1, sourceSize));
+    }
+
+    // A destination wider than its source may only overlap the highest-numbered part of a source group of at least one register
+    bool checkWidenedOverlap(uint32_t vd, uint32_t destSize, uint32_t vs, int32_t sourceShift) {
+        uint32_t sourceSize = getGroupSize(sourceShift);
+        if(!overlaps(vd, destSize, vs, sourceSize)) {
+            return true;
+        }
+        return sourceShift >= 0 && vs == vd + destSize - sourceSize;
+    }
+
+    // Masked off and tail elements are left undisturbed
+    template<typename Body>
+    void forEachElement(const Operands &ops, Body body) {
+        if(ops.mask == nullptr) {
+            for(uint32_t i = 0; i < ops.vl; ++i) {
+                body(i);
+            }
+        } else {
+            for(uint32_t i = 0; i < ops.vl; ++i) {
+                if(isActive(ops.mask, i)) {
+                    body(i);
+                }
+            }
+        }
+    }
+
+    // Multiplies modulo 2^SEW, small types would otherwise be promoted to int and could overflow
+    template<typename T>
+    T multiply(T a, T b) {
+        using Promoted = std::conditional_t<(sizeof(T) < sizeof(uint32_t)), uint32_t, T>;
+        return static_cast<T>(static_cast<Promoted>(a) * static_cast<Promoted>(b));
+    }
+
+    template<typename T, bool SIGNED>
+    Widened<T> extend(T value) {
+        if constexpr(SIGNED) {
+            return static_cast<Widened<T>>(static_cast<Signed<Widened<T>>>(static_cast<Signed<T>>(value)));
+        } else {
+            return value;
+        }
+    }
+
+    template<typename T>
+    T divideUnsigned(T a, T b) {
+        return b == 0 ? std::numeric_limits<T>::max() : static_cast<T>(a / b);
+    }
+
+    template<typename T>
+    T remainderUnsigned(T a, T b) {
+        return b == 0 ? a : static_cast<T>(a % b);
+    }
+
+    template<typename T>
+    T divideSigned(T a, T b) {
+        Signed<T> x = static_cast<Signed<T>>(a);
+        Signed<T> y = static_cast<Signed<T>>(b);
+        if(y == 0) {
+            return std::numeric_limits<T>::max();
+        }
+        if(y == -1 && x == std::numeric_limits<Signed<T>>::min()) {
+            return a;
+        }
+        return static_cast<T>(x / y);
+    }
+
+    template<typename T>
+    T remainderSigned(T a, T b) {
+        Signed<T> x = static_cast<Signed<T>>(a);
+        Signed<T> y = static_cast<Signed<T>>(b);
+        if(y == 0) {
+            return a;
+        }
+        if(y == -1 && x == std::numeric_limits<Signed<T>>::min()) {
+            return 0;
+        }
+        return static_cast<T>(x % y);
+    }
+
+    template<typename T, typename Op>
+    bool binary(const Operands &ops, Op op) {
+        uint32_t groupSize = getGroupSize(ops.lmulShift);
+        if(!checkGroups(ops, groupSize, groupSize)) {
+            return false;
+        }
+
+        Element<T> *vd = ops.reg<T>(ops.vd);
+        const Element<T> *vs2 = ops.reg<T>(ops.vs2);
+        if(ops.isVectorForm()) {
+            const Element<T> *vs1 = ops.reg<T>(ops.vs1);
+            forEachElement(ops, [&](uint32_t i) { vd[i] = op(vs2[i], vs1[i]); });
+        } else {
+            T b = ops.scalarAs<T>();
+            forEachElement(ops, [&](uint32_t i) { vd[i] = op(vs2[i], b); });
+        }
+        return true;
+    }
+
+    // Multiply-add, op receives the old destination element
+    template<typename T, typename Op>
+    bool ternary(const Operands &ops, Op op) {
+        uint32_t groupSize = getGroupSize(ops.lmulShift);
+        if(!checkGroups(ops, groupSize, groupSize)) {
+            return false;
+        }
+
+        Element<T> *vd = ops.reg<T>(ops.vd);
+        const Element<T> *vs2 = ops.reg<T>(ops.vs2);
+        if(ops.isVectorForm()) {
+            const Element<T> *vs1 = ops.reg<T>(ops.vs1);
+            forEachElement(ops, [&](uint32_t i) { vd[i] = op(vd[i], vs2[i], vs1[i]); });
+        } else {
+            T b = ops.scalarAs<T>();
+            forEachElement(ops, [&](uint32_t i) { vd[i] = op(vd[i], vs2[i], b); });
+        }
+        return true;
+    }
+
+    // Writes one mask bit per element, the destination is a single register that may overlap the sources
+    template<typename T, typename Compare>
+    bool compare(const Operands &ops, Compare cmp) {
+        uint32_t groupSize = getGroupSize(ops.lmulShift);
+        if(!isAligned(ops.vs2, groupSize) || (ops.isVectorForm() && !isAligned(ops.vs1, groupSize))) {
+            return false;
+        }
+
+        uint8_t bits[VectorRegisters::MAX_VLENB];
+        uint8_t *vd = ops.vr.get(ops.vd, ops.vlenb);
+        std::memcpy(bits, vd, ops.vlenb);
+
+        auto setBit = [&bits](uint32_t i, bool value) {
+            bits[i >> 3] = (bits[i >> 3] & ~(1u << (i & 7))) | (static_cast<uint32_t>(value) << (i & 7));
+        };
+
+        const Element<T> *vs2 = ops.reg<T>(ops.vs2);
+        if(ops.isVectorForm()) {
+            const Element<T> *vs1 = ops.reg<T>(ops.vs1);
+            forEachElement(ops, [&](uint32_t i) { setBit(i, cmp(vs2[i], vs1[i])); });
+        } else {
+            T b = ops.scalarAs<T>();
+            forEachElement(ops, [&](uint32_t i) { setBit(i, cmp(vs2[i], b)); });
+        }
+
+        std::memcpy(vd, bits, ops.vlenb);
+        return true;
+    }
+
+    // vd[0] = op(...op(vs1[0], vs2[0])..., vs2[vl - 1])
+    template<typename T, typename Op>
+    bool reduce(const Operands &ops, Op op) {
+        if(!isAligned(ops.vs2, getGroupSize(ops.lmulShift))) {
+            return false;
+        }
+        if(ops.vl == 0) {
+            return true;
+        }
+
+        const Element<T> *vs2 = ops.reg<T>(ops.vs2);
+        T acc = ops.reg<T>(ops.vs1)[0];
+        forEachElement(ops, [&](uint32_t i) { acc = op(acc, vs2[i]); });
+        ops.reg<T>(ops.vd)[0] = acc;
+        return true;
+    }
+
+    // 2 * SEW wide destination elements from SEW wide sources
+    template<typename T, bool SIGNED, typename Op>
+    bool widening(const Operands &ops, Op op) {
+        if constexpr(sizeof(T) * 8 == ELEN) {
+            return false;
+        } else {
+            uint32_t groupSize = getGroupSize(ops.lmulShift);
+            uint32_t destSize = getGroupSize(ops.lmulShift + 1);
+            if(ops.lmulShift >= 3 || !checkGroups(ops, destSize, groupSize)
+                || !checkWidenedOverlap(ops.vd, destSize, ops.vs2, ops.lmulShift)
+                || (ops.isVectorForm() && !checkWidenedOverlap(ops.vd, destSize, ops.vs1, ops.lmulShift))) {
+                return false;
+            }
+
+            using W = Widened<T>;
+            Element<W> *vd = ops.reg<W>(ops.vd);
+            const Element<T> *vs2 = ops.reg<T>(ops.vs2);
+            if(ops.isVectorForm()) {
+                const Element<T> *vs1 = ops.reg<T>(ops.vs1);
+                forEachElement(ops, [&](uint32_t i) { vd[i] = op(vd[i], extend<T, SIGNED>(vs2[i]), extend<T, SIGNED>(vs1[i])); });
+            } else {
+                W b = extend<T, SIGNED>(ops.scalarAs<T>());
+                forEachElement(ops, [&](uint32_t i) { vd[i] = op(vd[i], extend<T, SIGNED>(vs2[i]), b); });
+            }
+            return true;
+        }
+    }
+
+    // Like reduce, the single element destination may overlap the sources and v0
+    template<typename T, bool SIGNED>
+    bool widenedSum(const Operands &ops) {
+        if constexpr(sizeof(T) * 8 == ELEN) {
+            return false;
+        } else {
+            if(!isAligned(ops.vs2, getGroupSize(ops.lmulShift))) {
+                return false;
+            }
+            if(ops.vl == 0) {
+                return true;
+            }
+
+            using W = Widened<T>;
+            const Element<T> *vs2 = ops.reg<T>(ops.vs2);
+            W acc = ops.reg<W>(ops.vs1)[0];
+            forEachElement(ops, [&](uint32_t i) { acc += extend<T, SIGNED>(vs2[i]); });
+            ops.reg<W>(ops.vd)[0] = acc;
+            return true;
+        }
+    }
+
+    // vzext/vsext, the source elements are SEW / FACTOR wide
+    template<typename T, uint32_t FACTOR, bool SIGNED>
+    bool extendElements(const Operands &ops) {
+        if constexpr(sizeof(T) < FACTOR) {
+            return false;
+        } else {
+            using N = typename IntegerOfSize<sizeof(T) / FACTOR>::type;
+            constexpr int32_t FACTOR_SHIFT = FACTOR == 8 ? 3 : FACTOR == 4 ? 2 : 1;
+
+            // vs1 selects the operation, only vd and vs2 are registers
+            int32_t sourceShift = ops.lmulShift - FACTOR_SHIFT;
+            uint32_t destSize = getGroupSize(ops.lmulShift);
+            if(sourceShift < -3 || (ops.mask != nullptr && overlaps(ops.vd, destSize, 0, 1))
+                || !isAligned(ops.vd, destSize) || !isAligned(ops.vs2, getGroupSize(sourceShift))
+                || !checkWidenedOverlap(ops.vd, destSize, ops.vs2, sourceShift)) {
+                return false;
+            }
+
+            Element<T> *vd = ops.reg<T>(ops.vd);
+            const Element<N> *vs2 = ops.reg<N>(ops.vs2);
+            forEachElement(ops, [&](uint32_t i) {
+                vd[i] = SIGNED ? static_cast<T>(static_cast<Signed<T>>(static_cast<Signed<N>>(vs2[i]))) : static_cast<T>(vs2[i]);
+            });
+            return true;
+        }
+    }
+
+    template<typename T>
+    bool slide(const Operands &ops, bool up) {
+        uint32_t groupSize = getGroupSize(ops.lmulShift);
+        // The destination of a slide up may not overlap its source
+        if(!checkGroups(ops, groupSize, groupSize) || (up && overlaps(ops.vd, groupSize, ops.vs2, groupSize))) {
+            return false;
+        }
+
+        Element<T> *vd = ops.reg<T>(ops.vd);
+        const Element<T> *vs2 = ops.reg<T>(ops.vs2);
+        uint32_t offset = ops.category == OPIVI ? ops.vs1 : ops.scalar;
+
+        if(up) {
+            for(uint32_t i = offset; i < ops.vl; ++i) {
+                if(ops.mask == nullptr || isActive(ops.mask, i)) {
+                    vd[i] = vs2[i - offset];
+                }
+            }
+        } else {
+            forEachElement(ops, [&](uint32_t i) {
+                uint64_t source = static_cast<uint64_t>(i) + offset;
+                vd[i] = source < ops.vlmax ? static_cast<T>(vs2[source]) : 0;
+            });
+        }
+        return true;
+    }
+
+    // vmerge selects by v0, vmv.v copies
+    template<typename T>
+    bool merge(const Operands &ops, const uint8_t *select) {
+        uint32_t groupSize = getGroupSize(ops.lmulShift);
+        if((select != nullptr && overlaps(ops.vd, groupSize, 0, 1)) || !isAligned(ops.vd, groupSize) || !isAligned(ops.vs2, groupSize)
+            || (ops.isVectorForm() && !isAligned(ops.vs1, groupSize))) {
+            return false;
+        }
+
+        Element<T> *vd = ops.reg<T>(ops.vd);
+        const Element<T> *vs2 = ops.reg<T>(ops.vs2);
+        if(ops.isVectorForm()) {
+            const Element<T> *vs1 = ops.reg<T>(ops.vs1);
+            for(uint32_t i = 0; i < ops.vl; ++i) {
+                vd[i] = (select == nullptr || isActive(select, i)) ? static_cast<T>(vs1[i]) : static_cast<T>(vs2[i]);
+            }
+        } else {
+            T b = ops.scalarAs<T>();
+            for(uint32_t i = 0; i < ops.vl; ++i) {
+                vd[i] = (select == nullptr || isActive(select, i)) ? b : static_cast<T>(vs2[i]);
+            }
+        }
+        return true;
+    }
+
+    // Mask register logical operations work on vl bits, the remaining bits are undisturbed
+    template<typename Op>
+    void maskLogical(const Operands &ops, Op op) {
+        uint8_t *vd = ops.vr.get(ops.vd, ops.vlenb);
+        const uint8_t *vs2 = ops.vr.get(ops.vs2, ops.vlenb);
+        const uint8_t *vs1 = ops.vr.get(ops.vs1, ops.vlenb);
+
+        uint32_t bytes = ops.vl / 8;
+        for(uint32_t i = 0; i < bytes; ++i) {
+            vd[i] = static_cast<uint8_t>(op(vs2[i], vs1[i]));
+        }
+
+        uint32_t rest = ops.vl % 8;
+        if(rest != 0) {
+            uint8_t keep = static_cast<uint8_t>(0xFF << rest);
+            vd[bytes] = (vd[bytes] & keep) | (static_cast<uint8_t>(op(vs2[bytes], vs1[bytes])) & ~keep);
+        }
+    }
+
+    template<typename T>
+    bool executeElements(Opcode opcode, const Operands &ops, VectorResult &result) {
+        using S = Signed<T>;
+        using W = Widened<T>;
+        constexpr uint32_t SHIFT_MASK = sizeof(T) * 8 - 1;
+        constexpr uint32_t BITS = sizeof(T) * 8;
+        bool &saturated = result.saturated;
+
+        switch(opcode) {
+            case Opcode::VADD_VV:
+            case Opcode::VADD_VX:
+            case Opcode::VADD_VI:
+                return binary<T>(ops, [](T a, T b) -> T { return a + b; });
+            case Opcode::VSUB_VV:
+            case Opcode::VSUB_VX:
+                return binary<T>(ops, [](T a, T b) -> T { return a - b; });
+            case Opcode::VRSUB_VX:
+            case Opcode::VRSUB_VI:
+                return binary<T>(ops, [](T a, T b) -> T { return b - a; });
+            case Opcode::VMINU_VV:
+            case Opcode::VMINU_VX:
+                return binary<T>(ops, [](T a, T b) -> T { return std::min(a, b); });
+            case Opcode::VMIN_VV:
+            case Opcode::VMIN_VX:
+                return binary<T>(ops, [](T a, T b) -> T { return static_cast<S>(a) < static_cast<S>(b) ? a : b; });
+            case Opcode::VMAXU_VV:
+            case Opcode::VMAXU_VX:
+                return binary<T>(ops, [](T a, T b) -> T { return std::max(a, b); });
+            case Opcode::VMAX_VV:
+            case Opcode::VMAX_VX:
+                return binary<T>(ops, [](T a, T b) -> T { return static_cast<S>(a) > static_cast<S>(b) ? a : b; });
+            case Opcode::VAND_VV:
+            case Opcode::VAND_VX:
+            case Opcode::VAND_VI:
+                return binary<T>(ops, [](T a, T b) -> T { return a & b; });
+            case Opcode::VOR_VV:
+            case Opcode::VOR_VX:
+            case Opcode::VOR_VI:
+                return binary<T>(ops, [](T a, T b) -> T { return a | b; });
+            case Opcode::VXOR_VV:
+            case Opcode::VXOR_VX:
+            case Opcode::VXOR_VI:
+                return binary<T>(ops, [](T a, T b) -> T { return a ^ b; });
+            case Opcode::VSLL_VV:
+            case Opcode::VSLL_VX:
+            case Opcode::VSLL_VI:
+                return binary<T>(ops.withUnsignedImmediate(), [](T a, T b) -> T { return a << (b & SHIFT_MASK); });
+            case Opcode::VSRL_VV:
+            case Opcode::VSRL_VX:
+            case Opcode::VSRL_VI:
+                return binary<T>(ops.withUnsignedImmediate(), [](T a, T b) -> T { return a >> (b & SHIFT_MASK); });
+            case Opcode::VSRA_VV:
+            case Opcode::VSRA_VX:
+            case Opcode::VSRA_VI:
+                return binary<T>(ops.withUnsignedImmediate(), [](T a, T b) -> T { return static_cast<S>(a) >> (b & SHIFT_MASK); });
+
+            case Opcode::VSADDU_VV:
+            case Opcode::VSADDU_VX:
+            case Opcode::VSADDU_VI:
+                return binary<T>(ops, [&saturated](T a, T b) -> T {
+                    T sum = a + b;
+                    if(sum < a) {
+                        saturated = true;
+                        return std::numeric_limits<T>::max();
+                    }
+                    return sum;
+                });
+            case Opcode::VSADD_VV:
+            case Opcode::VSADD_VX:
+            case Opcode::VSADD_VI:
+                return binary<T>(ops, [&saturated](T a, T b) -> T {
+                    S sum;
+                    if(__builtin_add_overflow(static_cast<S>(a), static_cast<S>(b), &sum)) {
+                        saturated = true;
+                        return static_cast<S>(a) < 0 ? std::numeric_limits<S>::min() : std::numeric_limits<S>::max();
+                    }
+                    return sum;
+                });
+            case Opcode::VSSUBU_VV:
+            case Opcode::VSSUBU_VX:
+                return binary<T>(ops, [&saturated](T a, T b) -> T {
+                    if(a < b) {
+                        saturated = true;
+                        return 0;
+                    }
+                    return a - b;
+                });
+            case Opcode::VSSUB_VV:
+            case Opcode::VSSUB_VX:
+                return binary<T>(ops, [&saturated](T a, T b) -> T {
+                    S difference;
+                    if(__builtin_sub_overflow(static_cast<S>(a), static_cast<S>(b), &difference)) {
+                        saturated = true;
+                        return static_cast<S>(a) < 0 ? std::numeric_limits<S>::min() : std::numeric_limits<S>::max();
+                    }
+                    return difference;
+                });
+
+            case Opcode::VMUL_VV:
+            case Opcode::VMUL_VX:
+                return binary<T>(ops, [](T a, T b) -> T { return multiply(a, b); });
+            case Opcode::VMULHU_VV:
+            case Opcode::VMULHU_VX:
+                return binary<T>(ops, [](T a, T b) -> T { return multiply<W>(a, b) >> BITS; });
+            case Opcode::VMULH_VV:
+            case Opcode::VMULH_VX:
+                return binary<T>(ops, [](T a, T b) -> T { return multiply(extend<T, true>(a), extend<T, true>(b)) >> BITS; });
+            case Opcode::VMULHSU_VV:
+            case Opcode::VMULHSU_VX:
+                return binary<T>(ops, [](T a, T b) -> T { return multiply(extend<T, true>(a), extend<T, false>(b)) >> BITS; });
+            case Opcode::VDIVU_VV:
+            case Opcode::VDIVU_VX:
+                return binary<T>(ops, divideUnsigned<T>);
+            case Opcode::VDIV_VV:
+            case Opcode::VDIV_VX:
+                return binary<T>(ops, divideSigned<T>);
+            case Opcode::VREMU_VV:
+            case Opcode::VREMU_VX:
+                return binary<T>(ops, remainderUnsigned<T>);
+            case Opcode::VREM_VV:
+            case Opcode::VREM_VX:
+                return binary<T>(ops, remainderSigned<T>);
+
+            // vmacc/vnmsac multiply the sources, vmadd/vnmsub multiply by the destination
+            case Opcode::VMACC_VV:
+            case Opcode::VMACC_VX:
+                return ternary<T>(ops, [](T d, T a, T b) -> T { return d + multiply(a, b); });
+            case Opcode::VNMSAC_VV:
+            case Opcode::VNMSAC_VX:
+                return ternary<T>(ops, [](T d, T a, T b) -> T { return d - multiply(a, b); });
+            case Opcode::VMADD_VV:
+            case Opcode::VMADD_VX:
+                return ternary<T>(ops, [](T d, T a, T b) -> T { return multiply(d, b) + a; });
+            case Opcode::VNMSUB_VV:
+            case Opcode::VNMSUB_VX:
+                return ternary<T>(ops, [](T d, T a, T b) -> T { return a - multiply(d, b); });
+
+            case Opcode::VWADDU_VV:
+            case Opcode::VWADDU_VX:
+                return widening<T, false>(ops, [](W, W a, W b) -> W { return a + b; });
+            case Opcode::VWADD_VV:
+            case Opcode::VWADD_VX:
+                return widening<T, true>(ops, [](W, W a, W b) -> W { return a + b; });
+            case Opcode::VWSUBU_VV:
+            case Opcode::VWSUBU_VX:
+                return widening<T, false>(ops, [](W, W a, W b) -> W { return a - b; });
+            case Opcode::VWSUB_VV:
+            case Opcode::VWSUB_VX:
+                return widening<T, true>(ops, [](W, W a, W b) -> W { return a - b; });
+            case Opcode::VWMULU_VV:
+            case Opcode::VWMULU_VX:
+                return widening<T, false>(ops, [](W, W a, W b) -> W { return multiply(a, b); });
+            case Opcode::VWMUL_VV:
+            case Opcode::VWMUL_VX:
+                return widening<T, true>(ops, [](W, W a, W b) -> W { return multiply(a, b); });
+            case Opcode::VWMACCU_VV:
+            case Opcode::VWMACCU_VX:
+                return widening<T, false>(ops, [](W d, W a, W b) -> W { return d + multiply(a, b); });
+            case Opcode::VWMACC_VV:
+            case Opcode::VWMACC_VX:
+                return widening<T, true>(ops, [](W d, W a, W b) -> W { return d + multiply(a, b); });
+
+            case Opcode::VMSEQ_VV:
+            case Opcode::VMSEQ_VX:
+            case Opcode::VMSEQ_VI:
+                return compare<T>(ops, [](T a, T b) { return a == b; });
+            case Opcode::VMSNE_VV:
+            case Opcode::VMSNE_VX:
+            case Opcode::VMSNE_VI:
+                return compare<T>(ops, [](T a, T b) { return a != b; });
+            case Opcode::VMSLTU_VV:
+            case Opcode::VMSLTU_VX:
+                return compare<T>(ops, [](T a, T b) { return a < b; });
+            case Opcode::VMSLT_VV:
+            case Opcode::VMSLT_VX:
+                return compare<T>(ops, [](T a, T b) { return static_cast<S>(a) < static_cast<S>(b); });
+            case Opcode::VMSLEU_VV:
+            case Opcode::VMSLEU_VX:
+            case Opcode::VMSLEU_VI:
+                return compare<T>(ops, [](T a, T b) { return a <= b; });
+            case Opcode::VMSLE_VV:
+            case Opcode::VMSLE_VX:
+            case Opcode::VMSLE_VI:
+                return compare<T>(ops, [](T a, T b) { return static_cast<S>(a) <= static_cast<S>(b); });
+            case Opcode::VMSGTU_VX:
+            case Opcode::VMSGTU_VI:
+                return compare<T>(ops, [](T a, T b) { return a > b; });
+            case Opcode::VMSGT_VX:
+            case Opcode::VMSGT_VI:
+                return compare<T>(ops, [](T a, T b) { return static_cast<S>(a) > static_cast<S>(b); });
+
+            case Opcode::VREDSUM_VS:
+                return reduce<T>(ops, [](T acc, T x) -> T { return acc + x; });
+            case Opcode::VREDAND_VS:
+                return reduce<T>(ops, [](T acc, T x) -> T { return acc & x; });
+            case Opcode::VREDOR_VS:
+                return reduce<T>(ops, [](T acc, T x) -> T { return acc | x; });
+            case Opcode::VREDXOR_VS:
+                return reduce<T>(ops, [](T acc, T x) -> T { return acc ^ x; });
+            case Opcode::VREDMINU_VS:
+                return reduce<T>(ops, [](T acc, T x) -> T { return std::min(acc, x); });
+            case Opcode::VREDMIN_VS:
+                return reduce<T>(ops, [](T acc, T x) -> T { return static_cast<S>(x) < static_cast<S>(acc) ? x : acc; });
+            case Opcode::VREDMAXU_VS:
+                return reduce<T>(ops, [](T acc, T x) -> T { return std::max(acc, x); });
+            case Opcode::VREDMAX_VS:
+                return reduce<T>(ops, [](T acc, T x) -> T { return static_cast<S>(x) > static_cast<S>(acc) ? x : acc; });
+            case Opcode::VWREDSUMU_VS:
+                return widenedSum<T, false>(ops);
+            case Opcode::VWREDSUM_VS:
+                return widenedSum<T, true>(ops);
+
+            case Opcode::VZEXT_VF2:
+                return extendElements<T, 2, false>(ops);
+            case Opcode::VSEXT_VF2:
+                return extendElements<T, 2, true>(ops);
+            case Opcode::VZEXT_VF4:
+                return extendElements<T, 4, false>(ops);
+            case Opcode::VSEXT_VF4:
+                return extendElements<T, 4, true>(ops);
+            case Opcode::VZEXT_VF8:
+                return extendElements<T, 8, false>(ops);
+            case Opcode::VSEXT_VF8:
+                return extendElements<T, 8, true>(ops);
+
+            case Opcode::VSLIDEUP_VX:
+            case Opcode::VSLIDEUP_VI:
+                return slide<T>(ops, true);
+            case Opcode::VSLIDEDOWN_VX:
+            case Opcode::VSLIDEDOWN_VI:
+                return slide<T>(ops, false);
+
+            case Opcode::VMERGE_VVM:
+            case Opcode::VMERGE_VXM:
+            case Opcode::VMERGE_VIM:
+                return merge<T>(ops, ops.vr.get(0, ops.vlenb));
+            case Opcode::VMV_V_V:
+            case Opcode::VMV_V_X:
+            case Opcode::VMV_V_I:
+                return merge<T>(ops, nullptr);
+
+            case Opcode::VMV_X_S:
+                result.value = static_cast<uint32_t>(static_cast<int64_t>(static_cast<S>(ops.reg<T>(ops.vs2)[0])));
+                return true;
+            case Opcode::VMV_S_X:
+                if(ops.vl > 0) {
+                    ops.reg<T>(ops.vd)[0] = ops.scalarAs<T>();
+                }
+                return true;
+            case Opcode::VID_V: {
+                if(!checkGroups(ops, getGroupSize(ops.lmulShift), 1)) {
+                    return false;
+                }
+                Element<T> *vd = ops.reg<T>(ops.vd);
+                forEachElement(ops, [&](uint32_t i) { vd[i] = static_cast<T>(i); });
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    // AVL is x[rs1] or the immediate, all elements if rs1 is x0, and the current vl if rd is x0 as well
+    void configure(const DecodedInstruction &decoded, CSRs &csr, uint32_t rs1, uint32_t vtype) {
+        uint32_t avl = rs1;
+        if(decoded.opcode == Opcode::VSETIVLI) {
+            avl = decoded.rs1;
+        } else if(decoded.rs1 == 0) {
+            avl = decoded.rd != 0 ? UINT32_MAX : csr.vl;
+        }
+
+        VectorType type = decodeVectorType(vtype);
+        if(type.vill) {
+            csr.vtype = VTYPE_VILL;
+            csr.vl = 0;
+        } else {
+            csr.vtype = vtype;
+            csr.vl = std::min(avl, getVLMAX(type, csr.vlenb));
+        }
+        csr.vstart = 0;
+    }
+};
+
+bool RV32::getVectorMemoryAccess(const DecodedInstruction &decoded, const CSRs &csr, uint32_t stride, VectorMemoryAccess &access) {
+    uint32_t bits = decoded.instr.bits;
+    uint32_t width = decoded.instr.r.funct3;
+    uint32_t eew = width == 0 ? 1 : 1u << (width - 4); // 000, 101, 110 and 111 are 8 to 64 bits
+    uint32_t mop = (bits >> 26) & 0x3;
+    uint32_t lumop = (bits >> 20) & 0x1F;
+    bool masked = ((bits >> 25) & 1) == 0;
+
+    // Whole register accesses do not depend on vtype or vl
+    if(mop == 0 && lumop == 0b01000) {
+        uint32_t registers = ((bits >> 29) & 0x7) + 1;
+        if(decoded.rd % registers != 0) {
+            return false;
+        }
+        access = VectorMemoryAccess { eew, registers * csr.vlenb / eew, eew, false };
+        return true;
+    }
+
+    VectorType type = decodeVectorType(csr.vtype);
+    if(type.vill) {
+        return false;
+    }
+
+    // vlm.v and vsm.v transfer ceil(vl / 8) bytes
+    if(mop == 0 && lumop == 0b01011) {
+        access = VectorMemoryAccess { 1, (csr.vl + 7) / 8, 1, false };
+        return true;
+    }
+
+    // EMUL = EEW / SEW * LMUL
+    int32_t emulShift = type.lmulShift + __builtin_ctz(eew) - __builtin_ctz(type.sew);
+    if(emulShift < -3 || emulShift > 3 || !isAligned(decoded.rd, getGroupSize(emulShift))) {
+        return false;
+    }
+    if(masked && decoded.rd == 0 && decoded.type == InstructionType::LOAD_V) {
+        return false;
+    }
+
+    access = VectorMemoryAccess { eew, csr.vl, mop == 0b10 ? stride : eew, masked };
+    return true;
+}
+
+bool RV32::executeVector(const DecodedInstruction &decoded, VectorRegisters &vr, CSRs &csr, uint32_t rs1, uint32_t rs2, VectorResult &result) {
+    Opcode opcode = decoded.opcode;
+    result = VectorResult { 0, false };
+
+    switch(opcode) {
+        case Opcode::VSETVLI:
+            configure(decoded, csr, rs1, decoded.imm & 0x7FF);
+            result.value = csr.vl;
+            return true;
+        case Opcode::VSETIVLI:
+            configure(decoded, csr, rs1, decoded.imm & 0x3FF);
+            result.value = csr.vl;
+            return true;
+        case Opcode::VSETVL:
+            configure(decoded, csr, rs1, rs2);
+            result.value = csr.vl;
+            return true;
+        case Opcode::VMV1R_V:
+        case Opcode::VMV2R_V:
+        case Opcode::VMV4R_V:
+        case Opcode::VMV8R_V: {
+            // Whole register moves do not depend on vtype, the immediate holds the register count - 1
+            uint32_t registers = decoded.rs1 + 1;
+            if(!isAligned(decoded.rd, registers) || !isAligned(decoded.rs2, registers)) {
+                return false;
+            }
+            std::memmove(vr.get(decoded.rd, csr.vlenb), vr.get(decoded.rs2, csr.vlenb), registers * csr.vlenb);
+            return true;
+        }
+        default:
+            break;
+    }
+
+    // Arithmetic is not interruptible, so vstart is always 0 here unless written by software
+    VectorType type = decodeVectorType(csr.vtype);
+    if(type.vill || csr.vstart != 0) {
+        return false;
+    }
+
+    uint32_t category = decoded.instr.r.funct3;
+    bool masked = ((decoded.instr.bits >> 25) & 1) == 0;
+    Operands ops {
+        vr, csr.vlenb, csr.vl, getVLMAX(type, csr.vlenb), type.lmulShift, category,
+        decoded.rd, decoded.rs1, decoded.rs2, category == OPIVI ? decoded.imm : rs1,
+        masked ? vr.get(0, csr.vlenb) : nullptr
+    };
+
+    switch(opcode) {
+        case Opcode::VCPOP_M:
+        case Opcode::VFIRST_M: {
+            const uint8_t *vs2 = vr.get(decoded.rs2, csr.vlenb);
+            uint32_t count = 0;
+            uint32_t first = UINT32_MAX;
+            forEachElement(ops, [&](uint32_t i) {
+                if(isActive(vs2, i)) {
+                    first = std::min(first, i);
+                    ++count;
+                }
+            });
+            result.value = opcode == Opcode::VCPOP_M ? count : first;
+            return true;
+        }
+        case Opcode::VMANDN_MM:
+            maskLogical(ops, [](uint8_t a, uint8_t b) { return a & ~b; });
+            return true;
+        case Opcode::VMAND_MM:
+            maskLogical(ops, [](uint8_t a, uint8_t b) { return a & b; });
+            return true;
+        case Opcode::VMOR_MM:
+            maskLogical(ops, [](uint8_t a, uint8_t b) { return a | b; });
+            return true;
+        case Opcode::VMXOR_MM:
+            maskLogical(ops, [](uint8_t a, uint8_t b) { return a ^ b; });
+            return true;
+        case Opcode::VMORN_MM:
+            maskLogical(ops, [](uint8_t a, uint8_t b) { return a | ~b; });
+            return true;
+        case Opcode::VMNAND_MM:
+            maskLogical(ops, [](uint8_t a, uint8_t b) { return ~(a & b); });
+            return true;
+        case Opcode::VMNOR_MM:
+            maskLogical(ops, [](uint8_t a, uint8_t b) { return ~(a | b); });
+            return true;
+        case Opcode::VMXNOR_MM:
+            maskLogical(ops, [](uint8_t a, uint8_t b) { return ~(a ^ b); });
+            return true;
+        default:
+            break;
+    }
+
+    switch(type.sew) {
+        case 1:
+            return executeElements<uint8_t>(opcode, ops, result);
+        case 2:
+            return executeElements<uint16_t>(opcode, ops, result);
+        case 4:
+            return executeElements<uint32_t>(opcode, ops, result);
+        default:
+            return executeElements<uint64_t>(opcode, ops, result);
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef __VECTOR_HPP__
+#define __VECTOR_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "csr.hpp"
+#include "decoder.hpp"
+
+namespace RV32 {
+    // Register n starts at byte n * VLENB so register groups are contiguous. Storage is sized for the
+    // largest supported VLEN, the hart uses the first 32 * VLENB bytes.
+    struct VectorRegisters {
+        static constexpr size_t NUM_VR = 32;
+        static constexpr uint32_t MIN_VLEN = 128;
+        static constexpr uint32_t MAX_VLEN = 1024;
+        static constexpr uint32_t MAX_VLENB = MAX_VLEN / 8;
+
+        alignas(32) uint8_t bytes[NUM_VR * MAX_VLENB];
+
+        void reset() {
+            std::memset(bytes, 0, sizeof(bytes));
+        }
+
+        uint8_t* get(uint32_t reg, uint32_t vlenb) { return bytes + reg * vlenb; }
+
+        // Mask bit of element index in v0
+        bool isActive(uint32_t index) const { return ((bytes[index >> 3] >> (index & 7)) & 1) != 0; }
+    };
+
+    constexpr uint32_t VTYPE_VILL = 0x80000000;
+    constexpr uint32_t ELEN = 64;
+
+    struct VectorType {
+        uint32_t sew;       // element width in bytes
+        int32_t lmulShift;  // log2 of LMUL, negative for fractional LMUL
+        bool vill;
+    };
+
+    constexpr VectorType decodeVectorType(uint32_t vtype) {
+        uint32_t vlmul = vtype & 0x7;
+        uint32_t vsew = (vtype >> 3) & 0x7;
+        int32_t lmulShift = vlmul < 4 ? static_cast<int32_t>(vlmul) : static_cast<int32_t>(vlmul) - 8;
+        uint32_t sew = 1u << vsew;
+
+        // Reserved bits, LMUL or SEW, and fractional LMUL too small to hold an element of ELEN / SEW
+        bool vill = (vtype & ~0xFFu) != 0 || vlmul == 4 || vsew > 3 || (lmulShift < 0 && (sew * 8) > (ELEN >> -lmulShift));
+        return VectorType { sew, lmulShift, vill };
+    }
+
+    constexpr uint32_t getVLMAX(const VectorType &type, uint32_t vlenb) {
+        uint32_t elements = vlenb / type.sew;
+        return type.lmulShift >= 0 ? elements << type.lmulShift : elements >> -type.lmulShift;
+    }
+
+    // Instructions that write x[rd] instead of a vector register
+    constexpr bool writesScalarRegister(Opcode opcode) {
+        switch(opcode) {
+            case Opcode::VSETVLI:
+            case Opcode::VSETIVLI:
+            case Opcode::VSETVL:
+            case Opcode::VMV_X_S:
+            case Opcode::VCPOP_M:
+            case Opcode::VFIRST_M:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Elements accessed by a vector load or store, element i is at base + i * stride and byte i * elementSize of the group
+    struct VectorMemoryAccess {
+        uint32_t elementSize;
+        uint32_t count;
+        uint32_t stride;
+        bool masked;
+    };
+
+    struct VectorResult {
+        uint32_t value;     // written to x[rd] if writesScalarRegister
+        bool saturated;     // sets vxsat
+    };
+
+    // Returns false if the access is illegal for the current vtype and vl. stride is x[rs2] of strided accesses.
+    bool getVectorMemoryAccess(const DecodedInstruction &decoded, const CSRs &csr, uint32_t stride, VectorMemoryAccess &access);
+
+    // Executes an OP-V instruction, including vsetvl. rs1 and rs2 hold the integer registers of the encoding.
+    // Returns false if the instruction is illegal for the current vtype, vl or vstart.
+    bool executeVector(const DecodedInstruction &decoded, VectorRegisters &vr, CSRs &csr, uint32_t rs1, uint32_t rs2, VectorResult &result);
+};
+
+#endif /* __VECTOR_HPP__ */
@@ -0,0 +1,402 @@
+#include "simpoint.hpp"
+#include "emulator_exception.hpp"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+
+using Vector = RV32::BasicBlockProfiler::Vector;
+
+namespace {
+    constexpr size_t DIMENSIONS = RV32::BasicBlockProfiler::DIMENSIONS;
+    constexpr uint32_t KMEANS_SEEDS = 5;
+    constexpr uint32_t KMEANS_ITERATIONS = 100;
+    constexpr double BIC_THRESHOLD = 0.9; // pick the smallest k scoring this fraction of the best BIC
+
+    struct Clustering {
+        std::vector<Vector> centroids;
+        std::vector<size_t> assignments;
+        double distortion = 0.0;
+    };
+
+    double squaredDistance(const Vector &a, const Vector &b) {
+        double sum = 0.0;
+        for(size_t i = 0; i < DIMENSIONS; ++i) {
+            sum += (a[i] - b[i]) * (a[i] - b[i]);
+        }
+        return sum;
+    }
+
+    Clustering kmeans(const std::vector<Vector> &points, size_t k, uint64_t seed) {
+        std::mt19937_64 rng(seed);
+        Clustering result;
+
+        // k-means++ initialization, further points are more likely to become centroids
+        std::vector<double> nearest(points.size(), std::numeric_limits<double>::max());
+        result.centroids.push_back(points[rng() % points.size()]);
+        while(result.centroids.size() < k) {
+            double total = 0.0;
+            for(size_t i = 0; i < points.size(); ++i) {
+                nearest[i] = std::min(nearest[i], squaredDistance(points[i], result.centroids.back()));
+                total += nearest[i];
+            }
+            if(total == 0.0) {
+                break;
+            }
+
+            double target = std::uniform_real_distribution<double>(0.0, total)(rng);
+            size_t chosen = 0;
+            for(double sum = nearest[0]; sum < target && chosen + 1 < points.size(); sum += nearest[++chosen]);
+            result.centroids.push_back(points[chosen]);
+        }
+
+        result.assignments.assign(points.size(), 0);
+        for(uint32_t iteration = 0; iteration < KMEANS_ITERATIONS; ++iteration) {
+            bool changed = iteration == 0;
+            for(size_t i = 0; i < points.size(); ++i) {
+                size_t best = 0;
+                for(size_t c = 1; c < result.centroids.size(); ++c) {
+                    if(squaredDistance(points[i], result.centroids[c]) < squaredDistance(points[i], result.centroids[best])) {
+                        best = c;
+                    }
+                }
+                changed |= result.assignments[i] != best;
+                result.assignments[i] = best;
+            }
+            if(!changed) {
+                break;
+            }
+
+            std::vector<Vector> sums(result.centroids.size(), Vector {});
+            std::vector<size_t> counts(result.centroids.size(), 0);
+            for(size_t i = 0; i < points.size(); ++i) {
+                for(size_t d = 0; d < DIMENSIONS; ++d) {
+                    sums[result.assignments[i]][d] += points[i][d];
+                }
+                ++counts[result.assignments[i]];
+            }
+            for(size_t c = 0; c < result.centroids.size(); ++c) {
+                if(counts[c] != 0) {
+                    for(size_t d = 0; d < DIMENSIONS; ++d) {
+                        result.centroids[c][d] = sums[c][d] / counts[c];
+                    }
+                }
+            }
+        }
+
+        for(size_t i = 0; i < points.size(); ++i) {
+            result.distortion += squaredDistance(points[i], result.centroids[result.assignments[i]]);
+        }
+        return result;
+    }
+
+    // Bayesian information criterion of a clustering under a spherical gaussian model, as used by SimPoint
+    double bic(const std::vector<Vector> &points, const Clustering &clustering) {
+        double r = points.size();
+        double k = clustering.centroids.size();
+        double variance = std::max(clustering.distortion / std::max(r - k, 1.0), 1e-12);
+
+        std::vector<size_t> sizes(clustering.centroids.size(), 0);
+        for(size_t assignment : clustering.assignments) {
+            ++sizes[assignment];
+        }
+
+        double likelihood = 0.0;
+        for(size_t size : sizes) {
+            if(size == 0) {
+                continue;
+            }
+            double ri = size;
+            likelihood += ri * std::log(ri) - ri * std::log(r) - ri * DIMENSIONS / 2.0 * std::log(2.0 * M_PI * variance)
+                - (ri - k) / 2.0;
+        }
+
+        double parameters = k * (DIMENSIONS + 1);
+        return likelihood - parameters / 2.0 * std::log(r);
+    }
+}
+
+SimPointRunner::SimPointRunner(const SimPointConfig &config, const RV32::HartConfig &hartConfig):
+    config(config), hartConfig(hartConfig) {
+    if(hartConfig.timeSource != RV32::TimeSource::INSTRET && hartConfig.timeSource != RV32::TimeSource::CYCLE) {
+        throw EmulatorException("Sampled simulation needs instret or cycle based time");
+    }
+    if(config.maxClusters == 0) {
+        throw EmulatorException("At least one cluster is needed");
+    }
+}
+
+void SimPointRunner::run(const RV32::HartState &initialState, BasicMemory &memory, MemoryMapManager &mmap) {
+    BasicMemory initialMemory(memory.getBaseAddr(), memory.getSize());
+    initialMemory.copyFrom(memory);
+
+    std::vector<Vector> intervals;
+    profiledInstructions = profile(initialState, mmap, intervals);
+    numIntervals = intervals.size();
+    if(intervals.empty()) {
+        return;
+    }
+    choosePoints(intervals);
+
+    // The second run retraces the first one and stops at every simulation point to checkpoint it
+    memory.copyFrom(initialMemory);
+
+    RV32::HartConfig replayConfig = hartConfig;
+    replayConfig.putCharCallback = [](char) {};
+    replayConfig.getCharCallback = []() { return static_cast<char>(-1); };
+    replayConfig.shutdownCallback = []() {};
+
+    RV32::Hart hart(initialState.pc, mmap, replayConfig);
+    hart.setState(initialState);
+
+    uint32_t maxThreads = config.threads != 0 ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> workers;
+    std::mutex activeMutex;
+    std::condition_variable activeChanged;
+    uint32_t active = 0;
+    std::exception_ptr workerError; // first exception of a detailed run, guarded by activeMutex
+
+    // Destroying a joinable thread terminates, so the workers are joined however the loop below is left
+    struct WorkerJoiner {
+        std::vector<std::thread> &workers;
+
+        ~WorkerJoiner() {
+            for(std::thread &worker : workers) {
+                if(worker.joinable()) {
+                    worker.join();
+                }
+            }
+        }
+    } joiner { workers };
+
+    for(SimulationPoint &point : points) {
+        // Fused pairs may step past the interval start by one instruction
+        uint64_t start = initialState.csr.instret | (static_cast<uint64_t>(initialState.csr.instreth) << 32);
+        start += point.interval * config.intervalLength;
+        while(hart.getInstret() < start) {
+            hart.stepInstruction();
+        }
+
+        // Each checkpoint holds a copy of guest memory, so only as many exist as there are workers
+        {
+            std::unique_lock<std::mutex> lock(activeMutex);
+            activeChanged.wait(lock, [&]() { return active < maxThreads; });
+            ++active;
+        }
+
+        auto checkpoint = std::make_shared<Checkpoint>();
+        checkpoint->state = hart.getState();
+        checkpoint->memory = std::make_unique<BasicMemory>(memory.getBaseAddr(), memory.getSize());
+        checkpoint->memory->copyFrom(memory);
+
+        workers.emplace_back([this, checkpoint, &point, &activeMutex, &activeChanged, &active, &workerError]() {
+            std::exception_ptr error;
+            try {
+                runDetailed(*checkpoint, point);
+            } catch(...) {
+                error = std::current_exception();
+            }
+            checkpoint->memory.reset();
+
+            std::lock_guard<std::mutex> lock(activeMutex);
+            if(error && !workerError) {
+                workerError = error;
+            }
+            --active;
+            activeChanged.notify_all();
+        });
+    }
+
+    for(std::thread &worker : workers) {
+        worker.join();
+    }
+
+    // Reported on the calling thread, an exception escaping a worker would terminate
+    if(workerError) {
+        std::rethrow_exception(workerError);
+    }
+}
+
+uint64_t SimPointRunner::profile(const RV32::HartState &initialState, MemoryMapManager &mmap, std::vector<Vector> &intervals) {
+    bool running = true;
+    RV32::HartConfig profileConfig = hartConfig;
+    profileConfig.getCharCallback = []() { return static_cast<char>(-1); };
+    profileConfig.shutdownCallback = [&running]() { running = false; };
+
+    RV32::Hart hart(initialState.pc, mmap, profileConfig);
+    hart.setState(initialState);
+
+    RV32::BasicBlockProfiler profiler(config.intervalLength);
+    hart.setBlockProfiler(&profiler);
+
+    uint64_t startInstret = hart.getInstret();
+    while(running && (config.maxInstructions == 0 || hart.getInstret() - startInstret < config.maxInstructions)) {
+        hart.stepInstruction();
+    }
+
+    intervals = profiler.getIntervals();
+    return hart.getInstret() - startInstret;
+}
+
+void SimPointRunner::choosePoints(const std::vector<Vector> &intervals) {
+    size_t maxK = std::min<size_t>(config.maxClusters, intervals.size());
+
+    std::vector<Clustering> clusterings;
+    std::vector<double> scores;
+    for(size_t k = 1; k <= maxK; ++k) {
+        Clustering best;
+        for(uint32_t seed = 0; seed < KMEANS_SEEDS; ++seed) {
+            Clustering candidate = kmeans(intervals, k, seed);
+            if(seed == 0 || candidate.distortion < best.distortion) {
+                best = std::move(candidate);
+            }
+        }
+        scores.push_back(bic(intervals, best));
+        clusterings.push_back(std::move(best));
+    }
+
+    double minScore = *std::min_element(scores.begin(), scores.end());
+    double maxScore = *std::max_element(scores.begin(), scores.end());
+    size_t chosen = 0;
+    while(scores[chosen] < minScore + BIC_THRESHOLD * (maxScore - minScore)) {
+        ++chosen;
+    }
+    const Clustering &clustering = clusterings[chosen];
+
+    // The interval closest to each centroid represents its cluster
+    for(size_t c = 0; c < clustering.centroids.size(); ++c) {
+        size_t representative = intervals.size();
+        size_t size = 0;
+        for(size_t i = 0; i < intervals.size(); ++i) {
+            if(clustering.assignments[i] != c) {
+                continue;
+            }
+            ++size;
+            if(representative == intervals.size() ||
+               squaredDistance(intervals[i], clustering.centroids[c]) < squaredDistance(intervals[representative], clustering.centroids[c])) {
+                representative = i;
+            }
+        }
+        if(size != 0) {
+            points.push_back(SimulationPoint {
+                .interval = representative,
+                .weight = static_cast<double>(size) / intervals.size(),
+            });
+        }
+    }
+
+    std::sort(points.begin(), points.end(), [](const SimulationPoint &a, const SimulationPoint &b) {
+        return a.interval < b.interval;
+    });
+}
+
+void SimPointRunner::runDetailed(const Checkpoint &checkpoint, SimulationPoint &point) {
+    MemoryMapManager mmap;
+    mmap.registerHandler(*checkpoint.memory);
+
+    bool running = true;
+    RV32::HartConfig detailedConfig = hartConfig;
+    detailedConfig.putCharCallback = [](char) {};
+    detailedConfig.getCharCallback = []() { return static_cast<char>(-1); };
+    detailedConfig.shutdownCallback = [&running]() { running = false; };
+
+    try {
+        RV32::Hart hart(checkpoint.state.pc, mmap, detailedConfig);
+        hart.setState(checkpoint.state);
+
+        RV32::TimingModel timingModel(config.timingConfig);
+        std::unique_ptr<RV32::MemoryHierarchySimulator> memorySimulator;
+        if(config.simulateMemory) {
+            memorySimulator = std::make_unique<RV32::MemoryHierarchySimulator>(config.memoryConfig);
+        }
+        hart.setTimingModel(&timingModel);
+        hart.setMemorySimulator(memorySimulator.get());
+
+        uint64_t startInstret = hart.getInstret();
+        uint64_t startCycle = hart.getCycle();
+        while(running && hart.getInstret() - startInstret < config.intervalLength) {
+            hart.stepInstruction();
+        }
+
+        point.instructions = hart.getInstret() - startInstret;
+        point.cycles = hart.getCycle() - startCycle;
+
+        if(memorySimulator) {
+            memorySimulator->finish();
+            point.misses[0] = memorySimulator->getL1I().getMisses();
+            point.misses[1] = memorySimulator->getL1D().getMisses();
+            point.misses[2] = memorySimulator->getL2().getMisses();
+            point.misses[3] = memorySimulator->getITLB().getMisses();
+            point.misses[4] = memorySimulator->getDTLB().getMisses();
+        }
+    } catch(EmulatorException &ee) {
+        point.error = ee.what();
+    }
+}
+
+void SimPointRunner::printReport(std::ostream &out) const {
+    static const char* MISS_NAMES[NUM_MISS_COUNTERS] = {"L1I", "L1D", "L2", "ITLB", "DTLB"};
+
+    out << "SimPoint: " << profiledInstructions << " instructions profiled, " << numIntervals
+        << " intervals of " << config.intervalLength << ", " << points.size() << " simulation points" << std::endl;
+    if(points.empty()) {
+        out << "  The run was shorter than one interval" << std::endl;
+        return;
+    }
+
+    out << "  " << std::setw(10) << "interval" << std::setw(10) << "weight" << std::setw(8) << "CPI";
+    if(config.simulateMemory) {
+        for(const char *name : MISS_NAMES) {
+            out << std::setw(10) << (std::string(name) + " MPKI");
+        }
+    }
+    out << std::endl;
+
+    double cpi = 0.0;
+    double mpki[NUM_MISS_COUNTERS] = {};
+    double coveredWeight = 0.0;
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    for(const SimulationPoint &point : points) {
+        out << "  " << std::setw(10) << point.interval << std::setw(10) << point.weight;
+        if(!point.error.empty() || point.instructions == 0) {
+            out << "  failed: " << (point.error.empty() ? "guest shut down" : point.error) << std::endl;
+            continue;
+        }
+
+        double pointCPI = static_cast<double>(point.cycles) / point.instructions;
+        out << std::setw(8) << pointCPI;
+        cpi += point.weight * pointCPI;
+        for(size_t i = 0; i < NUM_MISS_COUNTERS; ++i) {
+            double pointMPKI = 1000.0 * point.misses[i] / point.instructions;
+            mpki[i] += point.weight * pointMPKI;
+            if(config.simulateMemory) {
+                out << std::setw(10) << pointMPKI;
+            }
+        }
+        coveredWeight += point.weight;
+        out << std::endl;
+    }
+
+    // Renormalize in case some points failed
+    if(coveredWeight == 0.0) {
+        out << std::defaultfloat << std::setprecision(precision);
+        return;
+    }
+    cpi /= coveredWeight;
+
+    out << "Estimated whole program: CPI " << cpi << ", "
+        << static_cast<uint64_t>(cpi * profiledInstructions) << " cycles";
+    if(config.simulateMemory) {
+        for(size_t i = 0; i < NUM_MISS_COUNTERS; ++i) {
+            out << ", " << MISS_NAMES[i] << " MPKI " << mpki[i] / coveredWeight;
+        }
+    }
+    out << std::defaultfloat << std::setprecision(precision) << std::endl;
+}
@@ -0,0 +1,69 @@
+#ifndef __SIMPOINT_HPP__
+#define __SIMPOINT_HPP__
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "basic_memory.hpp"
+#include "mem_map_manager.hpp"
+#include "hart.hpp"
+
+struct SimPointConfig {
+    uint64_t intervalLength = 10000000;
+    uint32_t maxClusters = 10;
+    uint64_t maxInstructions = 0;   // profiling stops here, 0 runs until the guest shuts down
+    uint32_t threads = 0;           // detailed runs in parallel, 0 uses every host core
+
+    RV32::TimingConfig timingConfig;
+    bool simulateMemory = false;
+    RV32::MemoryHierarchyConfig memoryConfig;
+};
+
+// Sampled simulation: the workload is profiled once with the plain interpreter, collecting basic
+// block vectors per interval. The intervals are clustered and one representative per cluster is
+// checkpointed on a second, identical run. The detailed models then run on the checkpoints in
+// parallel, and their results are weighted by cluster size into whole program estimates.
+//
+// Both runs must execute identically, so the hart must use instret or cycle time and console
+// input is disabled.
+class SimPointRunner {
+    public:
+        SimPointRunner(const SimPointConfig &config, const RV32::HartConfig &hartConfig);
+
+        // Memory and the initial state are restored for the second run
+        void run(const RV32::HartState &initialState, BasicMemory &memory, MemoryMapManager &mmap);
+
+        void printReport(std::ostream &out) const;
+    private:
+        // Detailed counters are, in order: L1I, L1D, L2, ITLB and DTLB misses
+        static constexpr size_t NUM_MISS_COUNTERS = 5;
+
+        struct SimulationPoint {
+            size_t interval;
+            double weight;
+
+            uint64_t instructions = 0;
+            uint64_t cycles = 0;
+            uint64_t misses[NUM_MISS_COUNTERS] = {};
+            std::string error = {};
+        };
+
+        struct Checkpoint {
+            RV32::HartState state;
+            std::unique_ptr<BasicMemory> memory;
+        };
+
+        const SimPointConfig config;
+        const RV32::HartConfig hartConfig;
+
+        uint64_t profiledInstructions = 0;
+        size_t numIntervals = 0;
+        std::vector<SimulationPoint> points;
+
+        uint64_t profile(const RV32::HartState &initialState, MemoryMapManager &mmap, std::vector<RV32::BasicBlockProfiler::Vector> &intervals);
+        void choosePoints(const std::vector<RV32::BasicBlockProfiler::Vector> &intervals);
+        void runDetailed(const Checkpoint &checkpoint, SimulationPoint &point);
+};
+
+#endif /* __SIMPOINT_HPP__ */
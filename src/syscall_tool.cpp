@@ -0,0 +1,134 @@
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <cstdint>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include "syscall_trace.hpp"
+
+namespace {
+    // Linux system call numbers of rv32, which only has the 64-bit time variants
+    const std::map<uint32_t, std::string> SYSCALL_NAMES = {
+        {17, "getcwd"}, {23, "dup"}, {24, "dup3"}, {25, "fcntl64"}, {29, "ioctl"}, {34, "mkdirat"},
+        {35, "unlinkat"}, {48, "faccessat"}, {49, "chdir"}, {56, "openat"}, {57, "close"}, {59, "pipe2"},
+        {61, "getdents64"}, {62, "llseek"}, {63, "read"}, {64, "write"}, {65, "readv"}, {66, "writev"},
+        {67, "pread64"}, {68, "pwrite64"}, {78, "readlinkat"}, {93, "exit"}, {94, "exit_group"}, {95, "waitid"},
+        {96, "set_tid_address"}, {99, "set_robust_list"}, {124, "sched_yield"}, {129, "kill"}, {131, "tgkill"},
+        {132, "sigaltstack"}, {134, "rt_sigaction"}, {135, "rt_sigprocmask"}, {139, "rt_sigreturn"},
+        {160, "uname"}, {166, "umask"}, {172, "getpid"}, {173, "getppid"}, {174, "getuid"}, {175, "geteuid"},
+        {176, "getgid"}, {177, "getegid"}, {178, "gettid"}, {198, "socket"}, {203, "connect"}, {214, "brk"},
+        {215, "munmap"}, {216, "mremap"}, {220, "clone"}, {221, "execve"}, {222, "mmap2"}, {226, "mprotect"},
+        {233, "madvise"}, {258, "riscv_hwprobe"}, {259, "riscv_flush_icache"}, {261, "prlimit64"},
+        {276, "renameat2"}, {278, "getrandom"}, {291, "statx"}, {403, "clock_gettime64"},
+        {407, "clock_nanosleep_time64"}, {413, "pselect6_time64"}, {414, "ppoll_time64"},
+        {422, "futex_time64"}, {435, "clone3"}, {439, "faccessat2"},
+    };
+
+    struct SyscallSummary {
+        uint64_t calls = 0;
+        uint64_t errors = 0;
+        uint64_t incomplete = 0;
+        uint64_t totalCycles = 0;
+        uint64_t maxCycles = 0;
+        uint64_t totalInstret = 0;
+    };
+
+    std::string getSyscallName(uint32_t number) {
+        auto it = SYSCALL_NAMES.find(number);
+        return it != SYSCALL_NAMES.end() ? it->second : "syscall_" + std::to_string(number);
+    }
+
+    // Linux returns -errno in a0
+    bool isError(uint32_t result) {
+        return result >= static_cast<uint32_t>(-4095);
+    }
+
+    void printRecord(const RV32::SyscallRecord &record) {
+        std::cout << std::dec << std::setw(12) << record.entryInstret
+                  << "  " << std::hex << std::setfill('0') << std::setw(8) << record.satp << "/" << std::setw(8) << record.task << std::setfill(' ')
+                  << "  " << getSyscallName(record.number) << "(";
+        for(size_t i = 0; i < 6; ++i) {
+            std::cout << (i == 0 ? "0x" : ", 0x") << record.args[i];
+        }
+        std::cout << ")";
+
+        if(!record.completed) {
+            std::cout << std::dec << " = ?" << std::endl;
+            return;
+        }
+        if(isError(record.result)) {
+            std::cout << " = " << std::dec << static_cast<int32_t>(record.result);
+        } else {
+            std::cout << " = 0x" << record.result;
+        }
+        std::cout << std::dec << " <" << record.exitCycle - record.entryCycle << " cycles>" << std::endl;
+    }
+}
+
+// Summarizes a system call log written with --syscall-trace
+int main(int argc, const char *argv[]) {
+    bool list = argc == 3 && std::string(argv[2]) == "--list";
+    if(argc < 2 || (argc == 3 && !list) || argc > 3) {
+        std::cout << "Usage: " << argv[0] << " <syscall trace file> [--list]" << std::endl;
+        return -1;
+    }
+
+    RV32::SyscallTraceReader reader;
+    if(!reader.open(argv[1])) {
+        std::cout << "Trouble reading syscall trace " << argv[1] << "!" << std::endl;
+        return -1;
+    }
+
+    std::map<uint32_t, SyscallSummary> summaries;
+    uint64_t totalCycles = 0;
+    RV32::SyscallRecord record;
+    while(reader.next(record)) {
+        if(list) {
+            printRecord(record);
+        }
+
+        SyscallSummary &summary = summaries[record.number];
+        summary.calls++;
+        if(!record.completed) {
+            summary.incomplete++;
+            continue;
+        }
+
+        uint64_t cycles = record.exitCycle - record.entryCycle;
+        summary.errors += isError(record.result);
+        summary.totalCycles += cycles;
+        summary.maxCycles = std::max(summary.maxCycles, cycles);
+        summary.totalInstret += record.exitInstret - record.entryInstret;
+        totalCycles += cycles;
+    }
+
+    // Most expensive calls first, latency is measured from the ecall to the return to the same task
+    std::vector<std::pair<uint32_t, SyscallSummary>> ranked(summaries.begin(), summaries.end());
+    std::sort(ranked.begin(), ranked.end(), [](const auto &a, const auto &b) {
+        if(a.second.totalCycles != b.second.totalCycles) {
+            return a.second.totalCycles > b.second.totalCycles;
+        }
+        return a.second.calls > b.second.calls;
+    });
+
+    if(list) {
+        std::cout << std::endl;
+    }
+    std::cout << std::left << std::setw(24) << "syscall" << std::right << std::setw(10) << "calls" << std::setw(8) << "errors"
+              << std::setw(8) << "no ret" << std::setw(16) << "total cycles" << std::setw(8) << "%" << std::setw(14) << "avg cycles"
+              << std::setw(14) << "max cycles" << std::setw(14) << "avg instret" << std::endl;
+    for(const auto &[number, summary] : ranked) {
+        uint64_t returned = summary.calls - summary.incomplete;
+        double share = totalCycles == 0 ? 0.0 : 100.0 * summary.totalCycles / totalCycles;
+        std::cout << std::left << std::setw(24) << getSyscallName(number) << std::right
+                  << std::setw(10) << summary.calls << std::setw(8) << summary.errors << std::setw(8) << summary.incomplete
+                  << std::setw(16) << summary.totalCycles
+                  << std::setw(8) << std::fixed << std::setprecision(1) << share
+                  << std::setw(14) << (returned == 0 ? 0 : summary.totalCycles / returned)
+                  << std::setw(14) << summary.maxCycles
+                  << std::setw(14) << (returned == 0 ? 0 : summary.totalInstret / returned) << std::endl;
+    }
+
+    return 0;
+}
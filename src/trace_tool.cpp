@@ -0,0 +1,58 @@
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <cstdint>
+#include "trace.hpp"
+#include "disassembler.hpp"
+
+// Prints a range of an execution trace written with --trace
+int main(int argc, const char *argv[]) {
+    if(argc < 2 || argc > 4) {
+        std::cout << "Usage: " << argv[0] << " <trace file> [first instret] [count]" << std::endl;
+        return -1;
+    }
+
+    uint64_t first = 0;
+    uint64_t count = UINT64_MAX;
+    try {
+        if(argc > 2) {
+            first = std::stoull(argv[2], nullptr, 0);
+        }
+        if(argc > 3) {
+            count = std::stoull(argv[3], nullptr, 0);
+        }
+    } catch(std::exception &e) {
+        std::cout << "Invalid instruction count" << std::endl;
+        return -1;
+    }
+
+    RV32::TraceReader reader;
+    if(!reader.open(argv[1])) {
+        std::cout << "Trouble reading trace " << argv[1] << "!" << std::endl;
+        return -1;
+    }
+
+    if(!reader.seek(first)) {
+        return 0;
+    }
+
+    RV32::TraceRecord record;
+    for(uint64_t i = 0; i < count && reader.next(record); ++i) {
+        // Compressed instructions are shown as their 16 bits, padded to line up with 32-bit ones
+        bool compressed = RV32::isCompressed(record.bits);
+        std::cout << std::dec << std::setw(12) << std::setfill(' ') << record.instret << "  "
+                  << std::hex << std::setfill('0') << std::setw(8) << record.pc << ": "
+                  << std::setw(compressed ? 4 : 8) << record.bits << (compressed ? "      " : "  ")
+                  << std::left << std::setw(32) << std::setfill(' ') << RV32::disassemble(RV32::Instruction { record.bits }, record.pc) << std::right;
+
+        if(record.rd != 0) {
+            std::cout << RV32::getRegisterName(record.rd) << "=0x" << std::setfill('0') << std::setw(8) << record.rdValue << " ";
+        }
+        if(record.hasMemAddr) {
+            std::cout << "mem=0x" << std::setfill('0') << std::setw(8) << record.memAddr;
+        }
+        std::cout << std::endl;
+    }
+
+    return 0;
+}